@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourBakeUtils.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/ModelComponent.h"
+#include "Components/SplineMeshComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/Level.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "StaticMeshResources.h"
+#include "UObject/Package.h"
+
+namespace ParkourBake
+{
+	static void AddMeshTriangles(const UStaticMesh* Mesh, const FTransform& Transform, TArray<FTriangle>& OutTriangles)
+	{
+		if (Mesh == nullptr or Mesh->GetRenderData() == nullptr or Mesh->GetRenderData()->LODResources.Num() == 0)
+		{
+			return;
+		}
+		const FStaticMeshLODResources& LOD = Mesh->GetRenderData()->LODResources[0];
+		const FPositionVertexBuffer& Positions = LOD.VertexBuffers.PositionVertexBuffer;
+		TArray<uint32> Indices;
+		LOD.IndexBuffer.GetCopy(Indices);
+
+		for (int32 Index = 0; Index + 2 < Indices.Num(); Index += 3)
+		{
+			FTriangle Tri;
+			Tri.A = Transform.TransformPosition(FVector(Positions.VertexPosition(Indices[Index])));
+			Tri.B = Transform.TransformPosition(FVector(Positions.VertexPosition(Indices[Index + 1])));
+			Tri.C = Transform.TransformPosition(FVector(Positions.VertexPosition(Indices[Index + 2])));
+			if (!Tri.GetUnorientedNormal().IsNearlyZero())
+			{
+				OutTriangles.Add(Tri);
+			}
+		}
+	}
+
+	static bool IsStaticBlocker(const UPrimitiveComponent* Component)
+	{
+		return Component->Mobility == EComponentMobility::Static
+			and Component->IsQueryCollisionEnabled()
+			and Component->GetCollisionResponseToChannel(ECC_Visibility) == ECR_Block;
+	}
+
+	//Spline meshes are deformed on the GPU, their LOD0 under the component transform is not where they collide
+	static bool IsBakeable(const UStaticMeshComponent* Component)
+	{
+		return IsStaticBlocker(Component) and Component->GetStaticMesh() != nullptr and !Component->IsA<USplineMeshComponent>();
+	}
+
+	UWorld* LoadMap(const FString& MapName)
+	{
+		UPackage* MapPackage = LoadPackage(nullptr, *MapName, LOAD_None);
+		UWorld* World = MapPackage ? UWorld::FindWorldInPackage(MapPackage) : nullptr;
+		if (World == nullptr or World->PersistentLevel == nullptr)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Parkour bake: could not load map %s"), *MapName);
+			return nullptr;
+		}
+		return World;
+	}
+
+	int32 CollectStaticTriangles(UWorld* World, TArray<FTriangle>& OutTriangles)
+	{
+		int32 NumComponents = 0;
+		for (AActor* Actor : World->PersistentLevel->Actors)
+		{
+			if (Actor == nullptr)
+			{
+				continue;
+			}
+			TInlineComponentArray<UStaticMeshComponent*> Components(Actor);
+			for (UStaticMeshComponent* Component : Components)
+			{
+				if (!IsBakeable(Component))
+				{
+					continue;
+				}
+				NumComponents++;
+				if (UInstancedStaticMeshComponent* Instanced = Cast<UInstancedStaticMeshComponent>(Component))
+				{
+					for (int32 Instance = 0; Instance < Instanced->GetInstanceCount(); Instance++)
+					{
+						FTransform InstanceTransform;
+						Instanced->GetInstanceTransform(Instance, InstanceTransform, true);
+						AddMeshTriangles(Component->GetStaticMesh(), InstanceTransform, OutTriangles);
+					}
+				}
+				else
+				{
+					AddMeshTriangles(Component->GetStaticMesh(), Component->GetComponentTransform(), OutTriangles);
+				}
+			}
+		}
+		return NumComponents;
+	}
+
+	bool CoversStaticGeometry(UWorld* World)
+	{
+		if (World->IsPartitionedWorld() or World->GetStreamingLevels().Num() > 0)
+		{
+			UE_LOG(LogTemp, Display, TEXT("Parkour bake: %s streams in sublevels, runtime fallbacks keep static geometry"), *World->GetName());
+			return false;
+		}
+		for (UModelComponent* Model : World->PersistentLevel->ModelComponents)
+		{
+			if (Model and IsStaticBlocker(Model))
+			{
+				UE_LOG(LogTemp, Display, TEXT("Parkour bake: %s has blocking BSP, runtime fallbacks keep static geometry"), *World->GetName());
+				return false;
+			}
+		}
+		for (AActor* Actor : World->PersistentLevel->Actors)
+		{
+			if (Actor == nullptr)
+			{
+				continue;
+			}
+			TInlineComponentArray<UPrimitiveComponent*> Components(Actor);
+			for (UPrimitiveComponent* Component : Components)
+			{
+				if (!IsStaticBlocker(Component))
+				{
+					continue;
+				}
+				const UStaticMeshComponent* Mesh = Cast<UStaticMeshComponent>(Component);
+				if (Mesh == nullptr or !IsBakeable(Mesh))
+				{
+					UE_LOG(LogTemp, Display, TEXT("Parkour bake: %s is static geometry the bake cannot read, runtime fallbacks keep static geometry"),
+						*Component->GetFullName());
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+}
@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+
+//Shared by the parkour bake commandlets
+namespace ParkourBake
+{
+	struct FTriangle
+	{
+		FVector A;
+		FVector B;
+		FVector C;
+
+		//Winding is not trusted, callers that need a side work it out from neighbouring geometry
+		FVector GetUnorientedNormal() const { return FVector::CrossProduct(C - A, B - A).GetSafeNormal(); }
+	};
+
+	//Loads the map package and returns its world, null with an error logged on failure
+	UWorld* LoadMap(const FString& MapName);
+
+	//World-space triangles of every static, Visibility-blocking static mesh in the persistent level.
+	//Render LOD0 stands in for the collision, level-prototyping meshes use simple box collision matching it.
+	//Anything movable is left to the runtime trace fallback.
+	int32 CollectStaticTriangles(UWorld* World, TArray<FTriangle>& OutTriangles);
+
+	//Whether CollectStaticTriangles sees all of the level's static, Visibility-blocking geometry. BSP, landscape,
+	//spline meshes, other primitive types and streamed sublevels are not read, a level with any of them keeps
+	//static geometry in its runtime fallback queries. Logs the first primitive that is missed.
+	bool CoversStaticGeometry(UWorld* World);
+}
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourCameraModifier.h"
+#include "Camera/PlayerCameraManager.h"
+
+UParkourCameraModifier::UParkourCameraModifier()
+{
+	RollInterpSpeed = 10.0;
+	ConvergedEpsilon = 0.01;
+	CurrentRoll = 0.0;
+	TargetRoll = 0.0;
+	//Asleep until the first wall run or slide
+	bDisabled = true;
+}
+
+UParkourCameraModifier* UParkourCameraModifier::FindOrAdd(APlayerCameraManager* CameraManager)
+{
+	if (!CameraManager)
+	{
+		return nullptr;
+	}
+	UParkourCameraModifier* Modifier = Cast<UParkourCameraModifier>(CameraManager->FindCameraModifierByClass(UParkourCameraModifier::StaticClass()));
+	if (!Modifier)
+	{
+		Modifier = Cast<UParkourCameraModifier>(CameraManager->AddNewCameraModifier(UParkourCameraModifier::StaticClass()));
+	}
+	return Modifier;
+}
+
+void UParkourCameraModifier::SetTargetRoll(float InTargetRoll)
+{
+	TargetRoll = InTargetRoll;
+	if (!IsConverged() and IsDisabled())
+	{
+		EnableModifier();
+	}
+}
+
+void UParkourCameraModifier::ModifyCamera(float DeltaTime, FVector ViewLocation, FRotator ViewRotation, float FOV, FVector& NewViewLocation, FRotator& NewViewRotation, float& NewFOV)
+{
+	Super::ModifyCamera(DeltaTime, ViewLocation, ViewRotation, FOV, NewViewLocation, NewViewRotation, NewFOV);
+
+	if (!IsConverged())
+	{
+		CurrentRoll = FMath::FInterpTo(CurrentRoll, TargetRoll, DeltaTime, RollInterpSpeed);
+		if (IsConverged())
+		{
+			CurrentRoll = TargetRoll;
+		}
+	}
+	NewViewRotation.Roll += CurrentRoll * Alpha;
+
+	//Back to level, nothing left to do until ParkourChanged sets a new target
+	if (IsConverged() and TargetRoll == 0.0f)
+	{
+		DisableModifier(true);
+	}
+}
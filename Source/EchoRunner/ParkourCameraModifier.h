@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Camera/CameraModifier.h"
+#include "ParkourCameraModifier.generated.h"
+
+//Wall-run and slide camera roll, applied to the view only so the control rotation stays free of cosmetic roll.
+//UParkourComponent sets the target roll when the parkour mode changes. Once the roll is back within
+//ConvergedEpsilon of zero the modifier disables itself and costs nothing until the next target.
+UCLASS()
+class ECHORUNNER_API UParkourCameraModifier : public UCameraModifier
+{
+	GENERATED_BODY()
+
+public:
+	UParkourCameraModifier();
+
+	//Wakes the modifier when the target differs from the current roll
+	void SetTargetRoll(float InTargetRoll);
+	float GetCurrentRoll() const { return CurrentRoll; }
+	bool IsConverged() const { return FMath::IsNearlyEqual(CurrentRoll, TargetRoll, ConvergedEpsilon); }
+
+	//Finds the parkour modifier on PlayerCameraManager, adding one if there is none
+	static UParkourCameraModifier* FindOrAdd(class APlayerCameraManager* CameraManager);
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Parkour")
+	float RollInterpSpeed;
+	//Degrees within which the roll counts as settled
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Parkour")
+	float ConvergedEpsilon;
+
+protected:
+	virtual void ModifyCamera(float DeltaTime, FVector ViewLocation, FRotator ViewRotation, float FOV, FVector& NewViewLocation, FRotator& NewViewRotation, float& NewFOV) override;
+
+private:
+	float CurrentRoll;
+	float TargetRoll;
+};
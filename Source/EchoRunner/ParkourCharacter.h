@@ -0,0 +1,19 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Character.h"
+#include "ParkourCharacter.generated.h"
+
+//Character base that swaps in UParkourMovementComponent so parkour moves are client-predicted.
+//Reparent the player character Blueprint to this class to enable prediction. FirstPerson/Blueprints/BP_FirstPersonCharacter
+//still derives from ACharacter, and UParkourComponent::Initialise warns in networked games until it is reparented in the editor.
+UCLASS()
+class ECHORUNNER_API AParkourCharacter : public ACharacter
+{
+	GENERATED_BODY()
+
+public:
+	AParkourCharacter(const FObjectInitializer& ObjectInitializer);
+};
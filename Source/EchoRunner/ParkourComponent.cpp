@@ -2,16 +2,119 @@
 
 #include "GameFramework/Character.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/Controller.h"
 #include "Components/CapsuleComponent.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/OverlapResult.h"
 #include "Engine/World.h"
 #include "Math/UnrealMathUtility.h"
 #include "Math/Vector.h"
 #include "DrawDebugHelpers.h"
 #include "Kismet/GameplayStatics.h"
 #include "Kismet/KismetMathLibrary.h"
-#include "Kismet/KismetSystemLibrary.h"
 #include "Camera/CameraShakeBase.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "HAL/IConsoleManager.h"
 #include "ParkourComponent.h"
+#include "ParkourCameraModifier.h"
+#include "ParkourMovementComponent.h"
+#include "ParkourLedgeDatabase.h"
+#include "ParkourRootMotion.h"
+#include "ParkourSim.h"
+#include "ParkourStats.h"
+#include "ParkourUpdateManager.h"
+#include "ParkourWallIndex.h"
+
+static_assert((uint8)EParkourMode::NONE == (uint8)EParkourSimMode::NONE
+	and (uint8)EParkourMode::LEFTWALLRUN == (uint8)EParkourSimMode::LEFTWALLRUN
+	and (uint8)EParkourMode::RIGHTWALLRUN == (uint8)EParkourSimMode::RIGHTWALLRUN
+	and (uint8)EParkourMode::VERTICALWALLRUN == (uint8)EParkourSimMode::VERTICALWALLRUN
+	and (uint8)EParkourMode::LEDGEGRAB == (uint8)EParkourSimMode::LEDGEGRAB
+	and (uint8)EParkourMode::MANTLE == (uint8)EParkourSimMode::MANTLE
+	and (uint8)EParkourMode::SLIDE == (uint8)EParkourSimMode::SLIDE
+	and (uint8)EParkourMode::SPRINT == (uint8)EParkourSimMode::SPRINT
+	and (uint8)EParkourMode::CROUCH == (uint8)EParkourSimMode::CROUCH
+	and (uint8)EParkourMode::CROUCH + 1 == (uint8)EParkourSimMode::MAX,
+	"EParkourSimMode must mirror EParkourMode");
+
+static_assert((uint8)EParkourGate::WALLRUN == FParkourSim::GATE_WALLRUN
+	and (uint8)EParkourGate::VERTICALWALLRUN == FParkourSim::GATE_VERTICALWALLRUN
+	and (uint8)EParkourGate::CHECKMANTLE == FParkourSim::GATE_CHECKMANTLE
+	and (uint8)EParkourGate::MANTLE == FParkourSim::GATE_MANTLE
+	and (uint8)EParkourGate::SLIDE == FParkourSim::GATE_SLIDE
+	and (uint8)EParkourGate::SPRINT == FParkourSim::GATE_SPRINT,
+	"FParkourSim gates must mirror EParkourGate");
+
+static EParkourSimMode ToSimMode(EParkourMode Mode)
+{
+	return (EParkourSimMode)Mode;
+}
+
+namespace ParkourFusedProbe
+{
+	//Probes RunFusedProbe answers, the others start too far from the capsule to share its broadphase box
+	static constexpr EParkourProbe Probes[] = { EParkourProbe::WALLRUNRIGHT, EParkourProbe::WALLRUNLEFT, EParkourProbe::FORWARD,
+		EParkourProbe::LEDGEGROUND, EParkourProbe::SLIDE };
+
+	//The primitives an EQueryMobilityType::Dynamic query reports, everything but Static, so Stationary ones included
+	static bool MatchesDynamicQuery(const UPrimitiveComponent* Primitive)
+	{
+		return Primitive->Mobility != EComponentMobility::Static;
+	}
+
+	//Closest blocking hit of the segment among the overlap's primitives, a line shape traces instead of sweeping
+	static bool TraceCandidates(TArrayView<UPrimitiveComponent* const> Candidates, const FVector& Start, const FVector& End, const FQuat& Rotation,
+		const FCollisionShape& Shape, bool bDynamicOnly, FHitResult& OutHit)
+	{
+		OutHit = FHitResult(Start, End);
+		bool bHit = false;
+		for (UPrimitiveComponent* Primitive : Candidates)
+		{
+			//Static geometry the wall index covers, as with the Dynamic mobility query it replaces
+			if (bDynamicOnly and !MatchesDynamicQuery(Primitive))
+			{
+				continue;
+			}
+			FHitResult Hit;
+			const bool bPrimitiveHit = Shape.IsLine()
+				? Primitive->LineTraceComponent(Hit, Start, End, FCollisionQueryParams::DefaultQueryParam)
+				: Primitive->SweepComponent(Hit, Start, End, Rotation, Shape);
+			if (bPrimitiveHit and (!bHit or Hit.Time < OutHit.Time))
+			{
+				OutHit = Hit;
+				bHit = true;
+			}
+		}
+		OutHit.bBlockingHit = bHit;
+		return bHit;
+	}
+}
+
+namespace ParkourLOD
+{
+	//Live components per bucket and how many of them are asleep, game thread only
+	static int32 BucketCounts[(uint8)EParkourLOD::MAX];
+	static int32 SleepingCount = 0;
+
+	static FAutoConsoleCommand LODStatsCommand(
+		TEXT("parkour.LODStats"),
+		TEXT("Reports how many parkour characters are in each update LOD bucket and how many are asleep."),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			static const TCHAR* BucketNames[(uint8)EParkourLOD::MAX] = { TEXT("Full"), TEXT("Reduced"), TEXT("StateOnly") };
+			int32 Total = 0;
+			for (int32 Count : BucketCounts)
+			{
+				Total += Count;
+			}
+			UE_LOG(LogTemp, Display, TEXT("Parkour update LOD, %d characters, %d asleep:"), Total, SleepingCount);
+			for (int32 Bucket = 0; Bucket < (int32)EParkourLOD::MAX; Bucket++)
+			{
+				UE_LOG(LogTemp, Display, TEXT("  %-10s %5d  (%.0f%%)"), BucketNames[Bucket], BucketCounts[Bucket], (Total > 0) ? 100.0 * BucketCounts[Bucket] / Total : 0.0);
+			}
+		}));
+}
 
 // Sets default values for this component's properties
 UParkourComponent::UParkourComponent()
@@ -19,6 +122,37 @@ UParkourComponent::UParkourComponent()
 	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
 	// off to improve performance if you don't need them.
 	PrimaryComponentTick.bCanEverTick = true;
+	//Tick is enabled by Initialise once a character is bound, and runs ahead of CharacterMovement
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PrePhysics;
+	SetIsReplicatedByDefault(true);
+	UpdateRate = 0.0;
+	UpdateDeltaTime = 0.0;
+	WallRunQueryMode = EParkourQueryMode::SYNC;
+	LedgeQueryMode = EParkourQueryMode::SYNC;
+	ForwardQueryMode = EParkourQueryMode::SYNC;
+	GroundQueryMode = EParkourQueryMode::SYNC;
+	bUseWallIndex = true;
+	bUseLedgeDatabase = true;
+	bUseFusedProbe = true;
+	bRecordSession = false;
+	WallIndex = nullptr;
+	CameraModifier = nullptr;
+	bUseUpdateLOD = true;
+	ReducedLODDistance = 2500.0;
+	StateOnlyLODDistance = 6000.0;
+	ReducedLODUpdateRate = 15.0;
+	StateOnlyLODUpdateRate = 4.0;
+	LODHysteresis = 0.1;
+	UpdateLOD = EParkourLOD::FULL;
+	bAllowUpdateSleep = true;
+	bUseUpdateManager = true;
+	JumpBufferTime = 0.15;
+	SlideBufferTime = 0.0;
+	SprintBufferTime = 0.0;
+	DashBufferTime = 0.15;
+	CoyoteTime = 0.12;
+	Gates = 0;
 	OnWall = false;
 	WallRunGravityOn = true;
 	WallRunSpeed = 850.0;
@@ -55,12 +189,68 @@ void UParkourComponent::BeginPlay()
 	
 }
 
+void UParkourComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	StopRecording();
+	StopPlayback();
+	FlightRecorder.Reset();
+	if (Character and Character->GetRootComponent())
+	{
+		Character->GetRootComponent()->TransformUpdated.RemoveAll(this);
+	}
+	if (bManagedUpdate)
+	{
+		if (UParkourUpdateManager* Manager = GetWorld()->GetSubsystem<UParkourUpdateManager>())
+		{
+			Manager->Unregister(this);
+		}
+		bManagedUpdate = false;
+	}
+	if (bLODCounted)
+	{
+		ParkourLOD::BucketCounts[(uint8)UpdateLOD]--;
+		bLODCounted = false;
+	}
+	if (bUpdateAsleep)
+	{
+		ParkourLOD::SleepingCount--;
+		bUpdateAsleep = false;
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
 void UParkourComponent::JumpEvent()
+{
+	if (!AcceptEvent(EParkourRecordOp::JUMP))
+	{
+		return;
+	}
+	const EParkourCoyote Coyote = InputBuffer.ConsumeCoyote(GetInputTime(), CoyoteTime);
+	if (CurrentParkourMode == EParkourMode::NONE)
+	{
+		//Just off a wall run, jump off the wall as if still on it
+		if (Coyote == EParkourCoyote::WALL)
+		{
+			LaunchWallJump();
+			TimesJumped++;
+			return;
+		}
+		//Out of jumps in the air, held for the landing
+		if (IsAirborne() and !CanJump() and Coyote == EParkourCoyote::NONE)
+		{
+			InputBuffer.Buffer(EParkourBufferedAction::JUMP, GetInputTime());
+			return;
+		}
+	}
+	PerformJump(Coyote == EParkourCoyote::GROUND);
+}
+
+void UParkourComponent::PerformJump(bool bFromGround)
 {
 	JumpMovement();
 	if (CurrentParkourMode == EParkourMode::NONE)
 	{
-		if (CharacterMovement->IsFalling() == false)
+		if (bFromGround or IsAirborne() == false)
 		{
 			OpenGates();
 			PlayCameraShake(JumpLand);
@@ -74,47 +264,149 @@ void UParkourComponent::JumpEvent()
 
 void UParkourComponent::LandEvent()
 {
+	if (!AcceptEvent(EParkourRecordOp::LAND))
+	{
+		return;
+	}
 	TimesJumped = 0;
+	if (ParkourMovement)
+	{
+		ParkourMovement->ResetDash();
+	}
 	EndEvents();
 	CloseGates();
 	PlayCameraShake(JumpLand);
+	InputBuffer.CloseCoyote();
+	CheckBufferedDash();
 }
 
 void UParkourComponent::DashEvent()
 {
+	if (!AcceptEvent(EParkourRecordOp::DASH))
+	{
+		return;
+	}
 	if (bCanDash)
+	{
+		PerformDash();
+	}
+	else
+	{
+		InputBuffer.Buffer(EParkourBufferedAction::DASH, GetInputTime());
+	}
+}
+
+void UParkourComponent::PerformDash()
+{
+	if (ParkourMovement)
+	{
+		ParkourMovement->ParkourDash(GetDashLaunchVelocity());
+	}
+	else
 	{
 		Character->LaunchCharacter(GetDashLaunchVelocity(), true, false);
-		bCanDash = false;
+	}
+	bCanDash = false;
+}
+
+void UParkourComponent::CheckBufferedDash()
+{
+	if (bCanDash and IsInputBuffered(EParkourBufferedAction::DASH))
+	{
+		ConsumeBufferedInput(EParkourBufferedAction::DASH);
+		PerformDash();
 	}
 }
 
 void UParkourComponent::Initialise(ACharacter* Char)
 {
+	LLM_SCOPE_BYTAG(Parkour);
 	Character = Char;
 	CharacterMovement = Character->GetCharacterMovement();
+	ParkourMovement = Cast<UParkourMovementComponent>(CharacterMovement);
+	if (ParkourMovement)
+	{
+		ParkourMovement->WallRunTargetGravity = WallRunTargetGravity;
+		ParkourMovement->WallRunSpeed = WallRunSpeed;
+		ParkourMovement->WallRunSprintSpeed = WallRunSprintSpeed;
+		ParkourMovement->VerticalWallRunSpeed = VerticalWallRunSpeed;
+		//Largest of each launch this component issues, 600 is VerticalWallRunMovement's push into the wall
+		ParkourMovement->MaxLaunchSpeedXY = FMath::Max3(WallRunSprintSpeed, WallJumpScale, FMath::Max(LedgeGrabJumpOffForce, 600.0f));
+		ParkourMovement->MaxLaunchSpeedZ = FMath::Max3(WallJumpForce, LedgeGrabJumpOffHeight, VerticalWallRunSpeed);
+		ParkourMovement->DashScale = DashScale;
+		ParkourMovement->DashRange = DashRange;
+		ParkourMovement->GroundDashRange = DashRange * MaxRangeScale;
+		ParkourMovement->MantleSpeed = MantleSpeed;
+		ParkourMovement->QuickMantleSpeed = QuickMantleSpeed;
+		ParkourMovement->OnServerParkourState.BindUObject(this, &UParkourComponent::ServerParkourStateReceived);
+		ParkourMovement->OnParkourInputStarted.BindUObject(this, &UParkourComponent::WakeUpdate);
+		ParkourMovement->OnParkourWallProbe.BindUObject(this, &UParkourComponent::ProbeParkourWall);
+		ParkourMovement->OnParkourWallLost.BindUObject(this, &UParkourComponent::ParkourWallLost);
+		ParkourMovement->OnParkourMantleProbe.BindUObject(this, &UParkourComponent::ProbeMantleTarget);
+	}
+	else if (GetNetMode() != NM_Standalone)
+	{
+		//Launches, dashes and modes then only correct through server snaps
+		UE_LOG(LogTemp, Warning, TEXT("%s does not use UParkourMovementComponent, parkour moves will not be predicted. Reparent it to AParkourCharacter."),
+			*GetNameSafe(Character));
+	}
+	if (USceneComponent* Root = Character->GetRootComponent())
+	{
+		Root->TransformUpdated.RemoveAll(this);
+		Root->TransformUpdated.AddUObject(this, &UParkourComponent::OnCharacterTransformUpdated);
+	}
 	DefaultGravity = CharacterMovement->GravityScale;
 	DefaultGroundFriction = CharacterMovement->GroundFriction;
 	DefaultBrakingDeceleration = CharacterMovement->BrakingDecelerationWalking;
 	DefaultWalkSpeed = CharacterMovement->MaxWalkSpeed;
 	DefaultCrouchSpeed = CharacterMovement->MaxWalkSpeedCrouched;
 	UpdateCameraProperties();
+	WallIndex = bUseWallIndex ? UParkourWallIndex::LoadForWorld(GetWorld()) : nullptr;
+	LedgeDatabase = bUseLedgeDatabase ? FParkourLedgeDatabase::LoadForWorld(GetWorld()) : nullptr;
+	if (LedgeDatabase and !FMath::IsNearlyEqual(LedgeDatabase->GetBakedMantleHeight(), MantleHeight))
+	{
+		//The quick-mantle flags would disagree with this character's mantle, rebake with -MantleHeight to use the database
+		UE_LOG(LogTemp, Warning, TEXT("%s: ledge database was baked for MantleHeight %.1f, not %.1f, using live ledge probes"),
+			*GetNameSafe(GetOwner()), LedgeDatabase->GetBakedMantleHeight(), MantleHeight);
+		LedgeDatabase = nullptr;
+	}
+
+	bGatesChangedEventImplemented = GetClass()->IsFunctionImplementedInScript(GET_FUNCTION_NAME_CHECKED(UParkourComponent, GatesChangedEvent));
+
+	//Parkour decisions must land before the movement they drive in the same frame
+	UParkourUpdateManager* Manager = bUseUpdateManager ? GetWorld()->GetSubsystem<UParkourUpdateManager>() : nullptr;
+	SetUpdateInterval((UpdateRate > 0.0) ? (1.0 / UpdateRate) : 0.0);
+	if (Manager)
+	{
+		Manager->Register(this);
+		bManagedUpdate = true;
+	}
+	else
+	{
+		CharacterMovement->AddTickPrerequisiteComponent(this);
+		SetComponentTickEnabled(true);
+	}
+	if (!bLODCounted)
+	{
+		ParkourLOD::BucketCounts[(uint8)UpdateLOD]++;
+		bLODCounted = true;
+	}
+	//Spawned characters are scored on their first update instead of running a frame at FULL
+	LODScoreTime = LODScoreInterval;
+
+	FlightRecorder = MakeUnique<FParkourFlightRecorder>(this);
 
-	FTimerDelegate TimerDelegate;
-	FTimerHandle TimerHandle;
-	TimerDelegate.BindUFunction(this, FName("UpdateEvent"));
-	GetWorld()->GetTimerManager().SetTimer(TimerHandle, TimerDelegate, 0.0167, true);
+	if ((bRecordSession or ParkourRecording::ShouldRecordSessions()) and Character->IsLocallyControlled())
+	{
+		StartRecording();
+	}
 }
 
 bool UParkourComponent::WallRunMovement(FVector Start, FVector End, float WallRunDir)
 {
 	FHitResult wallhit(ForceInit);
-	GetWorld()->LineTraceSingleByChannel(
-		wallhit,
-		Start,
-		End,
-		ECC_Visibility
-	);
+	EParkourProbe Probe = (WallRunDir < 0.0) ? EParkourProbe::WALLRUNRIGHT : EParkourProbe::WALLRUNLEFT;
+	ParkourLineTrace(Probe, wallhit, Start, End);
 	//DrawDebugLine(GetWorld(), Start, End, FColor::Red, true, 1.0);
 	if (wallhit.bBlockingHit)
 	{
@@ -123,17 +415,20 @@ bool UParkourComponent::WallRunMovement(FVector Start, FVector End, float WallRu
 		WallRunNormal = wallhit.Normal;
 		WallRunLocation = wallhit.ImpactPoint;
 
-		if (WallRunNormal.Z > -0.52 && WallRunNormal.Z < 0.52 && CharacterMovement->IsFalling())
+		if (FParkourSimRules::IsWallRunnableNormal(WallRunNormal.Z) && IsAirborne())
 		{
 			//UE_LOG(LogTemp, Warning, TEXT("In WallRange"));
 
-			//Push player forward or backward
-			FVector CrossProdWallRunNormal = FVector::CrossProduct(WallRunNormal, FVector(0, 0, 1));
-			float Speed = (bSprintQueued) ? WallRunSprintSpeed : WallRunSpeed;
-			float WallRunVectorScale = WallRunDir * Speed;
-			FVector FwdBwdLaunchVel = CrossProdWallRunNormal * WallRunVectorScale;
-			bool bZOverride = (!IsWallRunning() or !WallRunGravityOn);
-			Character->LaunchCharacter(FwdBwdLaunchVel, true, bZOverride);
+			//Push player forward or backward, PhysWallRun holds the speed itself once the custom mode runs
+			if (!UsesParkourPhysics() or !IsWallRunning())
+			{
+				FVector CrossProdWallRunNormal = FVector::CrossProduct(WallRunNormal, FVector(0, 0, 1));
+				float Speed = IsInputBuffered(EParkourBufferedAction::SPRINT) ? WallRunSprintSpeed : WallRunSpeed;
+				float WallRunVectorScale = WallRunDir * Speed;
+				FVector FwdBwdLaunchVel = CrossProdWallRunNormal * WallRunVectorScale;
+				bool bZOverride = (!IsWallRunning() or !WallRunGravityOn);
+				ParkourLaunch(FwdBwdLaunchVel, true, bZOverride);
+			}
 			OnWall = true;
 			//UE_LOG(LogTemp, Warning, TEXT("OnWall"),OnWall);
 			return OnWall;
@@ -153,10 +448,11 @@ bool UParkourComponent::WallRunMovement(FVector Start, FVector End, float WallRu
 
 void UParkourComponent::WallRunUpdate()
 {
+	SCOPE_CYCLE_COUNTER(STAT_ParkourWallRunUpdate);
 	if (CanWallRun())
 	{
 		//RightSideWallRun
-		bool isOnWallR = WallRunMovement(Character->GetActorLocation(), GetWallRunEndVector(75.0), -1.0);
+		bool isOnWallR = WallRunMovement(GetProbeFrame().Location, GetWallRunEndVector(75.0), -1.0);
 		if (isOnWallR)
 		{
 			bool changed = SetParkourMode(EParkourMode::RIGHTWALLRUN);
@@ -177,7 +473,7 @@ void UParkourComponent::WallRunUpdate()
 			}
 			else
 			{
-				bool isOnWallL = WallRunMovement(Character->GetActorLocation(), GetWallRunEndVector(-75.0), 1.0);
+				bool isOnWallL = WallRunMovement(GetProbeFrame().Location, GetWallRunEndVector(-75.0), 1.0);
 				if (isOnWallL)
 				{
 					bool changed = SetParkourMode(EParkourMode::LEFTWALLRUN);
@@ -212,27 +508,14 @@ void UParkourComponent::CorrectWallRunLocation()
 {
 	if (IsWallRunning())
 	{
-		FLatentActionInfo LAInfo;
-		LAInfo.CallbackTarget = this;
-		UKismetSystemLibrary::MoveComponentTo(
-			Character->GetCapsuleComponent(),
-			GetWallRunTargetVector(),
-			GetWallRunTargetRotation(),
-			false,
-			false,
-			0.1,
-			false,
-			EMoveComponentAction::Move,
-			LAInfo);
+		//Only the distance off the wall is corrected, the run along it is left alone
+		StartCorrection(GetWallRunTargetVector(), GetWallRunTargetRotation(), WallRunNormal.GetSafeNormal2D());
 	}
 }
 
 void UParkourComponent::ApplyGravityAndCorrectLocation()
 {
-	FTimerDelegate TimerDel;
-	FTimerHandle TimerHandle;
-	TimerDel.BindUFunction(this, FName("WallRunEnableGravity"));
-	GetWorld()->GetTimerManager().SetTimer(TimerHandle, TimerDel, 1.0, false);
+	Scheduler.Reschedule(WallRunGravityTimer, &UParkourComponent::WallRunEnableGravity, 1.0);
 	CorrectWallRunLocation();
 	CharacterMovement->GravityScale = InterpolateGravity();
 }
@@ -243,14 +526,21 @@ void UParkourComponent::WallRunJump()
 	if (IsWallRunning())
 	{
 		WallRunEnd(0.35);
-		//Launch Character
-		float XOverride = WallJumpScale * WallRunNormal.X;
-		float YOverride = WallJumpScale * WallRunNormal.Y;
-		UE_LOG(LogTemp, Warning, TEXT("Launching Character"));
-		Character->LaunchCharacter(FVector(XOverride, YOverride, WallJumpForce), false, true);
+		//Jumped off rather than dropped, no coyote wall jump after this one
+		InputBuffer.CloseCoyote();
+		LaunchWallJump();
 	}
 }
 
+void UParkourComponent::LaunchWallJump()
+{
+	//Launch Character
+	float XOverride = WallJumpScale * WallRunNormal.X;
+	float YOverride = WallJumpScale * WallRunNormal.Y;
+	//UE_LOG(LogTemp, Warning, TEXT("Launching Character"));
+	ParkourLaunch(FVector(XOverride, YOverride, WallJumpForce), false, true);
+}
+
 void UParkourComponent::WallRunEnd(float ResetTime)
 {
 	if (IsWallRunning())
@@ -259,18 +549,19 @@ void UParkourComponent::WallRunEnd(float ResetTime)
 		bool change = SetParkourMode(EParkourMode::NONE);
 		if (change)
 		{
-			CloseWallRunGate();
+			CloseWallRunGate_Implementation();
 			
-			FTimerDelegate TimerDelegate;
-			FTimerHandle TimerHandle;
-			TimerDelegate.BindUFunction(this, FName("OpenWallRunGate"));
-			GetWorld()->GetTimerManager().SetTimer(TimerHandle, TimerDelegate, ResetTime, false);
+			Scheduler.Reschedule(WallRunGateTimer, &UParkourComponent::OpenWallRunGate_Implementation, ResetTime);
 			
-			FTimerDelegate GTimerDel;
-			FTimerHandle GTimerHandle;
-			GTimerDel.BindUFunction(this, FName("WallRunEnableGravity"));
-			GetWorld()->GetTimerManager().SetTimer(GTimerHandle, GTimerDel, 0.0, false); 
+			//A zero-delay timer never fired, gravity stays off until the next wall run re-enables it
+			Scheduler.Cancel(WallRunGravityTimer);
 			WallRunGravityOn = false;
+
+			//WallRunNormal keeps the wall just left for a coyote wall jump
+			if (IsAirborne())
+			{
+				InputBuffer.OpenCoyote(EParkourCoyote::WALL, GetInputTime());
+			}
 		}
 	}
 }
@@ -289,8 +580,11 @@ void UParkourComponent::VerticalWallRunMovement()
 		{
 			CorrectVerticalWallRunLocation();
 		}*/
-		FVector VertWROverride = VerticalWallRunNormal * -600.0;
-		Character->LaunchCharacter(FVector(VertWROverride.X, VertWROverride.Y, VerticalWallRunSpeed), true, true);
+		if (!UsesParkourPhysics())
+		{
+			FVector VertWROverride = VerticalWallRunNormal * -600.0;
+			ParkourLaunch(FVector(VertWROverride.X, VertWROverride.Y, VerticalWallRunSpeed), true, true);
+		}
 	}
 	else
 	{
@@ -300,17 +594,22 @@ void UParkourComponent::VerticalWallRunMovement()
 
 void UParkourComponent::VerticalWallRunUpdate()
 {
+	SCOPE_CYCLE_COUNTER(STAT_ParkourVerticalWallRunUpdate);
 	if (CanVerticalWallRun())
 	{
-		FVector Eyes, Feet;
-		GetMantleVectors(Eyes, Feet);
+		const FParkourProbeFrame& Frame = GetProbeFrame();
+		if (FindBakedLedge(bLedgeCloseToGround))
+		{
+			EnterLedgeGrab();
+			return;
+		}
+
 		FHitResult OutHit;
-		bool hit = GetWorld()->SweepSingleByChannel(OutHit,
-			Eyes,
-			Feet,
-			Character->GetActorQuat(),
-			ECC_Visibility,
-			FCollisionShape::MakeCapsule(20.0, 10.0));
+		bool hit = ParkourSweep(EParkourProbe::LEDGE, OutHit,
+			Frame.MantleEyes,
+			Frame.MantleFeet,
+			FCollisionShape::MakeCapsule(20.0, 10.0),
+			GetLedgeQueryParams());
 		if (hit)
 		{
 			MantleTraceDistance = OutHit.Distance;
@@ -322,33 +621,16 @@ void UParkourComponent::VerticalWallRunUpdate()
 			{
 				LedgeClimbWallPosition = FTOutHit.ImpactPoint;
 				LedgeClimbWallNormal = FTOutHit.Normal;
-				float CapHalfHeight = Character->GetCapsuleComponent()->GetUnscaledCapsuleHalfHeight();
-				MantlePosition = LedgeFloorPosition + FVector(0.0, 0.0, CapHalfHeight*1.0);
-				CloseVerticalWallRunGate();
-				GrabLedge();
 
 				FHitResult LedgeOutHit;
-				float CapZOffset = Character->GetCapsuleComponent()->GetUnscaledCapsuleHalfHeight() + 40.0;
-				FVector EndVec = Character->GetActorLocation() - (Character->GetActorUpVector() * CapZOffset);
-				bLedgeCloseToGround = GetWorld()->LineTraceSingleByChannel(
+				float CapZOffset = Frame.CapsuleHalfHeight + 40.0;
+				FVector EndVec = Frame.Location - (Frame.Up * CapZOffset);
+				bLedgeCloseToGround = ParkourLineTrace(EParkourProbe::LEDGEGROUND,
 					LedgeOutHit,
-					Character->GetActorLocation(),
-					EndVec,
-					ECC_Visibility
+					Frame.Location,
+					EndVec
 				);
-
-				if (CanQuickMantle())
-				{
-					OpenCheckMantleGate();
-				}
-				else
-				{
-					CorrectLedgeLocation();
-					FTimerHandle TimerHandle;
-					FTimerDelegate TimerDelegate;
-					TimerDelegate.BindUFunction(this, FName("OpenCheckMantleGate"));
-					GetWorld()->GetTimerManager().SetTimer(TimerHandle, TimerDelegate, 0.25, false);
-				}
+				EnterLedgeGrab();
 			}
 			else
 			{
@@ -366,6 +648,47 @@ void UParkourComponent::VerticalWallRunUpdate()
 	}
 }
 
+void UParkourComponent::EnterLedgeGrab()
+{
+	MantlePosition = LedgeFloorPosition + FVector(0.0, 0.0, GetProbeFrame().CapsuleHalfHeight*1.0);
+	CloseVerticalWallRunGate_Implementation();
+	GrabLedge();
+
+	if (CanQuickMantle())
+	{
+		OpenCheckMantleGate_Implementation();
+	}
+	else
+	{
+		CorrectLedgeLocation();
+		Scheduler.Reschedule(CheckMantleGateTimer, &UParkourComponent::OpenCheckMantleGate_Implementation, 0.25);
+	}
+}
+
+bool UParkourComponent::FindBakedLedge(bool& bOutLedgeCloseToGround)
+{
+	if (!LedgeDatabase)
+	{
+		return false;
+	}
+	INC_DWORD_STAT(STAT_ParkourBakedLookups);
+	const FParkourProbeFrame& Frame = GetProbeFrame();
+	FParkourLedgeQueryResult Ledge;
+	if (!LedgeDatabase->FindLedge(Frame.MantleEyes, Frame.MantleFeet, Frame.Forward, 20.0, 10.0, Ledge))
+	{
+		return false;
+	}
+
+	MantleTraceDistance = Ledge.TraceDistance;
+	LedgeFloorPosition = Ledge.FloorPosition;
+	LedgeClimbWallPosition = Ledge.WallPosition;
+	LedgeClimbWallNormal = Ledge.WallNormal;
+	//Stands in for the ground trace below the capsule, with the ground at the foot of the wall as what it would hit
+	float FeetZ = Frame.Location.Z - (Frame.CapsuleHalfHeight + 40.0);
+	bOutLedgeCloseToGround = (FeetZ <= Ledge.GroundZ);
+	return true;
+}
+
 void UParkourComponent::VerticalWallRunEnd(float ResetTime)
 {
 	if (LedgeMantleOrVertical())
@@ -374,19 +697,14 @@ void UParkourComponent::VerticalWallRunEnd(float ResetTime)
 		if (change)
 		{
 			//VerticalWallRunCurrentSpeed = VerticalWallRunSpeed;
-			CloseVerticalWallRunGate();
-			CloseCheckMantleGate();
+			CloseVerticalWallRunGate_Implementation();
+			CloseCheckMantleGate_Implementation();
+			CloseMantleGate_Implementation();
 			bLedgeCloseToGround = false;
 
-			FTimerDelegate TimerDelegate;
-			FTimerHandle TimerHandle;
-			TimerDelegate.BindUFunction(this, FName("OpenVerticalWallRunGate"));
-			GetWorld()->GetTimerManager().SetTimer(TimerHandle, TimerDelegate, ResetTime, false);
-
-			FTimerDelegate QueueTimerDelegate;
-			FTimerHandle QueueTimerHandle;
-			QueueTimerDelegate.BindUFunction(this, FName("CheckQueues"));
-			GetWorld()->GetTimerManager().SetTimer(QueueTimerHandle, QueueTimerDelegate, 0.02, false);
+			Scheduler.Cancel(CheckMantleGateTimer);
+			Scheduler.Reschedule(VerticalWallRunGateTimer, &UParkourComponent::OpenVerticalWallRunGate_Implementation, ResetTime);
+			CheckQueues();
 		}
 	}
 }
@@ -395,19 +713,7 @@ void UParkourComponent::CorrectVerticalWallRunLocation()
 {
 	if (CurrentParkourMode == EParkourMode::VERTICALWALLRUN)
 	{
-		FLatentActionInfo LAInfo;
-		LAInfo.CallbackTarget = this;
-		UKismetSystemLibrary::MoveComponentTo(
-			Character->GetCapsuleComponent(),
-			GetVerticalWallRunTargetVector(),
-			GetVerticalWallRunTargetRotation(),
-			false,
-			false,
-			0.1,
-			false,
-			EMoveComponentAction::Move,
-			LAInfo
-		);
+		StartCorrection(GetVerticalWallRunTargetVector(), GetVerticalWallRunTargetRotation(), VerticalWallRunNormal.GetSafeNormal2D());
 	}
 }
 
@@ -416,42 +722,264 @@ void UParkourComponent::CorrectLedgeLocation()
 
 	if (CurrentParkourMode == EParkourMode::LEDGEGRAB)
 	{
-		FLatentActionInfo LAInfo;
-		LAInfo.CallbackTarget = this;
-		UKismetSystemLibrary::MoveComponentTo(
-			Character->GetCapsuleComponent(),
-			GetLedgeTargetVector(),
-			GetLedgeTargetRotation(),
-			false,
-			false,
-			0.1,
-			false,
-			EMoveComponentAction::Move,
-			LAInfo
-		);
+		StartCorrection(GetLedgeTargetVector(), GetLedgeTargetRotation(), FVector::ZeroVector);
+	}
+}
+
+float UParkourComponent::GetCorrectionError() const
+{
+	return Correction.IsActive() ? Correction.GetRemainingError(Character->GetActorLocation()).Size() : 0.0f;
+}
+
+void UParkourComponent::StartCorrection(const FVector& Target, const FRotator& TargetRotation, const FVector& Axis)
+{
+	//Same 0.1s the MoveComponentTo snaps used
+	Correction.Start(Target, TargetRotation.Yaw, Axis, 0.1f);
+}
+
+void UParkourComponent::StepCorrection()
+{
+	FVector Delta;
+	float Yaw;
+	FRotator Rotation = Character->GetActorRotation();
+	if (Correction.Step(Character->GetActorLocation(), Rotation.Yaw, UpdateDeltaTime, Delta, Yaw))
+	{
+		Rotation.Yaw = Yaw;
+		//Swept, unlike the latent move, so a snap can't push the capsule into the wall
+		Character->SetActorLocationAndRotation(Character->GetActorLocation() + Delta, Rotation, true);
 	}
 }
 
 void UParkourComponent::ForwardTracer(FHitResult& OutHit, bool& ValidHit)
 {
-	FVector Eyes, Feet;
-	GetMantleVectors(Eyes, Feet);
-	FHitResult OutHitLocal;
-	FVector EndVec = Feet + (Character->GetActorForwardVector() * 50.0);
-	bool hit = GetWorld()->SweepSingleByChannel(
-		OutHitLocal, 
-		Feet,
-		EndVec,
-		Character->GetActorQuat(),
-		ECC_Visibility,
-		FCollisionShape::MakeCapsule(10.0, 5.0)
-		);
-	ValidHit = OutHitLocal.bBlockingHit and (OutHitLocal.Normal.Z >= -0.1);
-	OutHit = OutHitLocal;
+	GetProbeFrame();
+	if (!ProbeFrame.bForwardTraced)
+	{
+		FHitResult OutHitLocal;
+		FVector EndVec = ProbeFrame.MantleFeet + (ProbeFrame.Forward * 50.0);
+		ParkourSweep(EParkourProbe::FORWARD,
+			OutHitLocal, 
+			ProbeFrame.MantleFeet,
+			EndVec,
+			FCollisionShape::MakeCapsule(10.0, 5.0)
+			);
+		SetForwardHit(OutHitLocal);
+	}
+	ValidHit = ProbeFrame.bForwardValidHit;
+	OutHit = ProbeFrame.ForwardHit;
+}
+
+void UParkourComponent::SetForwardHit(const FHitResult& Hit)
+{
+	ProbeFrame.bForwardValidHit = Hit.bBlockingHit and (Hit.Normal.Z >= -0.1);
+	ProbeFrame.ForwardHit = Hit;
+	ProbeFrame.bForwardTraced = true;
+}
+
+bool UParkourComponent::ParkourLineTrace(EParkourProbe Probe, FHitResult& OutHit, const FVector& Start, const FVector& End)
+{
+	bool bPrefetchedHit;
+	if (ConsumePrefetchedProbe(Probe, Start, End, OutHit, bPrefetchedHit))
+	{
+		return bPrefetchedHit;
+	}
+
+	FCollisionQueryParams QueryParams = FCollisionQueryParams::DefaultQueryParam;
+	if (WallIndex and (Probe == EParkourProbe::WALLRUNRIGHT or Probe == EParkourProbe::WALLRUNLEFT))
+	{
+		INC_DWORD_STAT(STAT_ParkourBakedLookups);
+		if (WallIndex->LineTrace(Start, End, OutHit))
+		{
+			//Drop any in-flight fallback so a later miss cannot pick up its stale result
+			AsyncProbes[(uint8)Probe] = FParkourAsyncProbe();
+			return true;
+		}
+		//When the bake saw all of the level's static geometry, only movable geometry still needs the scene
+		if (WallIndex->CoversStaticGeometry())
+		{
+			QueryParams.MobilityType = EQueryMobilityType::Dynamic;
+		}
+	}
+
+	if (GetProbeQueryMode(Probe) == EParkourQueryMode::SYNC)
+	{
+		CountProbeQuery(Probe);
+		return GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_Visibility, QueryParams);
+	}
+
+	//A probe that skipped a frame has no async result left to read, trace now and let the next frame read this one
+	FParkourAsyncProbe& Pending = AsyncProbes[(uint8)Probe];
+	if (!HasAsyncProbeResult(Pending))
+	{
+		CountProbeQuery(Probe);
+		Pending.Handle = FTraceHandle();
+		Pending.bHit = GetWorld()->LineTraceSingleByChannel(Pending.Hit, Start, End, ECC_Visibility, QueryParams);
+		Pending.SubmitFrame = GFrameCounter;
+		OutHit = Pending.Hit;
+		return Pending.bHit;
+	}
+
+	//Return last frame's result and queue this frame's trace into the world's async batch
+	bool bHit = ConsumeAsyncProbe(Pending, OutHit);
+	if (Pending.SubmitFrame != GFrameCounter)
+	{
+		CountProbeQuery(Probe);
+		Pending.Handle = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End, ECC_Visibility, QueryParams);
+		Pending.SubmitFrame = GFrameCounter;
+	}
+	return bHit;
+}
+
+bool UParkourComponent::ParkourSweep(EParkourProbe Probe, FHitResult& OutHit, const FVector& Start, const FVector& End, const FCollisionShape& Shape,
+	const FCollisionQueryParams& QueryParams)
+{
+	bool bPrefetchedHit;
+	if (ConsumePrefetchedProbe(Probe, Start, End, OutHit, bPrefetchedHit))
+	{
+		return bPrefetchedHit;
+	}
+
+	//Characters out of FULL LOD trace the sweep's centre line, cheaper and close enough at a distance
+	const bool bLineOnly = (UpdateLOD != EParkourLOD::FULL);
+	if (GetProbeQueryMode(Probe) == EParkourQueryMode::SYNC)
+	{
+		CountProbeQuery(Probe);
+		return bLineOnly
+			? GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_Visibility, QueryParams)
+			: GetWorld()->SweepSingleByChannel(OutHit, Start, End, GetProbeFrame().Rotation, ECC_Visibility, Shape, QueryParams);
+	}
+
+	FParkourAsyncProbe& Pending = AsyncProbes[(uint8)Probe];
+	if (!HasAsyncProbeResult(Pending))
+	{
+		CountProbeQuery(Probe);
+		Pending.Handle = FTraceHandle();
+		Pending.bHit = bLineOnly
+			? GetWorld()->LineTraceSingleByChannel(Pending.Hit, Start, End, ECC_Visibility, QueryParams)
+			: GetWorld()->SweepSingleByChannel(Pending.Hit, Start, End, GetProbeFrame().Rotation, ECC_Visibility, Shape, QueryParams);
+		Pending.SubmitFrame = GFrameCounter;
+		OutHit = Pending.Hit;
+		return Pending.bHit;
+	}
+
+	bool bHit = ConsumeAsyncProbe(Pending, OutHit);
+	if (Pending.SubmitFrame != GFrameCounter)
+	{
+		CountProbeQuery(Probe);
+		Pending.Handle = bLineOnly
+			? GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End, ECC_Visibility, QueryParams)
+			: GetWorld()->AsyncSweepByChannel(EAsyncTraceType::Single, Start, End, GetProbeFrame().Rotation, ECC_Visibility, Shape, QueryParams);
+		Pending.SubmitFrame = GFrameCounter;
+	}
+	return bHit;
+}
+
+bool UParkourComponent::HasAsyncProbeResult(const FParkourAsyncProbe& Probe) const
+{
+	//Trace data is only kept until the frame after it was queued, UpdateRate and reduced LOD skip frames
+	return Probe.SubmitFrame == GFrameCounter or Probe.SubmitFrame + 1 == GFrameCounter;
+}
+
+bool UParkourComponent::ConsumeAsyncProbe(FParkourAsyncProbe& Probe, FHitResult& OutHit)
+{
+	if (Probe.Handle.IsValid() and Probe.SubmitFrame != GFrameCounter)
+	{
+		FTraceDatum Datum;
+		if (GetWorld()->QueryTraceData(Probe.Handle, Datum) and Datum.OutHits.Num() > 0)
+		{
+			Probe.Hit = Datum.OutHits[0];
+			Probe.bHit = Probe.Hit.bBlockingHit;
+		}
+		else
+		{
+			Probe.Hit = FHitResult();
+			Probe.bHit = false;
+		}
+		Probe.Handle = FTraceHandle();
+	}
+	OutHit = Probe.Hit;
+	return Probe.bHit;
+}
+
+bool UParkourComponent::ConsumePrefetchedProbe(EParkourProbe Probe, const FVector& Start, const FVector& End, FHitResult& OutHit, bool& bOutHit)
+{
+	//Only this update's frame, a rebuilt frame starts with no prefetched probes
+	FParkourProbeFrame::FPrefetchedProbe& Prefetched = ProbeFrame.Prefetched[(uint8)Probe];
+	if (!Prefetched.bDone or ProbeFrame.FrameNumber != GFrameCounter or Start != Prefetched.Start or End != Prefetched.End)
+	{
+		return false;
+	}
+	Prefetched.bDone = false;
+	INC_DWORD_STAT(STAT_ParkourPrefetchedProbes);
+	OutHit = Prefetched.Hit;
+	bOutHit = Prefetched.bHit;
+	return true;
+}
+
+FCollisionQueryParams UParkourComponent::GetLedgeQueryParams() const
+{
+	//Static ledges are covered by the database when its bake saw all of the level's static geometry,
+	//then only movable geometry still needs the sweep
+	FCollisionQueryParams QueryParams = FCollisionQueryParams::DefaultQueryParam;
+	if (LedgeDatabase and LedgeDatabase->CoversStaticGeometry())
+	{
+		QueryParams.MobilityType = EQueryMobilityType::Dynamic;
+	}
+	return QueryParams;
+}
+
+EParkourQueryMode UParkourComponent::GetProbeQueryMode(EParkourProbe Probe) const
+{
+	switch (Probe)
+	{
+	case EParkourProbe::WALLRUNRIGHT:
+	case EParkourProbe::WALLRUNLEFT:
+		return WallRunQueryMode;
+	case EParkourProbe::LEDGE:
+		return LedgeQueryMode;
+	case EParkourProbe::FORWARD:
+		return ForwardQueryMode;
+	case EParkourProbe::LEDGEGROUND:
+	case EParkourProbe::SLIDE:
+		return GroundQueryMode;
+	default:
+		return EParkourQueryMode::SYNC;
+	}
+}
+
+void UParkourComponent::CountProbeQuery(EParkourProbe Probe)
+{
+	UpdateQueries++;
+#if STATS
+	switch (Probe)
+	{
+	case EParkourProbe::WALLRUNRIGHT:
+		INC_DWORD_STAT(STAT_ParkourQueriesWallRunRight);
+		break;
+	case EParkourProbe::WALLRUNLEFT:
+		INC_DWORD_STAT(STAT_ParkourQueriesWallRunLeft);
+		break;
+	case EParkourProbe::LEDGE:
+		INC_DWORD_STAT(STAT_ParkourQueriesLedge);
+		break;
+	case EParkourProbe::FORWARD:
+		INC_DWORD_STAT(STAT_ParkourQueriesForward);
+		break;
+	case EParkourProbe::LEDGEGROUND:
+		INC_DWORD_STAT(STAT_ParkourQueriesLedgeGround);
+		break;
+	case EParkourProbe::SLIDE:
+		INC_DWORD_STAT(STAT_ParkourQueriesSlide);
+		break;
+	default:
+		break;
+	}
+#endif
 }
 
 void UParkourComponent::MantleCheck()
 {
+	SCOPE_CYCLE_COUNTER(STAT_ParkourMantleCheck);
 	if (CanMantle())
 	{
 		MantleStart();
@@ -463,6 +991,7 @@ void UParkourComponent::MantleStart()
 	bool change = SetParkourMode(EParkourMode::MANTLE);
 	if (change)
 	{
+		StartMantleMotion(CanQuickMantle() ? QuickMantleSpeed : MantleSpeed);
 		if (CanQuickMantle())
 		{
 			PlayCameraShake(QuickMantle);
@@ -471,32 +1000,58 @@ void UParkourComponent::MantleStart()
 		{
 			PlayCameraShake(Mantle);
 		}
-		CloseCheckMantleGate();
-		OpenMantleGate();
+		CloseCheckMantleGate_Implementation();
+		OpenMantleGate_Implementation();
 	}
 }
 
 void UParkourComponent::MantleMovement()
 {
+	SCOPE_CYCLE_COUNTER(STAT_ParkourMantleMovement);
 	//SetRotationToLookAtMantle
 	FVector PlayerLocation = Character->GetActorLocation();
 	FRotator LookAtRot = UKismetMathLibrary::FindLookAtRotation(
 		FVector(PlayerLocation.X, PlayerLocation.Y, 0.0),
 		FVector(MantlePosition.X, MantlePosition.Y, 0.0));
-	FRotator NewRot = FMath::RInterpTo(Character->GetControlRotation(), LookAtRot, GetWorld()->GetDeltaSeconds(), 7.0);
-	Character->GetController()->SetControlRotation(NewRot);
-
-	//SetActorLocationAtMantlePosition
-	float InterpSpeed = (CanQuickMantle()) ? QuickMantleSpeed : MantleSpeed;
-	FVector NewLoc = FMath::VInterpTo(PlayerLocation, MantlePosition, GetWorld()->GetDeltaSeconds(), InterpSpeed);
-	Character->SetActorLocation(NewLoc);
+	FRotator NewRot = FMath::RInterpTo(Character->GetControlRotation(), LookAtRot, UpdateDeltaTime, 7.0);
+	if (AController* Controller = Character->GetController())
+	{
+		Controller->SetControlRotation(NewRot);
+	}
 
-	if (FVector::Distance(Character->GetActorLocation(), MantlePosition) < 8.0)
+	//The mantle root motion moves the capsule and ends on a fixed frame
+	if (!IsMantleMoving())
 	{
 		VerticalWallRunEnd(0.5);
 	}
 }
 
+void UParkourComponent::StartMantleMotion(float InterpSpeed)
+{
+	if (ParkourMovement)
+	{
+		ParkourMovement->ParkourMantle(MantlePosition, InterpSpeed);
+	}
+	else
+	{
+		CharacterMovement->ApplyRootMotionSource(FRootMotionSource_ParkourMantle::Make(Character->GetActorLocation(), MantlePosition, InterpSpeed));
+	}
+	//Root motion doesn't run with movement disabled, the MANTLE custom mode handles it otherwise
+	if (!UsesParkourPhysics())
+	{
+		CharacterMovement->SetMovementMode(EMovementMode::MOVE_Flying);
+	}
+}
+
+bool UParkourComponent::IsMantleMoving() const
+{
+	if (ParkourMovement)
+	{
+		return ParkourMovement->IsMantling();
+	}
+	return CharacterMovement->GetRootMotionSource(FRootMotionSource_ParkourMantle::SourceName).IsValid();
+}
+
 void UParkourComponent::LedgeGrabJump()
 {
 	if (LedgeMantleOrVertical())
@@ -504,12 +1059,13 @@ void UParkourComponent::LedgeGrabJump()
 		VerticalWallRunEnd(0.35);
 		float XOverride = VerticalWallRunNormal.X * LedgeGrabJumpOffForce;
 		float YOverride = VerticalWallRunNormal.Y * LedgeGrabJumpOffForce;
-		Character->LaunchCharacter(FVector(XOverride, YOverride, LedgeGrabJumpOffHeight), false, true);
+		ParkourLaunch(FVector(XOverride, YOverride, LedgeGrabJumpOffHeight), false, true);
 	}
 }
 
 void UParkourComponent::SlideUpdate()
 {
+	SCOPE_CYCLE_COUNTER(STAT_ParkourSlideUpdate);
 	if (CurrentParkourMode == EParkourMode::SLIDE)
 	{
 		if (CharacterMovement->Velocity.Length() <= 35.0)
@@ -526,21 +1082,11 @@ void UParkourComponent::SlideStart()
 		SprintEnd();
 		SetParkourMode(EParkourMode::SLIDE);
 		Character->Crouch();
-		CharacterMovement->GroundFriction = 0.0;
-		CharacterMovement->BrakingDecelerationWalking = 1000.0;
-		CharacterMovement->MaxWalkSpeedCrouched = 0.0;
-		CharacterMovement->SetPlaneConstraintFromVectors(
-			CharacterMovement->Velocity.GetSafeNormal(), 
-			Character->GetActorUpVector());
-		CharacterMovement->SetPlaneConstraintEnabled(true);
-		FVector SlideVector = GetSlideVector();
-		if (SlideVector.Z <= 0.02)
-		{
-			CharacterMovement->AddImpulse(SlideVector * SlideImpulseAmount, true);
-		}
-		OpenSlideGate();
-		bSprintQueued = false;
-		bSlideQueued = false;
+		InvalidateProbeFrame();
+		ApplySlideMovement();
+		OpenSlideGate_Implementation();
+		InputBuffer.Clear(EParkourBufferedAction::SPRINT);
+		InputBuffer.Clear(EParkourBufferedAction::SLIDE);
 	}
 }
 
@@ -552,10 +1098,11 @@ void UParkourComponent::SlideEnd(bool bCrouch)
 		bool changed = SetParkourMode(NewMode);
 		if (changed)
 		{
-			CloseSlideGate();
+			CloseSlideGate_Implementation();
 			if (bCrouch == false)
 			{
 				Character->UnCrouch();
+				InvalidateProbeFrame();
 			}
 		}
 	}
@@ -571,6 +1118,7 @@ void UParkourComponent::SlideJump()
 
 void UParkourComponent::SprintUpdate()
 {
+	SCOPE_CYCLE_COUNTER(STAT_ParkourSprintUpdate);
 	if (CurrentParkourMode == EParkourMode::SPRINT)
 	{
 		if ((ForwardInput() > 0.0) == false)
@@ -590,9 +1138,9 @@ void UParkourComponent::SprintStart()
 		if (SetParkourMode(EParkourMode::SPRINT))
 		{
 			CharacterMovement->MaxWalkSpeed = SprintSpeed;
-			OpenSprintGate();
-			bSprintQueued = false;
-			bSlideQueued = false;
+			OpenSprintGate_Implementation();
+			InputBuffer.Clear(EParkourBufferedAction::SPRINT);
+			InputBuffer.Clear(EParkourBufferedAction::SLIDE);
 		}
 	}
 
@@ -605,12 +1153,9 @@ void UParkourComponent::SprintEnd()
 		bool changed = SetParkourMode(EParkourMode::NONE);
 		if (changed)
 		{
-			CloseSprintGate();
+			CloseSprintGate_Implementation();
 
-			FTimerDelegate TimerDel;
-			FTimerHandle TimerHandle;
-			TimerDel.BindUFunction(this, FName("OpenSprintGate"));
-			GetWorld()->GetTimerManager().SetTimer(TimerHandle, TimerDel, 0.1, false);
+			Scheduler.Reschedule(SprintGateTimer, &UParkourComponent::OpenSprintGate_Implementation, 0.1);
 		}
 	}
 }
@@ -620,12 +1165,16 @@ void UParkourComponent::SprintJump()
 	if (CurrentParkourMode == EParkourMode::SPRINT)
 	{
 		SprintEnd();
-		bSprintQueued = true;
+		InputBuffer.Buffer(EParkourBufferedAction::SPRINT, GetInputTime());
 	}
 }
 
 void UParkourComponent::SprintEvent()
 {
+	if (!AcceptEvent(EParkourRecordOp::SPRINT))
+	{
+		return;
+	}
 	SprintStart();
 }
 
@@ -634,9 +1183,10 @@ void UParkourComponent::CrouchStart()
 	if (CurrentParkourMode == EParkourMode::NONE)
 	{
 		Character->Crouch();
+		InvalidateProbeFrame();
 		SetParkourMode(EParkourMode::CROUCH);
-		bSprintQueued = false;
-		bSlideQueued = false;
+		InputBuffer.Clear(EParkourBufferedAction::SPRINT);
+		InputBuffer.Clear(EParkourBufferedAction::SLIDE);
 	}
 }
 
@@ -645,9 +1195,10 @@ void UParkourComponent::CrouchEnd()
 	if (CurrentParkourMode == EParkourMode::CROUCH)
 	{
 		Character->UnCrouch();
+		InvalidateProbeFrame();
 		SetParkourMode(EParkourMode::NONE);
-		bSprintQueued = false;
-		bSlideQueued = false;
+		InputBuffer.Clear(EParkourBufferedAction::SPRINT);
+		InputBuffer.Clear(EParkourBufferedAction::SLIDE);
 	}
 }
 
@@ -661,6 +1212,10 @@ void UParkourComponent::CrouchJump()
 
 void UParkourComponent::CrouchSlideEvent()
 {
+	if (!AcceptEvent(EParkourRecordOp::CROUCHSLIDE))
+	{
+		return;
+	}
 	if (LedgeMantleOrVertical())
 	{
 		VerticalWallRunEnd(0.5);
@@ -679,7 +1234,7 @@ void UParkourComponent::CrouchSlideEvent()
 			}
 			else
 			{
-				bSlideQueued = true;
+				InputBuffer.Buffer(EParkourBufferedAction::SLIDE, GetInputTime());
 			}
 		}
 		else
@@ -691,137 +1246,925 @@ void UParkourComponent::CrouchSlideEvent()
 
 void UParkourComponent::ToggleCrouch()
 {
-	switch (CurrentParkourMode)
+	if (FParkourSimRules::HasCategory(ToSimMode(CurrentParkourMode), MODECAT_CROUCHSTART))
 	{
-	case EParkourMode::NONE:
 		CrouchStart();
-		break;
-	case EParkourMode::LEFTWALLRUN:
-		break;
-	case EParkourMode::RIGHTWALLRUN:
-		break;
-	case EParkourMode::VERTICALWALLRUN:
-		break;
-	case EParkourMode::LEDGEGRAB:
-		break;
+	}
+	else if (FParkourSimRules::HasCategory(ToSimMode(CurrentParkourMode), MODECAT_CROUCHEND))
+	{
+		CrouchEnd();
+	}
+}
+
+void UParkourComponent::JumpMovement()
+{
+	if (CanJump())
+	{
+		//UE_LOG(LogTemp, Warning, TEXT("Jump Movement"));
+		FVector JumpVelocity = FVector(0, 0, CharacterMovement->JumpZVelocity);
+		ParkourLaunch(JumpVelocity, false, true);
+		TimesJumped++;
+	}
+}
+
+void UParkourComponent::OpenWallRunGate_Implementation()
+{
+	SetGates(Gates | (uint8)EParkourGate::WALLRUN);
+}
+
+void UParkourComponent::CloseWallRunGate_Implementation()
+{
+	SetGates(Gates & ~(uint8)EParkourGate::WALLRUN);
+}
+
+void UParkourComponent::OpenVerticalWallRunGate_Implementation()
+{
+	SetGates(Gates | (uint8)EParkourGate::VERTICALWALLRUN);
+}
+
+void UParkourComponent::CloseVerticalWallRunGate_Implementation()
+{
+	SetGates(Gates & ~(uint8)EParkourGate::VERTICALWALLRUN);
+}
+
+void UParkourComponent::OpenMantleGate_Implementation()
+{
+	SetGates(Gates | (uint8)EParkourGate::MANTLE);
+}
+
+void UParkourComponent::CloseMantleGate_Implementation()
+{
+	SetGates(Gates & ~(uint8)EParkourGate::MANTLE);
+}
+
+void UParkourComponent::OpenCheckMantleGate_Implementation()
+{
+	SetGates(Gates | (uint8)EParkourGate::CHECKMANTLE);
+}
+
+void UParkourComponent::CloseCheckMantleGate_Implementation()
+{
+	SetGates(Gates & ~(uint8)EParkourGate::CHECKMANTLE);
+}
+
+void UParkourComponent::OpenSlideGate_Implementation()
+{
+	SetGates(Gates | (uint8)EParkourGate::SLIDE);
+}
+
+void UParkourComponent::CloseSlideGate_Implementation()
+{
+	SetGates(Gates & ~(uint8)EParkourGate::SLIDE);
+}
+
+void UParkourComponent::OpenSprintGate_Implementation()
+{
+	SetGates(Gates | (uint8)EParkourGate::SPRINT);
+}
+
+void UParkourComponent::CloseSprintGate_Implementation()
+{
+	SetGates(Gates & ~(uint8)EParkourGate::SPRINT);
+}
+
+bool UParkourComponent::IsGateOpen(EParkourGate Gate) const
+{
+	return (Gates & (uint8)Gate) != 0;
+}
+
+void UParkourComponent::SetGates(int32 NewGates)
+{
+	int32 PrevGates = Gates;
+	Gates = NewGates;
+	if (PrevGates != Gates and bGatesChangedEventImplemented)
+	{
+		GatesChangedEvent(PrevGates, Gates);
+	}
+}
+
+void UParkourComponent::DispatchUpdate()
+{
+	//Each gate is re-read because an update may open or close the ones after it
+	if (Gates & (uint8)EParkourGate::WALLRUN)
+	{
+		WallRunUpdate();
+	}
+	if (Gates & (uint8)EParkourGate::VERTICALWALLRUN)
+	{
+		VerticalWallRunUpdate();
+	}
+	if (Gates & (uint8)EParkourGate::CHECKMANTLE)
+	{
+		MantleCheck();
+	}
+	if (Gates & (uint8)EParkourGate::MANTLE)
+	{
+		MantleMovement();
+	}
+	if (Gates & (uint8)EParkourGate::SLIDE)
+	{
+		SlideUpdate();
+	}
+	if (Gates & (uint8)EParkourGate::SPRINT)
+	{
+		SprintUpdate();
+	}
+}
+
+void UParkourComponent::StateOnlyUpdate()
+{
+	//Slide and mantle end without a probe. The wall modes only end on one, so they are let go instead of running
+	//on past the wall until the character is promoted.
+	switch (CurrentParkourMode)
+	{
+	case EParkourMode::LEFTWALLRUN:
+	case EParkourMode::RIGHTWALLRUN:
+		WallRunEnd(0.35);
+		break;
+	case EParkourMode::VERTICALWALLRUN:
+	case EParkourMode::LEDGEGRAB:
+		VerticalWallRunEnd(0.35);
+		break;
 	case EParkourMode::MANTLE:
+		if (!IsMantleMoving())
+		{
+			VerticalWallRunEnd(0.5);
+		}
 		break;
 	case EParkourMode::SLIDE:
+		SlideUpdate();
 		break;
-	case EParkourMode::SPRINT:
+	default:
 		break;
-	case EParkourMode::CROUCH:
-		CrouchEnd();
+	}
+}
+
+void UParkourComponent::OpenGates()
+{
+	OpenWallRunGate_Implementation();
+	OpenVerticalWallRunGate_Implementation();
+	OpenSlideGate_Implementation();
+	OpenSprintGate_Implementation();
+}
+
+void UParkourComponent::CloseGates()
+{
+	//Pending reopens would otherwise reopen gates after landing
+	Scheduler.Cancel(WallRunGateTimer);
+	Scheduler.Cancel(VerticalWallRunGateTimer);
+	Scheduler.Cancel(SprintGateTimer);
+
+	CloseWallRunGate_Implementation();
+	CloseVerticalWallRunGate_Implementation();
+	CloseSlideGate_Implementation();
+	CloseSprintGate_Implementation();
+}
+
+void UParkourComponent::CheckQueues()
+{
+	//Both need the ground, in the air they stay buffered for the landing
+	if (!CharacterMovement->IsWalking())
+	{
+		return;
+	}
+	if (IsInputBuffered(EParkourBufferedAction::SLIDE) and CanSlide())
+	{
+		ConsumeBufferedInput(EParkourBufferedAction::SLIDE);
+		SlideStart();
+	}
+	else if (ConsumeBufferedInput(EParkourBufferedAction::SPRINT))
+	{
+		SprintStart();
+	}
+}
+
+double UParkourComponent::GetInputTime() const
+{
+	return GetWorld()->GetTimeSeconds();
+}
+
+float UParkourComponent::GetBufferLifetime(EParkourBufferedAction Action) const
+{
+	switch (Action)
+	{
+	case EParkourBufferedAction::JUMP:
+		return JumpBufferTime;
+	case EParkourBufferedAction::SLIDE:
+		return SlideBufferTime;
+	case EParkourBufferedAction::SPRINT:
+		return SprintBufferTime;
+	case EParkourBufferedAction::DASH:
+		return DashBufferTime;
+	default:
+		return 0.0f;
+	}
+}
+
+bool UParkourComponent::IsInputBuffered(EParkourBufferedAction Action) const
+{
+	return InputBuffer.IsBuffered(Action, GetInputTime(), GetBufferLifetime(Action));
+}
+
+bool UParkourComponent::ConsumeBufferedInput(EParkourBufferedAction Action)
+{
+	double Age;
+	if (!InputBuffer.Consume(Action, GetInputTime(), GetBufferLifetime(Action), Age))
+	{
+		return false;
+	}
+	INC_DWORD_STAT(STAT_ParkourBufferedInputs);
+	SET_FLOAT_STAT(STAT_ParkourBufferedInputLatency, Age * 1000.0);
+	return true;
+}
+
+void UParkourComponent::JumpEvents()
+{
+	WallRunJump();
+	LedgeGrabJump();
+	SlideJump();
+	CrouchJump();
+	SprintJump();
+	TimesJumped++;
+}
+
+void UParkourComponent::EndEvents()
+{
+	WallRunEnd(0.0);
+	VerticalWallRunEnd(0.0);
+	SprintEnd();
+	SlideEnd(false);
+
+}
+
+void UParkourComponent::MovementChanged(EMovementMode PrevMovement, EMovementMode CurrentMovement)
+{
+	if (Character)
+	{
+		WakeUpdate();
+		PrevMovementMode = PrevMovement;
+		CurrentMovementMode = CurrentMovement;
+		if (PrevMovementMode == EMovementMode::MOVE_Walking and CurrentMovementMode == EMovementMode::MOVE_Falling)
+		{
+			//A jump has already counted itself, anything else walked off an edge
+			if (TimesJumped == 0)
+			{
+				InputBuffer.OpenCoyote(EParkourCoyote::GROUND, GetInputTime());
+			}
+			SprintJump();
+			EndEvents();
+			OpenGates();
+		}
+		else
+		{
+			//Landing out of a parkour custom mode counts as landing from a fall
+			bool bWasAirborne = (PrevMovementMode == EMovementMode::MOVE_Falling or PrevMovementMode == EMovementMode::MOVE_Custom);
+			if (bWasAirborne and CurrentMovementMode == EMovementMode::MOVE_Walking)
+			{
+				InputBuffer.CloseCoyote();
+				CheckQueues();
+				if (ConsumeBufferedInput(EParkourBufferedAction::JUMP))
+				{
+					PerformJump(true);
+				}
+			}
+		}
+	}
+}
+
+void UParkourComponent::ParkourChanged(EParkourMode PrevParkour, EParkourMode CurrentParkour)
+{
+	INC_DWORD_STAT(STAT_ParkourModeTransitions);
+	TRACE_PARKOUR_MODE_TRANSITION(this, PrevParkour, CurrentParkour);
+	if (Recorder)
+	{
+		Recorder->WriteOp(SessionUpdate, EParkourRecordOp::MODE, (uint8)CurrentParkour);
+	}
+	else if (Playback)
+	{
+		CheckPlaybackTransition(CurrentParkour);
+	}
+	PrevParkourMode = PrevParkour;
+	CurrentParkourMode = CurrentParkour;
+	WakeUpdate();
+	Correction.Cancel();
+	CancelStaleTimers();
+	ResetMovement();
+	CameraTick();
+}
+
+bool UParkourComponent::SetParkourMode(EParkourMode NewMode)
+{
+	if (CurrentParkourMode == NewMode)
+	{
+		return false;
+	}
+	else
+	{
+		//Server replays of aggregated client moves may skip intermediate modes, anything else stays in the current mode
+		if (!IsDrivenRemotely() and !ensureMsgf(FParkourSimRules::CanTransition(ToSimMode(CurrentParkourMode), ToSimMode(NewMode)),
+			TEXT("Parkour transition %d -> %d is missing from FParkourSimRules::ModeTable"), (int32)CurrentParkourMode, (int32)NewMode))
+		{
+			return false;
+		}
+		ParkourChanged(CurrentParkourMode, NewMode);
+		TimesJumped = 0;
+		SyncPredictedState();
+		return true;
+	}
+}
+
+void UParkourComponent::ParkourLaunch(FVector LaunchVelocity, bool bXYOverride, bool bZOverride)
+{
+	if (ParkourMovement)
+	{
+		ParkourMovement->ParkourLaunch(LaunchVelocity, bXYOverride, bZOverride);
+	}
+	else
+	{
+		Character->LaunchCharacter(LaunchVelocity, bXYOverride, bZOverride);
+	}
+}
+
+void UParkourComponent::SyncPredictedState()
+{
+	if (ParkourMovement and !IsDrivenRemotely())
+	{
+		ParkourMovement->SetParkourState((uint8)CurrentParkourMode, (uint8)FMath::Clamp(TimesJumped, 0, 255));
+	}
+}
+
+void UParkourComponent::ServerParkourStateReceived(uint8 InParkourMode, uint8 InTimesJumped)
+{
+	//Replays the mode entry side effects the owning client applied before this move
+	EParkourMode NewMode = (EParkourMode)InParkourMode;
+	switch (NewMode)
+	{
+	case EParkourMode::LEDGEGRAB:
+		GrabLedge();
+		break;
+	case EParkourMode::SLIDE:
+		if (SetParkourMode(NewMode))
+		{
+			ApplySlideMovement();
+		}
+		break;
+	case EParkourMode::SPRINT:
+		if (SetParkourMode(NewMode))
+		{
+			CharacterMovement->MaxWalkSpeed = SprintSpeed;
+		}
 		break;
 	default:
+		SetParkourMode(NewMode);
+		break;
+	}
+	TimesJumped = InTimesJumped;
+}
+
+bool UParkourComponent::ProbeParkourWall(uint8 InParkourMode, FVector& OutWallNormal)
+{
+	//Plain sync queries, a prefetched or async result belongs to the update and may come from before this move
+	const FParkourProbeFrame& Frame = GetProbeFrame();
+	FHitResult Hit;
+	switch ((EParkourMode)InParkourMode)
+	{
+	case EParkourMode::RIGHTWALLRUN:
+	case EParkourMode::LEFTWALLRUN:
+	{
+		float Range = ((EParkourMode)InParkourMode == EParkourMode::RIGHTWALLRUN) ? 75.0 : -75.0;
+		if (!IsAirborne() or !GetWorld()->LineTraceSingleByChannel(Hit, Frame.Location, GetWallRunEndVector(Range), ECC_Visibility)
+			or !FParkourSimRules::IsWallRunnableNormal(Hit.Normal.Z))
+		{
+			return false;
+		}
+		break;
+	}
+	case EParkourMode::VERTICALWALLRUN:
+	case EParkourMode::LEDGEGRAB:
+	{
+		if (!GetWorld()->SweepSingleByChannel(Hit, Frame.MantleFeet, Frame.MantleFeet + (Frame.Forward * 50.0), Frame.Rotation, ECC_Visibility,
+			FCollisionShape::MakeCapsule(10.0, 5.0)) or Hit.Normal.Z < -0.1)
+		{
+			return false;
+		}
+		//A ledge also needs the walkable top VerticalWallRunUpdate grabs
+		FHitResult LedgeHit;
+		if ((EParkourMode)InParkourMode == EParkourMode::LEDGEGRAB
+			and (!GetWorld()->SweepSingleByChannel(LedgeHit, Frame.MantleEyes, Frame.MantleFeet, Frame.Rotation, ECC_Visibility,
+				FCollisionShape::MakeCapsule(20.0, 10.0)) or !CharacterMovement->IsWalkable(LedgeHit)))
+		{
+			return false;
+		}
 		break;
 	}
+	default:
+		return false;
+	}
+	OutWallNormal = Hit.Normal;
+	return true;
+}
+
+bool UParkourComponent::ProbeMantleTarget(const FVector& ClientTarget, FVector& OutTarget)
+{
+	//The ledge sweep VerticalWallRunUpdate grabs with, placed as EnterLedgeGrab places MantlePosition
+	const FParkourProbeFrame& Frame = GetProbeFrame();
+	const FVector StandingOffset(0.0, 0.0, Frame.CapsuleHalfHeight);
+	FHitResult Hit;
+	if (GetWorld()->SweepSingleByChannel(Hit, Frame.MantleEyes, Frame.MantleFeet, Frame.Rotation, ECC_Visibility, FCollisionShape::MakeCapsule(20.0, 10.0))
+		and CharacterMovement->IsWalkable(Hit))
+	{
+		OutTarget = Hit.ImpactPoint + StandingOffset;
+		return true;
+	}
+	//The hang position may sit a little off the client's, its ledge still counts if the sweep's capsule could have touched it
+	if (FMath::PointDistToSegment(ClientTarget - StandingOffset, Frame.MantleEyes, Frame.MantleFeet) <= 20.0)
+	{
+		OutTarget = ClientTarget;
+		return true;
+	}
+	return false;
+}
+
+void UParkourComponent::ParkourWallLost()
+{
+	//Same ends as the updates losing the wall
+	if (IsWallRunning())
+	{
+		WallRunEnd(0.5);
+	}
+	else if (CurrentParkourMode == EParkourMode::VERTICALWALLRUN)
+	{
+		VerticalWallRunEnd(0.35);
+	}
+}
+
+bool UParkourComponent::IsDrivenRemotely() const
+{
+	//A remote client's parkour decisions arrive through its moves, simulated proxies have no input to decide with
+	if (ParkourMovement and Character->GetLocalRole() == ROLE_Authority and Character->GetRemoteRole() == ROLE_AutonomousProxy)
+	{
+		return !Character->IsLocallyControlled();
+	}
+	return (Character->GetLocalRole() == ROLE_SimulatedProxy);
+}
+
+bool UParkourComponent::UsesParkourPhysics() const
+{
+	return ParkourMovement and ParkourMovement->UsesParkourPhysics();
+}
+
+bool UParkourComponent::IsAirborne() const
+{
+	return CharacterMovement->IsFalling() or CharacterMovement->MovementMode == EMovementMode::MOVE_Custom;
+}
+
+void UParkourComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME_CONDITION(UParkourComponent, ReplicatedState, COND_SkipOwner);
+}
+
+void UParkourComponent::UpdateReplicatedState()
+{
+	//Most updates change nothing, skip encoding the normals again
+	if (CurrentParkourMode == ReplicatedMode and TimesJumped == ReplicatedTimesJumped and bCanDash == bReplicatedCanDash
+		and WallRunNormal == ReplicatedWallRunNormal and LedgeClimbWallNormal == ReplicatedLedgeClimbWallNormal)
+	{
+		return;
+	}
+	ReplicatedMode = CurrentParkourMode;
+	ReplicatedTimesJumped = TimesJumped;
+	bReplicatedCanDash = bCanDash;
+	ReplicatedWallRunNormal = WallRunNormal;
+	ReplicatedLedgeClimbWallNormal = LedgeClimbWallNormal;
+	ReplicatedState.Set(CurrentParkourMode, TimesJumped, bCanDash, WallRunNormal, LedgeClimbWallNormal);
+}
+
+void UParkourComponent::OnRep_ReplicatedState()
+{
+	//Proxies only mirror the state for animation and effects, movement is driven by the server
+	EParkourMode NewMode = ReplicatedState.GetMode();
+	if (NewMode != CurrentParkourMode)
+	{
+		PrevParkourMode = CurrentParkourMode;
+		CurrentParkourMode = NewMode;
+	}
+	TimesJumped = ReplicatedState.GetTimesJumped();
+	bCanDash = ReplicatedState.GetCanDash();
+	WallRunNormal = ReplicatedState.GetWallRunNormal();
+	LedgeClimbWallNormal = ReplicatedState.GetLedgeClimbWallNormal();
+}
+
+bool UParkourComponent::CanSleep() const
+{
+	//Idle on the ground with nothing pending, only an event, a movement mode change or input can start parkour from here.
+	//Recording and playback count updates, so they keep the update awake.
+	return bAllowUpdateSleep and ParkourMovement
+		and CurrentParkourMode == EParkourMode::NONE
+		and CharacterMovement->IsMovingOnGround()
+		and CharacterMovement->GetCurrentAcceleration().IsNearlyZero()
+		and CharacterMovement->GetLastInputVector().IsNearlyZero()
+		and Scheduler.Num() == 0
+		and !Correction.IsActive()
+		and !Recorder and !Playback;
+}
+
+void UParkourComponent::SleepUpdate()
+{
+	bUpdateAsleep = true;
+	ParkourLOD::SleepingCount++;
+	//The manager skips sleeping components itself
+	if (!bManagedUpdate)
+	{
+		SetComponentTickEnabled(false);
+	}
+}
+
+void UParkourComponent::WakeUpdate()
+{
+	if (!bUpdateAsleep)
+	{
+		return;
+	}
+	bUpdateAsleep = false;
+	ParkourLOD::SleepingCount--;
+	//Time spent asleep says nothing about where the players are now
+	LODScoreTime = LODScoreInterval;
+	InvalidateProbeFrame();
+	if (!bManagedUpdate)
+	{
+		SetComponentTickEnabled(true);
+	}
+}
+
+FParkourSimConfig UParkourComponent::GetSimConfig() const
+{
+	FParkourSimConfig Config;
+	Config.WallRunSpeed = WallRunSpeed;
+	Config.WallRunSprintSpeed = WallRunSprintSpeed;
+	Config.WallRunTargetGravity = WallRunTargetGravity;
+	Config.WallJumpForce = WallJumpForce;
+	Config.WallJumpScale = WallJumpScale;
+	Config.MantleHeight = MantleHeight;
+	Config.MantleSpeed = MantleSpeed;
+	Config.QuickMantleSpeed = QuickMantleSpeed;
+	Config.VerticalWallRunSpeed = VerticalWallRunSpeed;
+	Config.LedgeGrabJumpOffForce = LedgeGrabJumpOffForce;
+	Config.LedgeGrabJumpOffHeight = LedgeGrabJumpOffHeight;
+	Config.SprintSpeed = SprintSpeed;
+	Config.SlideImpulseAmount = SlideImpulseAmount;
+	Config.DashScale = DashScale;
+	Config.DashRange = DashRange;
+	Config.MaxRangeScale = MaxRangeScale;
+	Config.MaxJumps = MaxJumps;
+	return Config;
+}
+
+void UParkourComponent::SetUpdateInterval(float Interval)
+{
+	UpdateInterval = Interval;
+	if (!bManagedUpdate)
+	{
+		SetComponentTickInterval(Interval);
+	}
+}
+
+void UParkourComponent::UpdateLODBucket(float DeltaTime)
+{
+	LODScoreTime += DeltaTime;
+	if (LODScoreTime < LODScoreInterval)
+	{
+		return;
+	}
+	LODScoreTime = 0.0f;
+	SetUpdateLOD(ScoreLOD());
+}
+
+EParkourLOD UParkourComponent::ScoreLOD() const
+{
+	if (!bUseUpdateLOD or Character->IsLocallyControlled() or Recorder or Playback)
+	{
+		return EParkourLOD::FULL;
+	}
+	//A remote player's moves are replayed and checked here at the rate they arrive, however far away the others are
+	if (GetOwnerRole() == ROLE_Authority and Character->IsPlayerControlled())
+	{
+		return EParkourLOD::FULL;
+	}
+
+	const FVector Location = Character->GetActorLocation();
+	double NearestSq = UE_BIG_NUMBER;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = It->Get();
+		if (!PlayerController or PlayerController == Character->GetController())
+		{
+			continue;
+		}
+		//Local players score against their camera, remote ones on a server against their pawn
+		FVector ViewLocation;
+		if (PlayerController->PlayerCameraManager)
+		{
+			ViewLocation = PlayerController->PlayerCameraManager->GetCameraLocation();
+		}
+		else if (const APawn* Pawn = PlayerController->GetPawn())
+		{
+			ViewLocation = Pawn->GetActorLocation();
+		}
+		else
+		{
+			continue;
+		}
+		NearestSq = FMath::Min(NearestSq, FVector::DistSquared(Location, ViewLocation));
+	}
+	const double Nearest = FMath::Sqrt(NearestSq);
+
+	//Thresholds move away from the current bucket so a character on a boundary keeps its bucket
+	auto Threshold = [this](float Distance, EParkourLOD Bucket)
+	{
+		return Distance * ((UpdateLOD >= Bucket) ? (1.0f - LODHysteresis) : (1.0f + LODHysteresis));
+	};
+	EParkourLOD NewLOD = EParkourLOD::FULL;
+	if (Nearest > Threshold(StateOnlyLODDistance, EParkourLOD::STATEONLY))
+	{
+		NewLOD = EParkourLOD::STATEONLY;
+	}
+	else if (Nearest > Threshold(ReducedLODDistance, EParkourLOD::REDUCED))
+	{
+		NewLOD = EParkourLOD::REDUCED;
+	}
+
+	//Off screen drops one bucket, dedicated servers render nothing so only distance counts there
+	if (NewLOD == EParkourLOD::FULL and GetNetMode() != NM_DedicatedServer and !Character->WasRecentlyRendered(LODScoreInterval))
+	{
+		NewLOD = EParkourLOD::REDUCED;
+	}
+	return NewLOD;
+}
+
+void UParkourComponent::SetUpdateLOD(EParkourLOD NewLOD)
+{
+	if (NewLOD == UpdateLOD)
+	{
+		return;
+	}
+	if (bLODCounted)
+	{
+		ParkourLOD::BucketCounts[(uint8)UpdateLOD]--;
+		ParkourLOD::BucketCounts[(uint8)NewLOD]++;
+	}
+	//The mode is kept across buckets, only the rate and probe shapes change, so nothing pops on promotion
+	UpdateLOD = NewLOD;
+	float Rate = UpdateRate;
+	if (NewLOD == EParkourLOD::REDUCED)
+	{
+		Rate = (UpdateRate > 0.0) ? FMath::Min(UpdateRate, ReducedLODUpdateRate) : ReducedLODUpdateRate;
+	}
+	else if (NewLOD == EParkourLOD::STATEONLY)
+	{
+		Rate = StateOnlyLODUpdateRate;
+	}
+	SetUpdateInterval((Rate > 0.0) ? (1.0 / Rate) : 0.0);
+
+	//Async results were submitted for the old probe shapes
+	for (FParkourAsyncProbe& Probe : AsyncProbes)
+	{
+		Probe = FParkourAsyncProbe();
+	}
+	InvalidateProbeFrame();
 }
 
-void UParkourComponent::JumpMovement()
+bool UParkourComponent::StartRecording()
 {
-	if (CanJump())
+	if (Character == nullptr or Playback)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Jump Movement"));
-		FVector JumpVelocity = FVector(0, 0, CharacterMovement->JumpZVelocity);
-		Character->LaunchCharacter(JumpVelocity, false, true);
-		TimesJumped++;
+		return false;
+	}
+	FParkourRecordingHeader Header;
+	FVector Location = Character->GetActorLocation();
+	FRotator Rotation = Character->GetActorRotation();
+	FRotator ControlRotation = Character->GetControlRotation();
+	FVector Velocity = CharacterMovement->Velocity;
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		Header.Location[Axis] = Location[Axis];
+		Header.Velocity[Axis] = Velocity[Axis];
 	}
+	Header.Rotation[0] = Rotation.Pitch;
+	Header.Rotation[1] = Rotation.Yaw;
+	Header.Rotation[2] = Rotation.Roll;
+	Header.ControlRotation[0] = ControlRotation.Pitch;
+	Header.ControlRotation[1] = ControlRotation.Yaw;
+	Header.ControlRotation[2] = ControlRotation.Roll;
+	Header.Mode = (uint8)CurrentParkourMode;
+
+	Recorder = MakeShared<FParkourRecordingWriter>(ParkourRecording::MakeRecordingPath(this), Header);
+	WakeUpdate();
+	UE_LOG(LogTemp, Log, TEXT("Recording parkour to %s"), *Recorder->GetPath());
+	return true;
 }
 
-void UParkourComponent::OpenGates()
+void UParkourComponent::StopRecording()
 {
-	OpenWallRunGate();
-	OpenVerticalWallRunGate();
-	OpenSlideGate();
-	OpenSprintGate();
+	Recorder.Reset();
 }
 
-void UParkourComponent::CloseGates()
+bool UParkourComponent::StartPlayback(const FString& Path)
 {
-	CloseWallRunGate();
-	CloseVerticalWallRunGate();
-	CloseSlideGate();
-	CloseSprintGate();
+	if (Character == nullptr)
+	{
+		return false;
+	}
+	TSharedPtr<FParkourRecordingReader> Reader = MakeShared<FParkourRecordingReader>();
+	if (!Reader->Load(Path))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s is not a parkour recording"), *Path);
+		return false;
+	}
+	StopRecording();
+
+	const FParkourRecordingHeader& Header = Reader->GetHeader();
+	Character->SetActorLocationAndRotation(
+		FVector(Header.Location[0], Header.Location[1], Header.Location[2]),
+		FRotator(Header.Rotation[0], Header.Rotation[1], Header.Rotation[2]),
+		false, nullptr, ETeleportType::TeleportPhysics);
+	if (AController* Controller = Character->GetController())
+	{
+		Controller->SetControlRotation(FRotator(Header.ControlRotation[0], Header.ControlRotation[1], Header.ControlRotation[2]));
+	}
+	CharacterMovement->Velocity = FVector(Header.Velocity[0], Header.Velocity[1], Header.Velocity[2]);
+	if (Header.Mode != (uint8)CurrentParkourMode)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s starts in parkour mode %d, playing back from mode %d"), *Path, Header.Mode, (int32)CurrentParkourMode);
+	}
+	//The stream replaces the player's input until it runs out
+	if (APlayerController* PlayerController = Cast<APlayerController>(Character->GetController()))
+	{
+		Character->DisableInput(PlayerController);
+	}
+
+	Playback = Reader;
+	WakeUpdate();
+	PlaybackInput = FVector::ZeroVector;
+	PlaybackDeltaTime = 0.0f;
+	PlaybackMismatches = 0;
+	SessionUpdate = 0;
+	//Presses buffered during live play would otherwise fire inside the recording
+	InputBuffer.Reset();
+	InvalidateProbeFrame();
+	return true;
 }
 
-void UParkourComponent::CheckQueues()
+void UParkourComponent::StopPlayback()
 {
-	if (bSlideQueued)
+	if (!Playback)
 	{
-		SlideStart();
+		return;
 	}
-	else if (bSprintQueued)
+	UE_LOG(LogTemp, Log, TEXT("Parkour playback stopped after %u updates, %d transition mismatches"), SessionUpdate, PlaybackMismatches);
+	Playback.Reset();
+	PlaybackInput = FVector::ZeroVector;
+	InvalidateProbeFrame();
+	if (APlayerController* PlayerController = Cast<APlayerController>(Character->GetController()))
 	{
-		SprintStart();
+		Character->EnableInput(PlayerController);
 	}
 }
 
-void UParkourComponent::JumpEvents()
+bool UParkourComponent::AcceptEvent(EParkourRecordOp Op)
 {
-	WallRunJump();
-	LedgeGrabJump();
-	SlideJump();
-	CrouchJump();
-	SprintJump();
-	TimesJumped++;
+	//Every event entry point passes through here, so this is where a sleeping update wakes
+	WakeUpdate();
+	if (Playback)
+	{
+		//Live calls such as the landing notify are replaced by their recorded counterparts
+		return bDispatchingPlayback;
+	}
+	if (Recorder)
+	{
+		RecordInput();
+		Recorder->WriteOp(SessionUpdate, Op);
+	}
+	return true;
 }
 
-void UParkourComponent::EndEvents()
+void UParkourComponent::RecordInput()
 {
-	WallRunEnd(0.0);
-	VerticalWallRunEnd(0.0);
-	SprintEnd();
-	SlideEnd(false);
-
+	Recorder->WriteInput(SessionUpdate, CharacterMovement->GetLastInputVector());
 }
 
-void UParkourComponent::MovementChanged(EMovementMode PrevMovement, EMovementMode CurrentMovement)
+void UParkourComponent::AdvancePlayback()
 {
-	if (Character)
+	while (const FParkourRecordedOp* Op = Playback->NextOp(SessionUpdate))
 	{
-		PrevMovementMode = PrevMovement;
-		CurrentMovementMode = CurrentMovement;
-		if (PrevMovementMode == EMovementMode::MOVE_Walking and CurrentMovementMode == EMovementMode::MOVE_Falling)
-		{
-			SprintJump();
-			EndEvents();
-			OpenGates();
-		}
-		else
+		bDispatchingPlayback = true;
+		switch (Op->Op)
 		{
-			if (PrevMovementMode == EMovementMode::MOVE_Falling and CurrentMovementMode == EMovementMode::MOVE_Walking)
+		case EParkourRecordOp::INPUT:
+			PlaybackInput = FVector(ParkourRecording::DequantizeInput(Op->InputX), ParkourRecording::DequantizeInput(Op->InputY), 0.0);
+			InvalidateProbeFrame();
+			break;
+		case EParkourRecordOp::VIEW:
+			//Player input is disabled during playback, so the controller holds the recorded view until the next op
+			if (AController* Controller = Character->GetController())
 			{
-				CheckQueues();
+				Controller->SetControlRotation(ParkourRecording::DecompressView(Op->View));
 			}
+			InvalidateProbeFrame();
+			break;
+		case EParkourRecordOp::DELTATIME:
+			PlaybackDeltaTime = Op->DeltaMicroseconds / 1000000.0f;
+			break;
+		case EParkourRecordOp::JUMP:
+			JumpEvent();
+			break;
+		case EParkourRecordOp::DASH:
+			DashEvent();
+			break;
+		case EParkourRecordOp::CROUCHSLIDE:
+			CrouchSlideEvent();
+			break;
+		case EParkourRecordOp::SPRINT:
+			SprintEvent();
+			break;
+		case EParkourRecordOp::LAND:
+			LandEvent();
+			break;
+		default:
+			break;
+		}
+		bDispatchingPlayback = false;
+		//An event can end play or stop playback from Blueprint
+		if (!Playback)
+		{
+			return;
 		}
 	}
+
+	if (Playback->IsFinished())
+	{
+		StopPlayback();
+		return;
+	}
+	Character->AddMovementInput(PlaybackInput, 1.0, true);
+	//Timers and interpolation step by the recorded time, version 1 recordings keep the live one
+	if (PlaybackDeltaTime > 0.0f)
+	{
+		UpdateDeltaTime = PlaybackDeltaTime;
+	}
 }
 
-void UParkourComponent::ParkourChanged(EParkourMode PrevParkour, EParkourMode CurrentParkour)
+void UParkourComponent::CheckPlaybackTransition(EParkourMode NewMode)
 {
-	PrevParkourMode = PrevParkour;
-	CurrentParkourMode = CurrentParkour;
-	ResetMovement();
+	const FParkourRecordedOp* Expected = Playback->NextTransition();
+	if (Expected and Expected->Mode == (uint8)NewMode)
+	{
+		return;
+	}
+	//Everything after the first divergence differs too, so only that one is worth logging
+	if (PlaybackMismatches++ == 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Parkour playback diverged at update %u: entered mode %d, recording entered mode %d at update %u"),
+			SessionUpdate, (int32)NewMode, Expected ? (int32)Expected->Mode : -1, Expected ? Expected->Update : 0);
+	}
 }
 
-bool UParkourComponent::SetParkourMode(EParkourMode NewMode)
+void UParkourComponent::ApplySlideMovement()
 {
-	if (CurrentParkourMode == NewMode)
+	CharacterMovement->BrakingDecelerationWalking = 1000.0;
+	CharacterMovement->MaxWalkSpeedCrouched = 0.0;
+	CharacterMovement->SetPlaneConstraintFromVectors(
+		CharacterMovement->Velocity.GetSafeNormal(), 
+		GetProbeFrame().Up);
+	CharacterMovement->SetPlaneConstraintEnabled(true);
+	FVector SlideVector = GetSlideVector();
+	if (SlideVector.Z <= 0.02)
 	{
-		return false;
+		CharacterMovement->AddImpulse(SlideVector * SlideImpulseAmount, true);
 	}
-	else
+}
+
+void UParkourComponent::CancelStaleTimers()
+{
+	//Entering a mode makes the reopen timer left by its previous end stale
+	if (IsWallRunning())
 	{
-		ParkourChanged(CurrentParkourMode, NewMode);
-		TimesJumped = 0;
-		return true;
+		Scheduler.Cancel(WallRunGateTimer);
+	}
+	else if (LedgeMantleOrVertical())
+	{
+		Scheduler.Cancel(VerticalWallRunGateTimer);
+	}
+	else if (CurrentParkourMode == EParkourMode::SPRINT)
+	{
+		Scheduler.Cancel(SprintGateTimer);
 	}
 }
 
 void UParkourComponent::ResetMovement()
 {
-	if (CurrentParkourMode == EParkourMode::NONE or CurrentParkourMode == EParkourMode::CROUCH)
+	if (FParkourSimRules::IsResetMode(ToSimMode(CurrentParkourMode)))
 	{
 		CharacterMovement->bOrientRotationToMovement = true;
 		Character->bUseControllerRotationYaw = bDefaultUseControllerRotationYaw;
@@ -833,43 +2176,24 @@ void UParkourComponent::ResetMovement()
 		CharacterMovement->MaxWalkSpeedCrouched = DefaultCrouchSpeed;
 		CharacterMovement->SetPlaneConstraintEnabled(false);
 
-		switch (PrevParkourMode)
-		{
-		case EParkourMode::NONE:
-			CharacterMovement->SetMovementMode(EMovementMode::MOVE_Walking);
-			break;
-		case EParkourMode::LEFTWALLRUN:
-			CharacterMovement->SetMovementMode(EMovementMode::MOVE_Falling);
-			break;
-		case EParkourMode::RIGHTWALLRUN:
-			CharacterMovement->SetMovementMode(EMovementMode::MOVE_Falling);
-			break;
-		case EParkourMode::VERTICALWALLRUN:
-			CharacterMovement->SetMovementMode(EMovementMode::MOVE_Falling);
-			break;
-		case EParkourMode::LEDGEGRAB:
-			CharacterMovement->SetMovementMode(EMovementMode::MOVE_Falling);
-			break;
-		case EParkourMode::MANTLE:
-			CharacterMovement->SetMovementMode(EMovementMode::MOVE_Walking);
-			break;
-		case EParkourMode::SLIDE:
-			CharacterMovement->SetMovementMode(EMovementMode::MOVE_Walking);
-			break;
-		case EParkourMode::SPRINT:
-			CharacterMovement->SetMovementMode(EMovementMode::MOVE_Walking);
-			break;
-		case EParkourMode::CROUCH:
-			CharacterMovement->SetMovementMode(EMovementMode::MOVE_Walking);
-			break;
-		default:
-			break;
-		}
+		bool bFalling = (FParkourSimRules::GetResetMovementMode(ToSimMode(PrevParkourMode)) == EParkourSimMovementMode::FALLING);
+		CharacterMovement->SetMovementMode(bFalling ? EMovementMode::MOVE_Falling : EMovementMode::MOVE_Walking);
 	}
 	else
 	{
-		CharacterMovement->bOrientRotationToMovement = (CurrentParkourMode == EParkourMode::SPRINT);
-		Character->bUseControllerRotationYaw = (CurrentParkourMode == EParkourMode::SPRINT and bDefaultUseControllerRotationYaw);
+		bool bOrientToMovement = FParkourSimRules::HasCategory(ToSimMode(CurrentParkourMode), MODECAT_ORIENTTOMOVEMENT);
+		CharacterMovement->bOrientRotationToMovement = bOrientToMovement;
+		Character->bUseControllerRotationYaw = (bOrientToMovement and bDefaultUseControllerRotationYaw);
+	}
+
+	const FParkourModeInfo& Info = FParkourSimRules::GetModeInfo(ToSimMode(CurrentParkourMode));
+	if (Info.GravityScale != FParkourModeInfo::NoOverride)
+	{
+		CharacterMovement->GravityScale = Info.GravityScale;
+	}
+	if (Info.GroundFriction != FParkourModeInfo::NoOverride)
+	{
+		CharacterMovement->GroundFriction = Info.GroundFriction;
 	}
 }
 
@@ -883,48 +2207,31 @@ void UParkourComponent::PlayCameraShake(TSubclassOf<UCameraShakeBase> Shake)
 
 void UParkourComponent::CameraTilt(float TargetRoll)
 {
-	FRotator ControlRot = Character->GetController()->GetControlRotation();
-	FRotator NewRot = FMath::RInterpTo(ControlRot, 
-		FRotator(ControlRot.Pitch, ControlRot.Yaw, TargetRoll), 
-		GetWorld()->GetDeltaSeconds(), 
-		10.0);
-	Character->GetController()->SetControlRotation(NewRot);
+	if (CameraModifier and TargetRoll == CameraTargetRoll)
+	{
+		return;
+	}
+	if (!CameraModifier)
+	{
+		APlayerController* PlayerController = Cast<APlayerController>(Character->GetController());
+		if (!PlayerController or !PlayerController->IsLocalController())
+		{
+			return;
+		}
+		CameraModifier = UParkourCameraModifier::FindOrAdd(PlayerController->PlayerCameraManager);
+		if (!CameraModifier)
+		{
+			return;
+		}
+	}
+	CameraTargetRoll = TargetRoll;
+	CameraModifier->SetTargetRoll(TargetRoll);
 }
 
 void UParkourComponent::CameraTick()
 {
-	switch (CurrentParkourMode)
-	{
-	case EParkourMode::NONE:
-		CameraTilt(0.0);
-		break;
-	case EParkourMode::LEFTWALLRUN:
-		CameraTilt(15.0);
-		break;
-	case EParkourMode::RIGHTWALLRUN:
-		CameraTilt(-15.0);
-		break;
-	case EParkourMode::VERTICALWALLRUN:
-		CameraTilt(0.0);
-		break;
-	case EParkourMode::LEDGEGRAB:
-		CameraTilt(0.0);
-		break;
-	case EParkourMode::MANTLE:
-		CameraTilt(0.0);
-		break;
-	case EParkourMode::SLIDE:
-		CameraTilt(-15.0);
-		break;
-	case EParkourMode::SPRINT:
-		CameraTilt(0.0);
-		break;
-	case EParkourMode::CROUCH:
-		CameraTilt(0.0);
-		break;
-	default:
-		break;
-	}
+	SCOPE_CYCLE_COUNTER(STAT_ParkourCameraTick);
+	CameraTilt(FParkourSimRules::GetCameraRoll(ToSimMode(CurrentParkourMode)));
 }
 
 void UParkourComponent::UpdateCameraProperties()
@@ -934,20 +2241,18 @@ void UParkourComponent::UpdateCameraProperties()
 
 FVector UParkourComponent::GetWallRunEndVector(float LineTraceRange)
 {
-	FVector CharLocation = Character->GetActorLocation();
-	FVector RightVec = Character->GetActorRightVector();
-	FVector FwdVector = Character->GetActorForwardVector();
+	const FParkourProbeFrame& Frame = GetProbeFrame();
 
-	FVector SideLineTrace = RightVec * LineTraceRange;
-	FVector FwdLineTrace = FwdVector * -35.0;
+	FVector SideLineTrace = Frame.Right * LineTraceRange;
+	FVector FwdLineTrace = Frame.Forward * -35.0;
 
-	FVector Endpoint = CharLocation + SideLineTrace + FwdLineTrace;
+	FVector Endpoint = Frame.Location + SideLineTrace + FwdLineTrace;
 	return Endpoint;
 }
 
 FVector UParkourComponent::GetWallRunTargetVector()
 {
-	FVector NormalTimesCapsuleRadius = Character->GetCapsuleComponent()->GetUnscaledCapsuleRadius() * WallRunNormal;
+	FVector NormalTimesCapsuleRadius = GetProbeFrame().CapsuleRadius * WallRunNormal;
 	return (NormalTimesCapsuleRadius + WallRunLocation);
 }
 
@@ -962,7 +2267,7 @@ FRotator UParkourComponent::GetWallRunTargetRotation()
 
 FVector UParkourComponent::GetVerticalWallRunTargetVector()
 {
-	FVector NormalTimesCapsuleRadius = Character->GetCapsuleComponent()->GetUnscaledCapsuleRadius() * VerticalWallRunNormal;
+	FVector NormalTimesCapsuleRadius = GetProbeFrame().CapsuleRadius * VerticalWallRunNormal;
 	return (NormalTimesCapsuleRadius + VerticalWallRunLocation);
 }
 
@@ -976,8 +2281,9 @@ FRotator UParkourComponent::GetVerticalWallRunTargetRotation()
 
 FVector UParkourComponent::GetLedgeTargetVector()
 {
-	float CapRadius = Character->GetCapsuleComponent()->GetUnscaledCapsuleRadius();
-	float CapHalfHeight = Character->GetCapsuleComponent()->GetUnscaledCapsuleHalfHeight();
+	const FParkourProbeFrame& Frame = GetProbeFrame();
+	float CapRadius = Frame.CapsuleRadius;
+	float CapHalfHeight = Frame.CapsuleHalfHeight;
 	FVector NormalTimesCapsuleRadius = LedgeClimbWallNormal * CapRadius;
 	FVector SumOfNormalAndPosition = NormalTimesCapsuleRadius + LedgeClimbWallPosition;
 	float LedgeZFromCapsule = LedgeFloorPosition.Z - CapHalfHeight;
@@ -997,73 +2303,124 @@ FVector UParkourComponent::GetDashLaunchVelocity()
 {
 	FVector CharVel = Character->GetVelocity();
 	FVector NewVel = FVector(CharVel.X, CharVel.Y, 0) * DashScale;
-	float range = CharacterMovement->IsFalling() ? DashRange : (DashRange * MaxRangeScale);
+	float range = IsAirborne() ? DashRange : (DashRange * MaxRangeScale);
 	FVector LaunchVel = NewVel.GetClampedToMaxSize2D(range);
 	return LaunchVel;
 }
 
 void UParkourComponent::GetMantleVectors(FVector& OutEyes, FVector& OutFeet)
 {
+	const FParkourProbeFrame& Frame = GetProbeFrame();
+	OutEyes = Frame.MantleEyes;
+	OutFeet = Frame.MantleFeet;
+}
+
+void UParkourComponent::BuildProbeFrame()
+{
+	ProbeFrame = FParkourProbeFrame();
+	ProbeFrame.FrameNumber = GFrameCounter;
+	ProbeFrame.bValid = true;
+
+	ProbeFrame.Location = Character->GetActorLocation();
+	ProbeFrame.Rotation = Character->GetActorQuat();
+	ProbeFrame.Forward = Character->GetActorForwardVector();
+	ProbeFrame.Right = Character->GetActorRightVector();
+	ProbeFrame.Up = Character->GetActorUpVector();
+	ProbeFrame.CapsuleRadius = Character->GetCapsuleComponent()->GetUnscaledCapsuleRadius();
+	ProbeFrame.CapsuleHalfHeight = Character->GetCapsuleComponent()->GetUnscaledCapsuleHalfHeight();
+	FVector InputVector = Playback ? PlaybackInput : CharacterMovement->GetLastInputVector();
+	ProbeFrame.ForwardInput = FVector::DotProduct(ProbeFrame.Forward, InputVector);
+
 	//Eyes
 	FVector EyesLocation;
 	FRotator EyesRotation;
-	Character->GetController()->GetActorEyesViewPoint(EyesLocation, EyesRotation);
+	if (AController* Controller = Character->GetController())
+	{
+		Controller->GetActorEyesViewPoint(EyesLocation, EyesRotation);
+	}
+	else
+	{
+		Character->GetActorEyesViewPoint(EyesLocation, EyesRotation);
+	}
 	EyesLocation.Z = EyesLocation.Z + 50.0;
-	FVector FwdVec = Character->GetActorForwardVector() * 50.0;
-	OutEyes = EyesLocation + FwdVec;
+	FVector FwdVec = ProbeFrame.Forward * 50.0;
+	ProbeFrame.MantleEyes = EyesLocation + FwdVec;
 
 	//Feet
-	float CapHalfHeight = Character->GetCapsuleComponent()->GetUnscaledCapsuleHalfHeight();
-	FVector FeetLocation = Character->GetActorLocation() - FVector(0, 0, (CapHalfHeight - MantleHeight));
-	OutFeet = FeetLocation + FwdVec;
+	FVector FeetLocation = ProbeFrame.Location - FVector(0, 0, (ProbeFrame.CapsuleHalfHeight - MantleHeight));
+	ProbeFrame.MantleFeet = FeetLocation + FwdVec;
+}
+
+const FParkourProbeFrame& UParkourComponent::GetProbeFrame()
+{
+	//Rebuilt on first use after the character moves or the frame ends, events fired after CharacterMovement
+	//has run this frame read where the character is now
+	if (!ProbeFrame.bValid or ProbeFrame.FrameNumber != GFrameCounter)
+	{
+		BuildProbeFrame();
+	}
+	return ProbeFrame;
+}
+
+void UParkourComponent::InvalidateProbeFrame()
+{
+	ProbeFrame.bValid = false;
+}
+
+void UParkourComponent::OnCharacterTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	InvalidateProbeFrame();
 }
 
 
 float UParkourComponent::InterpolateGravity()
 {
-	return FMath::FInterpTo(CharacterMovement->GravityScale, WallRunTargetGravity, GetWorld()->GetDeltaSeconds(), 20.0);
+	//The predicted movement component interpolates wall-run gravity inside each move
+	if (ParkourMovement and ParkourMovement->bInterpolateWallRunGravity)
+	{
+		return CharacterMovement->GravityScale;
+	}
+	return FMath::FInterpTo(CharacterMovement->GravityScale, WallRunTargetGravity, UpdateDeltaTime, 20.0);
 }
 
 bool UParkourComponent::IsWallRunning()
 {
-	return (CurrentParkourMode == EParkourMode::LEFTWALLRUN or CurrentParkourMode == EParkourMode::RIGHTWALLRUN);
+	return FParkourSimRules::IsWallRunning(ToSimMode(CurrentParkourMode));
 }
 
 float UParkourComponent::ForwardInput()
 {
-	return FVector::DotProduct(Character->GetActorForwardVector(), CharacterMovement->GetLastInputVector());
+	return GetProbeFrame().ForwardInput;
 }
 
 bool UParkourComponent::CanWallRun()
 {
-	return ((CurrentParkourMode == EParkourMode::NONE or IsWallRunning()) and ForwardInput() > 0.0);
+	return FParkourSimRules::CanWallRun(ToSimMode(CurrentParkourMode), ForwardInput());
 }
 
 bool UParkourComponent::CanMantle()
 {
-	return ((ForwardInput() > 0.0) and (CurrentParkourMode == EParkourMode::LEDGEGRAB or CanQuickMantle()));
+	return FParkourSimRules::CanMantle(ToSimMode(CurrentParkourMode), ForwardInput(), CanQuickMantle());
 }
 
 bool UParkourComponent::CanQuickMantle()
 {
-	return ((MantleTraceDistance > MantleHeight) or bLedgeCloseToGround);
+	return FParkourSimRules::CanQuickMantle(MantleTraceDistance, MantleHeight, bLedgeCloseToGround);
 }
 
 bool UParkourComponent::CanVerticalWallRun()
 {
-	bool bViableParkourModes = (CurrentParkourMode == EParkourMode::NONE or CurrentParkourMode == EParkourMode::VERTICALWALLRUN
-		or IsWallRunning());
-	return ((ForwardInput() > 0.0) and CharacterMovement->IsFalling() and bViableParkourModes);
+	return FParkourSimRules::CanVerticalWallRun(ToSimMode(CurrentParkourMode), ForwardInput(), IsAirborne());
 }
 
 bool UParkourComponent::CanSprint()
 {
-	return (CharacterMovement->IsWalking() and CurrentParkourMode == EParkourMode::NONE);
+	return FParkourSimRules::CanSprint(ToSimMode(CurrentParkourMode), CharacterMovement->IsWalking());
 }
 
 bool UParkourComponent::CanSlide()
 {
-	return ((ForwardInput() > 0.0) and (CurrentParkourMode == EParkourMode::SPRINT or bSprintQueued));
+	return FParkourSimRules::CanSlide(ToSimMode(CurrentParkourMode), ForwardInput(), IsInputBuffered(EParkourBufferedAction::SPRINT));
 }
 
 void UParkourComponent::GrabLedge()
@@ -1071,34 +2428,37 @@ void UParkourComponent::GrabLedge()
 	bool change = SetParkourMode(EParkourMode::LEDGEGRAB);
 	if (change)
 	{
-		CharacterMovement->DisableMovement();
+		//The LEDGEHANG custom mode holds the character, without it movement is switched off
+		if (!UsesParkourPhysics())
+		{
+			CharacterMovement->DisableMovement();
+		}
 		CharacterMovement->StopMovementImmediately();
-		CharacterMovement->GravityScale = 0.0;
 		PlayCameraShake(LedgeGrab);
 	}
 }
 
 bool UParkourComponent::LedgeMantleOrVertical()
 {
-	return (CurrentParkourMode == EParkourMode::LEDGEGRAB or CurrentParkourMode == EParkourMode::VERTICALWALLRUN or CurrentParkourMode == EParkourMode::MANTLE);
+	return FParkourSimRules::IsLedgeMantleOrVertical(ToSimMode(CurrentParkourMode));
 }
 
 bool UParkourComponent::CanJump()
 {
-	return (TimesJumped < MaxJumps);
+	return FParkourSimRules::CanJump(TimesJumped, MaxJumps);
 }
 
 FVector UParkourComponent::GetSlideVector()
 {
-	FVector EndVec = Character->GetActorLocation() + (Character->GetActorUpVector() * -200.0);
+	const FParkourProbeFrame& Frame = GetProbeFrame();
+	FVector EndVec = Frame.Location + (Frame.Up * -200.0);
 	FHitResult OutHit;
-	GetWorld()->LineTraceSingleByChannel(
+	ParkourLineTrace(EParkourProbe::SLIDE,
 		OutHit,
-		Character->GetActorLocation(),
-		EndVec,
-		ECC_Visibility
+		Frame.Location,
+		EndVec
 	);
-	FVector CrossProduct = FVector::CrossProduct(OutHit.ImpactNormal, Character->GetActorRightVector());
+	FVector CrossProduct = FVector::CrossProduct(OutHit.ImpactNormal, Frame.Right);
 	return (CrossProduct* -1.0);
 }
 
@@ -1106,8 +2466,263 @@ FVector UParkourComponent::GetSlideVector()
 // Called every frame
 void UParkourComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
+	SCOPE_CYCLE_COUNTER(STAT_ParkourTick);
+	LLM_SCOPE_BYTAG(Parkour);
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
 
-	// ...
+	//Unmanaged characters run the manager's phases back to back. Only the fused probe is run ahead,
+	//the other probes are issued by DispatchUpdate as it needs them.
+	if (Character)
+	{
+		BeginUpdate(DeltaTime);
+		if (bUpdateDispatches)
+		{
+			const uint32 StartCycles = FPlatformTime::Cycles();
+			BuildProbeFrame();
+			if (bUseFusedProbe)
+			{
+				PlanProbes();
+				RunFusedProbe();
+			}
+			UpdateCycles += FPlatformTime::Cycles() - StartCycles;
+		}
+		FinishUpdate(DeltaTime);
+	}
+}
+
+void UParkourComponent::BeginUpdate(float DeltaTime)
+{
+	const uint32 StartCycles = FPlatformTime::Cycles();
+	UpdateCycles = 0;
+	UpdateQueries = 0;
+	UpdateDeltaTime = DeltaTime;
+	UpdateLODBucket(DeltaTime);
+	bUpdateDispatches = (!IsDrivenRemotely() and UpdateLOD != EParkourLOD::STATEONLY);
+	//Playback runs before the gate timers advance so they step by the recorded delta time. Live events arrive
+	//between updates, so the recorded ones land ahead of the timers as well.
+	if (bUpdateDispatches)
+	{
+		if (Playback)
+		{
+			AdvancePlayback();
+		}
+		else if (Recorder)
+		{
+			RecordInput();
+			Recorder->WriteView(SessionUpdate, Character->GetControlRotation());
+			Recorder->WriteDeltaTime(SessionUpdate, DeltaTime);
+		}
+	}
+	Scheduler.Advance(*this, UpdateDeltaTime);
+	if (bUpdateDispatches)
+	{
+		StepCorrection();
+	}
+	UpdateCycles += FPlatformTime::Cycles() - StartCycles;
+}
+
+void UParkourComponent::PlanProbes()
+{
+	//Mirrors the sync probes DispatchUpdate asks for with the gates and mode as they stand. A planned probe the update
+	//no longer needs is wasted, one it asks for with a different segment just runs as a normal query.
+	const FParkourProbeFrame& Frame = GetProbeFrame();
+	auto Plan = [this](EParkourProbe Probe, const FVector& Start, const FVector& End)
+	{
+		if (GetProbeQueryMode(Probe) == EParkourQueryMode::SYNC)
+		{
+			FParkourProbeFrame::FPrefetchedProbe& Prefetched = ProbeFrame.Prefetched[(uint8)Probe];
+			Prefetched.Start = Start;
+			Prefetched.End = End;
+			Prefetched.bPlanned = true;
+		}
+	};
+
+	if ((Gates & (uint8)EParkourGate::WALLRUN) and CanWallRun())
+	{
+		Plan(EParkourProbe::WALLRUNRIGHT, Frame.Location, GetWallRunEndVector(75.0));
+		if (CurrentParkourMode != EParkourMode::RIGHTWALLRUN)
+		{
+			Plan(EParkourProbe::WALLRUNLEFT, Frame.Location, GetWallRunEndVector(-75.0));
+		}
+	}
+	if ((Gates & (uint8)EParkourGate::VERTICALWALLRUN) and CanVerticalWallRun())
+	{
+		Plan(EParkourProbe::LEDGE, Frame.MantleEyes, Frame.MantleFeet);
+		Plan(EParkourProbe::FORWARD, Frame.MantleFeet, Frame.MantleFeet + (Frame.Forward * 50.0));
+		float CapZOffset = Frame.CapsuleHalfHeight + 40.0;
+		Plan(EParkourProbe::LEDGEGROUND, Frame.Location, Frame.Location - (Frame.Up * CapZOffset));
+	}
+}
+
+void UParkourComponent::RunPlannedProbes()
+{
+	if (bUseFusedProbe)
+	{
+		RunFusedProbe();
+	}
+	for (uint8 Index = 0; Index < (uint8)EParkourProbe::MAX; Index++)
+	{
+		FParkourProbeFrame::FPrefetchedProbe& Prefetched = ProbeFrame.Prefetched[Index];
+		if (!Prefetched.bPlanned)
+		{
+			continue;
+		}
+		Prefetched.bPlanned = false;
+		const EParkourProbe Probe = (EParkourProbe)Index;
+		if (Probe == EParkourProbe::FORWARD)
+		{
+			//Straight into the ForwardTracer memo, which the update reads instead of querying
+			FHitResult ForwardHit;
+			bool bForwardValidHit;
+			ForwardTracer(ForwardHit, bForwardValidHit);
+			continue;
+		}
+		FHitResult Hit;
+		Prefetched.bHit = (Probe == EParkourProbe::LEDGE)
+			? ParkourSweep(Probe, Hit, Prefetched.Start, Prefetched.End, FCollisionShape::MakeCapsule(20.0, 10.0), GetLedgeQueryParams())
+			: ParkourLineTrace(Probe, Hit, Prefetched.Start, Prefetched.End);
+		Prefetched.Hit = Hit;
+		Prefetched.bDone = true;
+	}
+}
+
+void UParkourComponent::RunFusedProbe()
+{
+	GetProbeFrame();
+	bool bWanted = false;
+	for (EParkourProbe Probe : ParkourFusedProbe::Probes)
+	{
+		bWanted |= ProbeFrame.Prefetched[(uint8)Probe].bPlanned;
+	}
+	if (ProbeFrame.bFusedProbed or !bWanted)
+	{
+		return;
+	}
+	ProbeFrame.bFusedProbed = true;
+
+	//The segments the individual probes use, so ConsumePrefetchedProbe matches them exactly
+	float CapZOffset = ProbeFrame.CapsuleHalfHeight + 40.0;
+	struct FSegment
+	{
+		EParkourProbe Probe;
+		FVector Start;
+		FVector End;
+	};
+	const FSegment Segments[] =
+	{
+		{ EParkourProbe::WALLRUNRIGHT, ProbeFrame.Location, GetWallRunEndVector(75.0) },
+		{ EParkourProbe::WALLRUNLEFT, ProbeFrame.Location, GetWallRunEndVector(-75.0) },
+		{ EParkourProbe::FORWARD, ProbeFrame.MantleFeet, ProbeFrame.MantleFeet + (ProbeFrame.Forward * 50.0) },
+		{ EParkourProbe::LEDGEGROUND, ProbeFrame.Location, ProbeFrame.Location - (ProbeFrame.Up * CapZOffset) },
+		{ EParkourProbe::SLIDE, ProbeFrame.Location, ProbeFrame.Location + (ProbeFrame.Up * -200.0) }
+	};
+	static_assert(UE_ARRAY_COUNT(Segments) == UE_ARRAY_COUNT(ParkourFusedProbe::Probes), "Every fused probe needs a segment");
+	//Out of FULL LOD the forward sweep is a line, as in ParkourSweep
+	const FCollisionShape ForwardShape = (UpdateLOD == EParkourLOD::FULL) ? FCollisionShape::MakeCapsule(10.0, 5.0) : FCollisionShape();
+
+	FBox Bounds(ForceInit);
+	for (const FSegment& Segment : Segments)
+	{
+		Bounds += Segment.Start;
+		Bounds += Segment.End;
+	}
+	Bounds = Bounds.ExpandBy(ForwardShape.GetExtent().GetMax() + 1.0);
+
+	UpdateQueries++;
+	INC_DWORD_STAT(STAT_ParkourQueriesFused);
+	TArray<FOverlapResult> Overlaps;
+	GetWorld()->OverlapMultiByChannel(Overlaps, Bounds.GetCenter(), FQuat::Identity, ECC_Visibility,
+		FCollisionShape::MakeBox(Bounds.GetExtent()), FCollisionQueryParams::DefaultQueryParam);
+	TArray<UPrimitiveComponent*, TInlineAllocator<16>> Candidates;
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		//Traces by channel only stop on blocking responses, the overlap also reports touching ones
+		UPrimitiveComponent* Primitive = Overlap.GetComponent();
+		if (Primitive and Primitive->GetCollisionResponseToChannel(ECC_Visibility) == ECR_Block)
+		{
+			Candidates.AddUnique(Primitive);
+		}
+	}
+
+	for (const FSegment& Segment : Segments)
+	{
+		FParkourProbeFrame::FPrefetchedProbe& Prefetched = ProbeFrame.Prefetched[(uint8)Segment.Probe];
+		Prefetched.bPlanned = false;
+		if (GetProbeQueryMode(Segment.Probe) != EParkourQueryMode::SYNC)
+		{
+			continue;
+		}
+
+		FHitResult Hit;
+		bool bHit = false;
+		bool bDynamicOnly = false;
+		if (WallIndex and (Segment.Probe == EParkourProbe::WALLRUNRIGHT or Segment.Probe == EParkourProbe::WALLRUNLEFT))
+		{
+			INC_DWORD_STAT(STAT_ParkourBakedLookups);
+			bHit = WallIndex->LineTrace(Segment.Start, Segment.End, Hit);
+			bDynamicOnly = WallIndex->CoversStaticGeometry();
+		}
+		if (!bHit)
+		{
+			const FCollisionShape& Shape = (Segment.Probe == EParkourProbe::FORWARD) ? ForwardShape : FCollisionShape();
+			bHit = ParkourFusedProbe::TraceCandidates(Candidates, Segment.Start, Segment.End, ProbeFrame.Rotation, Shape, bDynamicOnly, Hit);
+		}
+
+		if (Segment.Probe == EParkourProbe::FORWARD)
+		{
+			SetForwardHit(Hit);
+			continue;
+		}
+		Prefetched.Start = Segment.Start;
+		Prefetched.End = Segment.End;
+		Prefetched.Hit = Hit;
+		Prefetched.bHit = bHit;
+		Prefetched.bDone = true;
+	}
 }
 
+void UParkourComponent::FinishUpdate(float DeltaTime)
+{
+	const uint32 StartCycles = FPlatformTime::Cycles();
+	if (bUpdateDispatches)
+	{
+		//Dash comes back through Blueprint, there is no event to consume a buffered one from
+		CheckBufferedDash();
+		DispatchUpdate();
+		SyncPredictedState();
+		SessionUpdate++;
+	}
+	else if (UpdateLOD == EParkourLOD::STATEONLY and !IsDrivenRemotely())
+	{
+		StateOnlyUpdate();
+		SyncPredictedState();
+	}
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		UpdateReplicatedState();
+#if PARKOUR_NETSTATS_ENABLED
+		FParkourNetStats::AddCharacterSeconds(CurrentParkourMode, DeltaTime);
+#endif
+	}
+	UpdateCycles += FPlatformTime::Cycles() - StartCycles;
+
+	if (FlightRecorder)
+	{
+		FParkourFlightSample Sample;
+		Sample.Frame = (uint32)GFrameCounter;
+		Sample.Cycles = UpdateCycles;
+		Sample.Velocity = FVector3f(CharacterMovement->Velocity);
+		Sample.GravityScale = CharacterMovement->GravityScale;
+		Sample.Queries = UpdateQueries;
+		Sample.Mode = (uint8)CurrentParkourMode;
+		Sample.PrevMode = (uint8)PrevParkourMode;
+		Sample.Gates = (uint8)Gates;
+		FlightRecorder->Record(Sample);
+	}
+
+	if (CanSleep())
+	{
+		SleepUpdate();
+	}
+}
@@ -4,7 +4,11 @@
 
 class ACharacter;
 class UCharacterMovementComponent;
+class UParkourMovementComponent;
 class UCameraShakeBase;
+class UParkourCameraModifier;
+class UParkourWallIndex;
+class FParkourLedgeDatabase;
 
 UENUM(BlueprintType)
 enum class EParkourMode : uint8
@@ -20,27 +24,123 @@ enum class EParkourMode : uint8
 	CROUCH UMETA(DisplayName = "Crouch")
 };
 
+UENUM(BlueprintType)
+enum class EParkourProbe : uint8
+{
+	WALLRUNRIGHT	UMETA(DisplayName = "WallRunRight"),
+	WALLRUNLEFT		UMETA(DisplayName = "WallRunLeft"),
+	LEDGE	UMETA(DisplayName = "Ledge"),
+	FORWARD	UMETA(DisplayName = "Forward"),
+	LEDGEGROUND	UMETA(DisplayName = "LedgeGround"),
+	SLIDE	UMETA(DisplayName = "Slide"),
+	MAX	UMETA(Hidden)
+};
+
+UENUM(BlueprintType)
+enum class EParkourQueryMode : uint8
+{
+	SYNC	UMETA(DisplayName = "Sync"),
+	ASYNC	UMETA(DisplayName = "Async (One Frame Latent)")
+};
+
+//Update functions enabled for the parkour dispatcher, values mirror FParkourSim::EGate
+UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class EParkourGate : uint8
+{
+	NONE = 0	UMETA(Hidden),
+	WALLRUN = 1 << 0	UMETA(DisplayName = "WallRun"),
+	VERTICALWALLRUN = 1 << 1	UMETA(DisplayName = "VerticalWallRun"),
+	CHECKMANTLE = 1 << 2	UMETA(DisplayName = "CheckMantle"),
+	MANTLE = 1 << 3	UMETA(DisplayName = "Mantle"),
+	SLIDE = 1 << 4	UMETA(DisplayName = "Slide"),
+	SPRINT = 1 << 5	UMETA(DisplayName = "Sprint")
+};
+ENUM_CLASS_FLAGS(EParkourGate);
+
+//How much parkour work a character gets, picked by distance to the nearest player and whether it is on screen
+UENUM(BlueprintType)
+enum class EParkourLOD : uint8
+{
+	//Every update at UpdateRate, capsule sweeps
+	FULL	UMETA(DisplayName = "Full"),
+	//ReducedLODUpdateRate, sweeps replaced by line traces
+	REDUCED	UMETA(DisplayName = "Reduced"),
+	//No probes or new transitions. Slide and mantle still run their end checks, wall runs and ledges are dropped.
+	STATEONLY	UMETA(DisplayName = "State Only"),
+	MAX	UMETA(Hidden)
+};
+
 #include "CoreMinimal.h"
 #include "Net/UnrealNetwork.h"
 #include "Engine/Engine.h"
 #include "Components/ActorComponent.h"
+#include "ParkourCorrection.h"
+#include "ParkourFlightRecorder.h"
+#include "ParkourInputBuffer.h"
+#include "ParkourRecording.h"
+#include "ParkourReplication.h"
+#include "ParkourScheduler.h"
 #include "ParkourComponent.generated.h"
 
+struct FParkourSimConfig;
+
+//Character state gathered once per update and shared by every probe and getter
+struct FParkourProbeFrame
+{
+	uint64 FrameNumber = 0;
+	bool bValid = false;
+
+	FVector Location = FVector::ZeroVector;
+	FQuat Rotation = FQuat::Identity;
+	FVector Forward = FVector::ForwardVector;
+	FVector Right = FVector::RightVector;
+	FVector Up = FVector::UpVector;
+	float CapsuleRadius = 0.0;
+	float CapsuleHalfHeight = 0.0;
+	float ForwardInput = 0.0;
+
+	FVector MantleEyes = FVector::ZeroVector;
+	FVector MantleFeet = FVector::ZeroVector;
+
+	//Memoized ForwardTracer sweep
+	bool bForwardTraced = false;
+	bool bForwardValidHit = false;
+	FHitResult ForwardHit;
+
+	//Sync probes answered ahead of DispatchUpdate by UParkourUpdateManager, used once when the update asks for the same segment
+	struct FPrefetchedProbe
+	{
+		FVector Start = FVector::ZeroVector;
+		FVector End = FVector::ZeroVector;
+		bool bPlanned = false;
+		bool bDone = false;
+		bool bHit = false;
+		FHitResult Hit;
+	};
+	FPrefetchedProbe Prefetched[(uint8)EParkourProbe::MAX];
+	//Set once the fused side, forward and down probe has filled its slots for this frame
+	bool bFusedProbed = false;
+};
+
 
 UCLASS( Blueprintable, ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class ECHORUNNER_API UParkourComponent : public UActorComponent
 {
 	GENERATED_BODY()
+	friend class UParkourUpdateManager;
+	friend class FParkourComponentTestAccess;
 
 public:	
 	// Sets default values for this component's properties
 	UParkourComponent();
 	// Called every frame
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 protected:
 	// Called when the game starts
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	
 	UFUNCTION(BlueprintCallable)
 	void JumpEvent();
@@ -49,37 +149,61 @@ protected:
 	UFUNCTION(BlueprintCallable)
 	void DashEvent();
 
-	UFUNCTION(BlueprintCallable, BlueprintImplementableEvent)
+	//No longer invoked, DispatchUpdate runs the gated updates natively. Kept so Blueprints written against the
+	//old UpdateEvent graph still load, their gate graph simply never runs.
+	UFUNCTION(BlueprintImplementableEvent, meta = (DeprecatedFunction, DeprecationMessage = "The gated updates run natively in DispatchUpdate, remove this graph."))
 	void UpdateEvent();
+	//Optional notification, only invoked when the Blueprint implements it
+	UFUNCTION(BlueprintImplementableEvent)
+	void GatesChangedEvent(int32 PrevGates, int32 NewGates);
 	UFUNCTION(BlueprintCallable, BlueprintImplementableEvent)
+	void VerticalWallRunEndEvent();
+
+	//GateFunctions
+	//Native events only so Blueprints that overrode the old gate events still compile. The component itself calls
+	//the _Implementation, an override never runs in its place and cannot leave the Gates bitmask stale.
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent)
 	void OpenWallRunGate();
-	UFUNCTION(BlueprintCallable, BlueprintImplementableEvent)
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent)
 	void CloseWallRunGate();
-	UFUNCTION(BlueprintCallable, BlueprintImplementableEvent)
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent)
 	void OpenVerticalWallRunGate();
-	UFUNCTION(BlueprintCallable, BlueprintImplementableEvent)
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent)
 	void CloseVerticalWallRunGate();
-	UFUNCTION(BlueprintCallable, BlueprintImplementableEvent)
-	void VerticalWallRunEndEvent();
-	UFUNCTION(BlueprintCallable, BlueprintImplementableEvent)
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent)
 	void OpenMantleGate();
-	UFUNCTION(BlueprintCallable, BlueprintImplementableEvent)
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent)
 	void CloseMantleGate();
-	UFUNCTION(BlueprintCallable, BlueprintImplementableEvent)
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent)
 	void OpenCheckMantleGate();
-	UFUNCTION(BlueprintCallable, BlueprintImplementableEvent)
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent)
 	void CloseCheckMantleGate();
-	UFUNCTION(BlueprintCallable, BlueprintImplementableEvent)
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent)
 	void OpenSlideGate();
-	UFUNCTION(BlueprintCallable, BlueprintImplementableEvent)
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent)
 	void CloseSlideGate();
-	UFUNCTION(BlueprintCallable, BlueprintImplementableEvent)
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent)
 	void OpenSprintGate();
-	UFUNCTION(BlueprintCallable, BlueprintImplementableEvent)
+	UFUNCTION(BlueprintCallable, BlueprintNativeEvent)
 	void CloseSprintGate();
+	UFUNCTION(BlueprintPure)
+	bool IsGateOpen(EParkourGate Gate) const;
+	void SetGates(int32 NewGates);
+	void DispatchUpdate();
+	//DispatchUpdate's replacement at STATEONLY
+	void StateOnlyUpdate();
 
 	UFUNCTION(BlueprintCallable)
 	void Initialise(ACharacter* Char);
+	//Resumes the periodic update after a sleep, every event, movement mode change and input start calls this
+	UFUNCTION(BlueprintCallable)
+	void WakeUpdate();
+	UFUNCTION(BlueprintPure)
+	bool IsUpdateAsleep() const { return bUpdateAsleep; }
+	//Seconds between parkour updates for the current UpdateRate and LOD, 0 updates every frame
+	float GetUpdateInterval() const { return UpdateInterval; }
+	//These tunables for an FParkourSim, Mass runners read them from the class default
+	FParkourSimConfig GetSimConfig() const;
 	
 	//WallRunFunctions
 	UFUNCTION(BlueprintCallable)
@@ -94,10 +218,13 @@ protected:
 	void ApplyGravityAndCorrectLocation();
 	UFUNCTION(BlueprintCallable)
 	void WallRunJump();
+	void LaunchWallJump();
 	UFUNCTION(BlueprintCallable)
 	void WallRunEnd(float ResetTime);
 
 	//VerticalWallRunFunctions
+	bool FindBakedLedge(bool& bOutLedgeCloseToGround);
+	void EnterLedgeGrab();
 	UFUNCTION(BlueprintCallable)
 	void VerticalWallRunMovement();
 	UFUNCTION(BlueprintCallable)
@@ -108,9 +235,26 @@ protected:
 	void CorrectVerticalWallRunLocation();
 	UFUNCTION(BlueprintCallable)
 	void CorrectLedgeLocation();
+	//Distance the running wall or ledge correction still has to cover, zero when none is running
+	UFUNCTION(BlueprintPure)
+	float GetCorrectionError() const;
 	UFUNCTION(BlueprintCallable)
 	void ForwardTracer(FHitResult& OutHit, bool& ValidHit);
 
+	//SceneQueryFunctions
+	bool ParkourLineTrace(EParkourProbe Probe, FHitResult& OutHit, const FVector& Start, const FVector& End);
+	bool ParkourSweep(EParkourProbe Probe, FHitResult& OutHit, const FVector& Start, const FVector& End, const FCollisionShape& Shape,
+		const FCollisionQueryParams& QueryParams = FCollisionQueryParams::DefaultQueryParam);
+	EParkourQueryMode GetProbeQueryMode(EParkourProbe Probe) const;
+	void CountProbeQuery(EParkourProbe Probe);
+
+	//ProbeFrameFunctions
+	void BuildProbeFrame();
+	const FParkourProbeFrame& GetProbeFrame();
+	void InvalidateProbeFrame();
+	//Bound to the character's root, a move by CharacterMovement or a teleport later in the frame stales the frame
+	void OnCharacterTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
 	//MantleFunctions
 	UFUNCTION(BlueprintCallable)
 	void MantleCheck();
@@ -157,6 +301,9 @@ protected:
 
 	UFUNCTION(BlueprintCallable)
 	void JumpMovement();
+	//Jump the way JumpEvent does, bFromGround treats an airborne character as still on the ground
+	void PerformJump(bool bFromGround);
+	void PerformDash();
 
 	//ManipulateGatesAndQueues
 	UFUNCTION(BlueprintCallable)
@@ -179,12 +326,54 @@ protected:
 	bool SetParkourMode(EParkourMode NewMode);
 	UFUNCTION(BlueprintCallable)
 	void ResetMovement();
+	void CancelStaleTimers();
+
+	//PredictionFunctions
+	void ParkourLaunch(FVector LaunchVelocity, bool bXYOverride, bool bZOverride);
+	void SyncPredictedState();
+	void ServerParkourStateReceived(uint8 InParkourMode, uint8 InTimesJumped);
+	//The wall InParkourMode runs or hangs on from where the character stands, with the segments of the probes that enter it.
+	//Finds the wall for the custom wall physics and checks a remote client's transitions on the server.
+	bool ProbeParkourWall(uint8 InParkourMode, FVector& OutWallNormal);
+	void ParkourWallLost();
+	//MantlePosition from the server's ledge sweep, or ClientTarget when it lies within the sweep's reach
+	bool ProbeMantleTarget(const FVector& ClientTarget, FVector& OutTarget);
+	bool IsDrivenRemotely() const;
+	void ApplySlideMovement();
+	//True when UParkourMovementComponent integrates the wall, ledge and mantle modes itself
+	bool UsesParkourPhysics() const;
+	//Starts the fixed-duration mantle root motion toward MantlePosition
+	void StartMantleMotion(float InterpSpeed);
+	bool IsMantleMoving() const;
+	//Falling, or in one of the parkour custom movement modes
+	bool IsAirborne() const;
+
+	//ReplicationFunctions
+	UFUNCTION()
+	void OnRep_ReplicatedState();
+
+	//RecordingFunctions
+	UFUNCTION(BlueprintCallable)
+	bool StartRecording();
+	UFUNCTION(BlueprintCallable)
+	void StopRecording();
+	UFUNCTION(BlueprintCallable)
+	bool StartPlayback(const FString& Path);
+	UFUNCTION(BlueprintCallable)
+	void StopPlayback();
+	bool AcceptEvent(EParkourRecordOp Op);
+	void RecordInput();
+	void AdvancePlayback();
+	void CheckPlaybackTransition(EParkourMode NewMode);
 
 	//CameraFunctions
 	UFUNCTION(BlueprintCallable)
 	void PlayCameraShake(TSubclassOf<UCameraShakeBase> Shake);
+	//Hands the roll to the view-only UParkourCameraModifier, the control rotation is left alone
 	UFUNCTION(BlueprintCallable)
 	void CameraTilt(float TargetRoll);
+	//Sets the current mode's roll, called on every mode change. Calls that would not change the roll do nothing,
+	//so Blueprints still calling it per tick cost no more than the check.
 	UFUNCTION(BlueprintCallable)
 	void CameraTick();
 	UFUNCTION(BlueprintCallable)
@@ -230,6 +419,9 @@ protected:
 	ACharacter* Character;
 	UPROPERTY(BlueprintReadOnly, Category = "Character Properties")
 	UCharacterMovementComponent* CharacterMovement;
+	//Set when the character uses the predicted movement component, null otherwise
+	UPROPERTY(BlueprintReadOnly, Category = "Character Properties")
+	UParkourMovementComponent* ParkourMovement;
 	UPROPERTY(BlueprintReadOnly, Category = "Character Properties")
 	float DefaultGravity;
 	UPROPERTY(BlueprintReadOnly, Category = "Character Properties")
@@ -274,6 +466,78 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Dash")
 	float MaxRangeScale = 100.0;
 
+	//Parkour updates per second, 0 updates every frame
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Update")
+	float UpdateRate;
+	UPROPERTY(BlueprintReadOnly, Category = "Update")
+	float UpdateDeltaTime;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Scene Queries")
+	EParkourQueryMode WallRunQueryMode;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Scene Queries")
+	EParkourQueryMode LedgeQueryMode;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Scene Queries")
+	EParkourQueryMode ForwardQueryMode;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Scene Queries")
+	EParkourQueryMode GroundQueryMode;
+	//Answer wall-run probes against static geometry from the level's baked UParkourWallIndex when one exists
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Scene Queries")
+	bool bUseWallIndex;
+	UPROPERTY(Transient)
+	UParkourWallIndex* WallIndex;
+	//Found on the local player's camera manager the first time a mode change needs it
+	UPROPERTY(Transient)
+	UParkourCameraModifier* CameraModifier;
+	//Last roll handed to CameraModifier, repeated calls with the same roll leave the modifier asleep
+	float CameraTargetRoll = 0.0f;
+
+	//Scale parkour work for characters far from every player, locally controlled characters and, on the server, every
+	//player-controlled one always run FULL
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Update LOD")
+	bool bUseUpdateLOD;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Update LOD")
+	float ReducedLODDistance;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Update LOD")
+	float StateOnlyLODDistance;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Update LOD")
+	float ReducedLODUpdateRate;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Update LOD")
+	float StateOnlyLODUpdateRate;
+	//Fraction of a bucket distance a character must cross past it before changing bucket, stops flapping at the edge
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Update LOD")
+	float LODHysteresis;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Update LOD")
+	EParkourLOD UpdateLOD;
+	//Stop ticking while standing idle in NONE, needs UParkourMovementComponent to report input starting
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Update")
+	bool bAllowUpdateSleep;
+	//Update with every other parkour character through UParkourUpdateManager instead of a tick of its own
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Update")
+	bool bUseUpdateManager;
+	//Answer ledge probes against static geometry from the level's baked FParkourLedgeDatabase when one exists
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Scene Queries")
+	bool bUseLedgeDatabase;
+	//Answer the sync wall-run, forward and slide probes from one broadphase overlap around the character
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Scene Queries")
+	bool bUseFusedProbe;
+
+	//Seconds a pressed action waits for a transition that can use it, 0 keeps it until used or cleared
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Input Buffer")
+	float JumpBufferTime;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Input Buffer")
+	float SlideBufferTime;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Input Buffer")
+	float SprintBufferTime;
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Input Buffer")
+	float DashBufferTime;
+	//Seconds after walking off a ledge or dropping off a wall run during which a jump still counts as made from there
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Input Buffer")
+	float CoyoteTime;
+
+	//Record this character's input, events and transitions from Initialise, parkour.RecordSessions does the same for every character
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Recording")
+	bool bRecordSession;
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Jump")
 	int32 TimesJumped;
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Jump")
@@ -288,7 +552,104 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Parkour and Movement")
 	EParkourMode CurrentParkourMode;
 
+	//Open EParkourGate bits, each one enables an update function in DispatchUpdate
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Parkour and Movement", meta = (Bitmask, BitmaskEnum = "/Script/EchoRunner.EParkourGate"))
+	int32 Gates;
+
+	//Quantized state for simulated proxies, the owner predicts its own
+	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedState)
+	FParkourReplicatedState ReplicatedState;
+
 private:
+	//Async probe submitted on one frame and consumed on the next
+	struct FParkourAsyncProbe
+	{
+		FTraceHandle Handle;
+		FHitResult Hit;
+		bool bHit = false;
+		uint64 SubmitFrame = 0;
+	};
+	FParkourAsyncProbe AsyncProbes[(uint8)EParkourProbe::MAX];
+	FParkourProbeFrame ProbeFrame;
+
+	//Inputs of the last ReplicatedState.Set, the defaults match a default FParkourReplicatedState
+	EParkourMode ReplicatedMode = EParkourMode::NONE;
+	int32 ReplicatedTimesJumped = 0;
+	bool bReplicatedCanDash = true;
+	FVector ReplicatedWallRunNormal = FVector::ZeroVector;
+	FVector ReplicatedLedgeClimbWallNormal = FVector::ZeroVector;
+	void UpdateReplicatedState();
+	TSharedPtr<FParkourLedgeDatabase> LedgeDatabase;
+
+	//Cached in Initialise so an unimplemented notification costs nothing per gate change
+	bool bGatesChangedEventImplemented = false;
+
+	//Gate reopen and delayed-check timers, advanced by the parkour update
+	typedef TParkourScheduler<UParkourComponent, 8> FParkourScheduler;
+	FParkourScheduler Scheduler;
+	FParkourScheduler::FHandle WallRunGateTimer = 0;
+	FParkourScheduler::FHandle WallRunGravityTimer = 0;
+	FParkourScheduler::FHandle VerticalWallRunGateTimer = 0;
+	FParkourScheduler::FHandle CheckMantleGateTimer = 0;
+	FParkourScheduler::FHandle SprintGateTimer = 0;
+
+	//Update LOD, rescored every LODScoreInterval seconds of parkour update time
+	static constexpr float LODScoreInterval = 0.5f;
+	float LODScoreTime = 0.0f;
+	bool bLODCounted = false;
+	void UpdateLODBucket(float DeltaTime);
+	EParkourLOD ScoreLOD() const;
+	void SetUpdateLOD(EParkourLOD NewLOD);
+
+	//Event-driven sleep, the tick is disabled while nothing can change without an event
+	bool bUpdateAsleep = false;
+	bool CanSleep() const;
+	void SleepUpdate();
+
+	//The update in the phases UParkourUpdateManager runs, TickComponent calls them back to back.
+	//Begin and Finish run serially, PlanProbes and RunPlannedProbes may run on a worker and only touch this component.
+	float UpdateInterval = 0.0f;
+	//Updated by the manager, the component's own tick stays disabled
+	bool bManagedUpdate = false;
+	//Set by BeginUpdate when the probe frame and DispatchUpdate run this update
+	bool bUpdateDispatches = false;
+	uint32 UpdateCycles = 0;
+	void SetUpdateInterval(float Interval);
+	void BeginUpdate(float DeltaTime);
+	void PlanProbes();
+	void RunPlannedProbes();
+	void FinishUpdate(float DeltaTime);
+	bool ConsumePrefetchedProbe(EParkourProbe Probe, const FVector& Start, const FVector& End, FHitResult& OutHit, bool& bOutHit);
+	//One box overlap covering the left, right, forward and down probes, then each of them traced against only the
+	//primitives it found. Runs when PlanProbes expects one of them this update.
+	void RunFusedProbe();
+	void SetForwardHit(const FHitResult& Hit);
+	FCollisionQueryParams GetLedgeQueryParams() const;
+
+	//Wall and ledge snap, cancelled by every mode change
+	FParkourCorrection Correction;
+	void StartCorrection(const FVector& Target, const FRotator& TargetRotation, const FVector& Axis);
+	void StepCorrection();
+
+	//Parkour updates since Initialise, the clock recordings are keyed by
+	uint32 SessionUpdate = 0;
+	TSharedPtr<FParkourRecordingWriter> Recorder;
+	TSharedPtr<FParkourRecordingReader> Playback;
+	//Recorded input vector standing in for the movement component's during playback
+	FVector PlaybackInput = FVector::ZeroVector;
+	//Delta time of the current recorded update, 0 until the recording gives one
+	float PlaybackDeltaTime = 0.0f;
+	//Set while a recorded event is dispatched, live calls to the entry points are dropped during playback
+	bool bDispatchingPlayback = false;
+	int32 PlaybackMismatches = 0;
+
+	//Last updates kept for hitch dumps, created by Initialise
+	TUniquePtr<FParkourFlightRecorder> FlightRecorder;
+	//Scene queries issued by the current update
+	uint16 UpdateQueries = 0;
+	bool HasAsyncProbeResult(const FParkourAsyncProbe& Probe) const;
+	bool ConsumeAsyncProbe(FParkourAsyncProbe& Probe, FHitResult& OutHit);
+
 	FVector WallRunNormal;
 	FVector WallRunLocation;
 
@@ -297,8 +658,13 @@ private:
 	float VerticalWallRunSpeed;
 	float VerticalWallRunCurrentSpeed;
 
-	bool bSprintQueued;
-	bool bSlideQueued;
+	//Jump, slide, sprint and dash presses waiting for a transition that can use them
+	FParkourInputBuffer InputBuffer;
+	double GetInputTime() const;
+	float GetBufferLifetime(EParkourBufferedAction Action) const;
+	bool IsInputBuffered(EParkourBufferedAction Action) const;
+	bool ConsumeBufferedInput(EParkourBufferedAction Action);
+	void CheckBufferedDash();
 
 	FVector GetSlideVector();
 
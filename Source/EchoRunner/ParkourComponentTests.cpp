@@ -0,0 +1,469 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+//Component-level parkour tests. Each one builds a small level out of engine cubes in a fresh game world, spawns an
+//AParkourCharacter with a UParkourComponent and drives it through a move with scripted input and events.
+//Run headless with:
+//  UnrealEditor-Cmd EchoRunner.uproject -ExecCmds="Automation RunTests EchoRunner.Parkour;Quit" -nullrhi -unattended
+//Transitions are asserted, and each test's per-mode update cost and scene queries are checked against
+//Tools/ParkourBench/ComponentBaseline.txt. Add -ParkourWriteBaseline to record the file after a deliberate change.
+
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+#include "Components/StaticMeshComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Engine/World.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ParkourCharacter.h"
+#include "ParkourComponent.h"
+
+//The protected event entry points and per-update counters the tests drive and read
+class FParkourComponentTestAccess
+{
+public:
+	static void Initialise(UParkourComponent& Parkour, ACharacter* Character) { Parkour.Initialise(Character); }
+	static void Jump(UParkourComponent& Parkour) { Parkour.JumpEvent(); }
+	static void Land(UParkourComponent& Parkour) { Parkour.LandEvent(); }
+	static void Dash(UParkourComponent& Parkour) { Parkour.DashEvent(); }
+	static void Sprint(UParkourComponent& Parkour) { Parkour.SprintEvent(); }
+	static void CrouchSlide(UParkourComponent& Parkour) { Parkour.CrouchSlideEvent(); }
+	static void MovementChanged(UParkourComponent& Parkour, EMovementMode PrevMovement, EMovementMode CurrentMovement)
+	{
+		Parkour.MovementChanged(PrevMovement, CurrentMovement);
+	}
+	static uint16 GetUpdateQueries(const UParkourComponent& Parkour) { return Parkour.UpdateQueries; }
+	static uint32 GetUpdateCycles(const UParkourComponent& Parkour) { return Parkour.UpdateCycles; }
+};
+
+namespace ParkourComponentTests
+{
+	static constexpr float StepTime = 1.0f / 60.0f;
+	static constexpr int32 NumModes = (int32)EParkourMode::CROUCH + 1;
+
+	static TAutoConsoleVariable<float> CVarTimingTolerance(
+		TEXT("parkour.TestTimingTolerance"),
+		25.0f,
+		TEXT("Percent a parkour component test's average or p99 update cost may exceed its baseline before it fails."));
+
+	//Query counts are deterministic, so they only get a small allowance for float drift across platforms
+	static constexpr double QueryTolerance = 2.0;
+
+	//One "<Test>.<Mode> AvgUs P99Us QueriesPerUpdate MaxQueries" line of the baseline, a '-' column is not checked.
+	//Test "*" holds the budget of every test that has no line of its own for the mode.
+	struct FModeBudget
+	{
+		double AverageUs = -1.0;
+		double P99Us = -1.0;
+		double QueriesPerUpdate = -1.0;
+		int32 MaxQueries = -1;
+	};
+
+	static FString GetBaselinePath()
+	{
+		return FPaths::Combine(FPaths::ProjectDir(), TEXT("Tools/ParkourBench/ComponentBaseline.txt"));
+	}
+
+	static void ReadBaseline(TMap<FString, FModeBudget>& OutBudgets)
+	{
+		TArray<FString> Lines;
+		FFileHelper::LoadFileToStringArray(Lines, *GetBaselinePath());
+		for (const FString& Line : Lines)
+		{
+			TArray<FString> Columns;
+			Line.ParseIntoArrayWS(Columns);
+			if (Columns.Num() != 5 or Columns[0].StartsWith(TEXT("#")))
+			{
+				continue;
+			}
+			auto Parse = [](const FString& Column) { return (Column == TEXT("-")) ? -1.0 : FCString::Atod(*Column); };
+			FModeBudget& Budget = OutBudgets.Add(Columns[0]);
+			Budget.AverageUs = Parse(Columns[1]);
+			Budget.P99Us = Parse(Columns[2]);
+			Budget.QueriesPerUpdate = Parse(Columns[3]);
+			Budget.MaxQueries = (int32)Parse(Columns[4]);
+		}
+	}
+
+	static void WriteBaseline(const TMap<FString, FModeBudget>& Budgets)
+	{
+		TArray<FString> Keys;
+		Budgets.GetKeys(Keys);
+		Keys.Sort();
+		FString Text = TEXT("# <Test>.<Mode> AvgUs P99Us QueriesPerUpdate MaxQueries, written by the EchoRunner.Parkour tests with -ParkourWriteBaseline\n");
+		for (const FString& Key : Keys)
+		{
+			const FModeBudget& Budget = Budgets[Key];
+			auto Format = [](double Value, const TCHAR* Fmt) { return (Value < 0.0) ? FString(TEXT("-")) : FString::Printf(Fmt, Value); };
+			Text += FString::Printf(TEXT("%s %s %s %s %s\n"), *Key, *Format(Budget.AverageUs, TEXT("%.1f")), *Format(Budget.P99Us, TEXT("%.1f")),
+				*Format(Budget.QueriesPerUpdate, TEXT("%.3f")), *Format(Budget.MaxQueries, TEXT("%.0f")));
+		}
+		FFileHelper::SaveStringToFile(Text, *GetBaselinePath());
+	}
+
+	//One test level: a floor, whatever boxes the test adds and a single runner
+	class FParkourTestLevel
+	{
+	public:
+		FParkourTestLevel()
+		{
+			World = UWorld::CreateWorld(EWorldType::Game, false, TEXT("ParkourComponentTest"));
+			FWorldContext& Context = GEngine->CreateNewWorldContext(EWorldType::Game);
+			Context.SetCurrentWorld(World);
+			World->InitializeActorsForPlay(FURL());
+			World->BeginPlay();
+			Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+			//Top of the floor at Z = 0
+			AddBox(FVector(0.0, 0.0, -50.0), FVector(5000.0, 5000.0, 50.0));
+		}
+
+		~FParkourTestLevel()
+		{
+			GEngine->DestroyWorldContext(World);
+			World->DestroyWorld(false);
+		}
+
+		bool IsValid() const { return World and Cube; }
+
+		void AddBox(const FVector& Center, const FVector& HalfExtent)
+		{
+			//The engine cube is 100 units across. Scaled at spawn, a static actor cannot move once registered.
+			const FTransform Transform(FRotator::ZeroRotator, Center, HalfExtent / 50.0);
+			AStaticMeshActor* Box = World->SpawnActor<AStaticMeshActor>(AStaticMeshActor::StaticClass(), Transform);
+			Box->GetStaticMeshComponent()->SetStaticMesh(Cube);
+		}
+
+		//Runner standing on the floor at XY, facing Yaw
+		UParkourComponent* SpawnRunner(const FVector2D& Location, float Yaw = 0.0f)
+		{
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+			const FTransform Transform(FRotator(0.0, Yaw, 0.0), FVector(Location.X, Location.Y, 100.0));
+			Runner = World->SpawnActor<AParkourCharacter>(AParkourCharacter::StaticClass(), Transform, SpawnParams);
+			Movement = Runner->GetCharacterMovement();
+			//No controller in the test world, input comes from AddMovementInput
+			Movement->bRunPhysicsWithNoController = true;
+			Movement->GetNavAgentPropertiesRef().bCanCrouch = true;
+
+			Parkour = NewObject<UParkourComponent>(Runner);
+			Parkour->bUseUpdateLOD = false;
+			Parkour->bAllowUpdateSleep = false;
+			Parkour->RegisterComponent();
+			FParkourComponentTestAccess::Initialise(*Parkour, Runner);
+			LastMovementMode = Movement->MovementMode;
+			Step(30);
+			return Parkour;
+		}
+
+		//Ticks the world with Input held. Stands in for the character Blueprint, which forwards landings and
+		//movement mode changes to the component.
+		void Step(int32 Frames, const FVector& Input = FVector::ZeroVector)
+		{
+			StepUntil([]() { return false; }, Frames, Input);
+		}
+
+		//Steps until Done holds, false if it still does not after MaxFrames
+		bool StepUntil(TFunctionRef<bool()> Done, int32 MaxFrames, const FVector& Input = FVector::ZeroVector)
+		{
+			for (int32 Frame = 0; Frame < MaxFrames; Frame++)
+			{
+				if (Done())
+				{
+					return true;
+				}
+				const EParkourMode UpdateMode = Parkour->CurrentParkourMode;
+				if (!Input.IsZero())
+				{
+					Runner->AddMovementInput(Input);
+				}
+				World->Tick(LEVELTICK_All, StepTime);
+				GFrameCounter++;
+
+				FModeSamples& Samples = Modes[(uint8)UpdateMode];
+				const uint16 Queries = FParkourComponentTestAccess::GetUpdateQueries(*Parkour);
+				Samples.Microseconds.Add(FPlatformTime::ToMilliseconds64(FParkourComponentTestAccess::GetUpdateCycles(*Parkour)) * 1000.0);
+				Samples.Queries += Queries;
+				Samples.MaxQueries = FMath::Max(Samples.MaxQueries, Queries);
+				Visited[(uint8)Parkour->CurrentParkourMode] = true;
+
+				const EMovementMode MovementMode = Movement->MovementMode;
+				if (MovementMode != LastMovementMode)
+				{
+					if (MovementMode == MOVE_Walking and (LastMovementMode == MOVE_Falling or LastMovementMode == MOVE_Custom))
+					{
+						FParkourComponentTestAccess::Land(*Parkour);
+					}
+					FParkourComponentTestAccess::MovementChanged(*Parkour, LastMovementMode, MovementMode);
+					LastMovementMode = MovementMode;
+				}
+			}
+			return Done();
+		}
+
+		bool HasVisited(EParkourMode Mode) const { return Visited[(uint8)Mode]; }
+		FVector GetForward() const { return Runner->GetActorForwardVector(); }
+
+		//Fails on any mode of TestName whose updates went over the baseline, or records them with -ParkourWriteBaseline
+		void CheckBudgets(FAutomationTestBase& Test, const FString& TestName)
+		{
+			TMap<FString, FModeBudget> Baseline;
+			ReadBaseline(Baseline);
+			const bool bWriteBaseline = FParse::Param(FCommandLine::Get(), TEXT("ParkourWriteBaseline"));
+			const double TimingScale = 1.0 + CVarTimingTolerance.GetValueOnGameThread() / 100.0;
+			const double QueryScale = 1.0 + QueryTolerance / 100.0;
+			const UEnum* ModeEnum = StaticEnum<EParkourMode>();
+			for (int32 Mode = 0; Mode < NumModes; Mode++)
+			{
+				FModeSamples& Samples = Modes[Mode];
+				if (Samples.Microseconds.Num() == 0)
+				{
+					continue;
+				}
+				const FString Key = TestName + TEXT(".") + ModeEnum->GetNameStringByValue(Mode);
+				Samples.Microseconds.Sort();
+				double Total = 0.0;
+				for (double Microseconds : Samples.Microseconds)
+				{
+					Total += Microseconds;
+				}
+				FModeBudget Measured;
+				Measured.AverageUs = Total / Samples.Microseconds.Num();
+				Measured.P99Us = Samples.Microseconds[FMath::Min(Samples.Microseconds.Num() - 1, FMath::FloorToInt(Samples.Microseconds.Num() * 0.99))];
+				Measured.QueriesPerUpdate = (double)Samples.Queries / Samples.Microseconds.Num();
+				Measured.MaxQueries = Samples.MaxQueries;
+				Test.AddInfo(FString::Printf(TEXT("%s: %d updates, avg %.1f us, p99 %.1f us, %.3f queries per update, max %d"),
+					*Key, Samples.Microseconds.Num(), Measured.AverageUs, Measured.P99Us, Measured.QueriesPerUpdate, Measured.MaxQueries));
+
+				if (bWriteBaseline)
+				{
+					Baseline.Add(Key, Measured);
+					continue;
+				}
+				//A test without its own entry for a mode falls back to the shared "*.<Mode>" budget
+				const FModeBudget* Budget = Baseline.Find(Key);
+				if (!Budget)
+				{
+					Budget = Baseline.Find(TEXT("*.") + ModeEnum->GetNameStringByValue(Mode));
+				}
+				if (!Test.TestNotNull(*FString::Printf(TEXT("%s has a baseline"), *Key), Budget))
+				{
+					continue;
+				}
+				if (Budget->AverageUs >= 0.0)
+				{
+					Test.TestTrue(*FString::Printf(TEXT("%s average %.1f us within %.1f us"), *Key, Measured.AverageUs, Budget->AverageUs * TimingScale),
+						Measured.AverageUs <= Budget->AverageUs * TimingScale);
+				}
+				if (Budget->P99Us >= 0.0)
+				{
+					Test.TestTrue(*FString::Printf(TEXT("%s p99 %.1f us within %.1f us"), *Key, Measured.P99Us, Budget->P99Us * TimingScale),
+						Measured.P99Us <= Budget->P99Us * TimingScale);
+				}
+				if (Budget->QueriesPerUpdate >= 0.0)
+				{
+					Test.TestTrue(*FString::Printf(TEXT("%s %.3f queries per update within %.3f"), *Key, Measured.QueriesPerUpdate, Budget->QueriesPerUpdate * QueryScale),
+						Measured.QueriesPerUpdate <= Budget->QueriesPerUpdate * QueryScale + 0.001);
+				}
+				if (Budget->MaxQueries >= 0)
+				{
+					Test.TestTrue(*FString::Printf(TEXT("%s worst update %d queries within %d"), *Key, Measured.MaxQueries, Budget->MaxQueries),
+						Measured.MaxQueries <= Budget->MaxQueries);
+				}
+			}
+			if (bWriteBaseline)
+			{
+				WriteBaseline(Baseline);
+			}
+		}
+
+		UWorld* World = nullptr;
+		AParkourCharacter* Runner = nullptr;
+		UCharacterMovementComponent* Movement = nullptr;
+		UParkourComponent* Parkour = nullptr;
+
+	private:
+		struct FModeSamples
+		{
+			TArray<double> Microseconds;
+			int64 Queries = 0;
+			uint16 MaxQueries = 0;
+		};
+		FModeSamples Modes[NumModes];
+		bool Visited[NumModes] = {};
+		UStaticMesh* Cube = nullptr;
+		TEnumAsByte<EMovementMode> LastMovementMode = MOVE_None;
+	};
+
+	//Runs along a wall on the Side of the runner, +1 right and -1 left, then jumps off it
+	static void RunWallRun(FAutomationTestBase& Test, const FString& TestName, float Side, EParkourMode ExpectedMode)
+	{
+		FParkourTestLevel Level;
+		if (!Test.TestTrue(TEXT("Test level built"), Level.IsValid()))
+		{
+			return;
+		}
+		//Wall face 60 units to the side of the runner's path along +X, inside the 75 unit wall-run probe
+		Level.AddBox(FVector(1500.0, Side * 85.0, 300.0), FVector(1500.0, 25.0, 300.0));
+		UParkourComponent* Parkour = Level.SpawnRunner(FVector2D(0.0, 0.0));
+		const FVector Forward = Level.GetForward();
+
+		Level.Step(20, Forward);
+		FParkourComponentTestAccess::Jump(*Parkour);
+		const bool bOnWall = Level.StepUntil([Parkour, ExpectedMode]() { return Parkour->CurrentParkourMode == ExpectedMode; }, 60, Forward);
+		Test.TestTrue(TEXT("Jumping beside the wall starts the wall run"), bOnWall);
+		if (!bOnWall)
+		{
+			return;
+		}
+		Level.Step(15, Forward);
+		Test.TestTrue(TEXT("Wall run holds while running along the wall"), Parkour->CurrentParkourMode == ExpectedMode);
+
+		FParkourComponentTestAccess::Jump(*Parkour);
+		Level.Step(5, Forward);
+		Test.TestTrue(TEXT("Jumping ends the wall run"), Parkour->CurrentParkourMode != ExpectedMode);
+		Level.CheckBudgets(Test, TestName);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FParkourRightWallRunTest, "EchoRunner.Parkour.RightWallRun",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FParkourRightWallRunTest::RunTest(const FString& Parameters)
+{
+	ParkourComponentTests::RunWallRun(*this, TEXT("RightWallRun"), 1.0f, EParkourMode::RIGHTWALLRUN);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FParkourLeftWallRunTest, "EchoRunner.Parkour.LeftWallRun",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FParkourLeftWallRunTest::RunTest(const FString& Parameters)
+{
+	ParkourComponentTests::RunWallRun(*this, TEXT("LeftWallRun"), -1.0f, EParkourMode::LEFTWALLRUN);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FParkourVerticalWallRunMantleTest, "EchoRunner.Parkour.VerticalWallRunMantle",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FParkourVerticalWallRunMantleTest::RunTest(const FString& Parameters)
+{
+	using namespace ParkourComponentTests;
+	FParkourTestLevel Level;
+	if (!TestTrue(TEXT("Test level built"), Level.IsValid()))
+	{
+		return true;
+	}
+	//200 unit high block, face at X = 250, too high to jump onto
+	Level.AddBox(FVector(300.0, 0.0, 100.0), FVector(50.0, 500.0, 100.0));
+	UParkourComponent* Parkour = Level.SpawnRunner(FVector2D(0.0, 0.0));
+	const FVector Forward = Level.GetForward();
+	AParkourCharacter* Runner = Level.Runner;
+
+	Level.StepUntil([Runner]() { return Runner->GetActorLocation().X >= 170.0; }, 120, Forward);
+	FParkourComponentTestAccess::Jump(*Parkour);
+	const bool bOnTop = Level.StepUntil([&Level, Runner]()
+	{
+		return Level.Movement->IsWalking() and Runner->GetActorLocation().Z > 200.0;
+	}, 240, Forward);
+
+	TestTrue(TEXT("Runs up the wall"), Level.HasVisited(EParkourMode::VERTICALWALLRUN));
+	TestTrue(TEXT("Grabs or mantles the ledge"), Level.HasVisited(EParkourMode::LEDGEGRAB) or Level.HasVisited(EParkourMode::MANTLE));
+	TestTrue(TEXT("Ends up standing on the block"), bOnTop);
+	Level.CheckBudgets(*this, TEXT("VerticalWallRunMantle"));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FParkourSprintSlideTest, "EchoRunner.Parkour.SprintSlide",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FParkourSprintSlideTest::RunTest(const FString& Parameters)
+{
+	using namespace ParkourComponentTests;
+	FParkourTestLevel Level;
+	if (!TestTrue(TEXT("Test level built"), Level.IsValid()))
+	{
+		return true;
+	}
+	UParkourComponent* Parkour = Level.SpawnRunner(FVector2D(0.0, 0.0));
+	const FVector Forward = Level.GetForward();
+
+	FParkourComponentTestAccess::Sprint(*Parkour);
+	Level.Step(30, Forward);
+	TestTrue(TEXT("Sprint holds while moving forward"), Parkour->CurrentParkourMode == EParkourMode::SPRINT);
+
+	FParkourComponentTestAccess::CrouchSlide(*Parkour);
+	Level.Step(1, Forward);
+	TestTrue(TEXT("Crouching out of a sprint slides"), Parkour->CurrentParkourMode == EParkourMode::SLIDE);
+
+	//Released, friction brings the slide down to its end speed
+	const bool bEnded = Level.StepUntil([Parkour]() { return Parkour->CurrentParkourMode != EParkourMode::SLIDE; }, 300);
+	TestTrue(TEXT("Slide ends once the runner stops"), bEnded);
+	Level.CheckBudgets(*this, TEXT("SprintSlide"));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FParkourDoubleJumpTest, "EchoRunner.Parkour.DoubleJump",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FParkourDoubleJumpTest::RunTest(const FString& Parameters)
+{
+	using namespace ParkourComponentTests;
+	FParkourTestLevel Level;
+	if (!TestTrue(TEXT("Test level built"), Level.IsValid()))
+	{
+		return true;
+	}
+	UParkourComponent* Parkour = Level.SpawnRunner(FVector2D(0.0, 0.0));
+	TestTrue(TEXT("Runner starts on the ground"), Level.Movement->IsWalking());
+
+	FParkourComponentTestAccess::Jump(*Parkour);
+	Level.Step(10);
+	TestTrue(TEXT("First jump leaves the ground"), Level.Movement->IsFalling());
+	TestEqual(TEXT("First jump is counted"), Parkour->TimesJumped, 1);
+
+	FParkourComponentTestAccess::Jump(*Parkour);
+	Level.Step(10);
+	TestEqual(TEXT("Second jump is counted"), Parkour->TimesJumped, 2);
+
+	FParkourComponentTestAccess::Jump(*Parkour);
+	Level.Step(1);
+	TestEqual(TEXT("Third jump is held instead of taken"), Parkour->TimesJumped, 2);
+
+	//The held jump is long expired by the landing
+	const bool bLanded = Level.StepUntil([&Level]() { return Level.Movement->IsWalking(); }, 240);
+	Level.Step(2);
+	TestTrue(TEXT("Runner lands"), bLanded);
+	TestEqual(TEXT("Landing resets the jump count"), Parkour->TimesJumped, 0);
+	Level.CheckBudgets(*this, TEXT("DoubleJump"));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FParkourDashTest, "EchoRunner.Parkour.Dash",
+	EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+bool FParkourDashTest::RunTest(const FString& Parameters)
+{
+	using namespace ParkourComponentTests;
+	FParkourTestLevel Level;
+	if (!TestTrue(TEXT("Test level built"), Level.IsValid()))
+	{
+		return true;
+	}
+	UParkourComponent* Parkour = Level.SpawnRunner(FVector2D(0.0, 0.0));
+	const FVector Forward = Level.GetForward();
+
+	Level.Step(20, Forward);
+	FParkourComponentTestAccess::Jump(*Parkour);
+	Level.Step(5, Forward);
+	const double SpeedBefore = Level.Movement->Velocity.Size2D();
+
+	FParkourComponentTestAccess::Dash(*Parkour);
+	Level.Step(2, Forward);
+	TestFalse(TEXT("Dash is used up"), Parkour->bCanDash);
+	TestTrue(TEXT("Dash speeds the runner up"), Level.Movement->Velocity.Size2D() > SpeedBefore);
+	TestTrue(TEXT("Air dash stays within the dash range"), Level.Movement->Velocity.Size2D() <= Parkour->DashRange + 1.0);
+	Level.CheckBudgets(*this, TEXT("Dash"));
+	return true;
+}
+
+#endif
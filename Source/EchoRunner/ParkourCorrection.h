@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+//Blends the character onto a wall or ledge target over a fixed time, stepped by the parkour update.
+//Each step closes a share of the remaining error instead of replaying a fixed path, so movement the
+//CharacterMovement applies between updates is kept rather than overwritten.
+
+#include "CoreMinimal.h"
+
+class FParkourCorrection
+{
+public:
+	//Error below which the correction counts as done, in cm and degrees
+	static constexpr float LocationTolerance = 0.5f;
+	static constexpr float YawTolerance = 0.5f;
+
+	//A non-zero Axis only corrects along it, so a run along or up the wall isn't pulled back
+	void Start(const FVector& InTarget, float InTargetYaw, const FVector& InAxis, float InDuration)
+	{
+		Target = InTarget;
+		TargetYaw = InTargetYaw;
+		Axis = InAxis.GetSafeNormal();
+		TimeLeft = FMath::Max(InDuration, UE_KINDA_SMALL_NUMBER);
+		bActive = true;
+	}
+
+	void Cancel() { bActive = false; }
+	bool IsActive() const { return bActive; }
+
+	//Offset still to cover from Location, the part of it the correction is allowed to move
+	FVector GetRemainingError(const FVector& Location) const
+	{
+		FVector Error = Target - Location;
+		return Axis.IsZero() ? Error : Axis * FVector::DotProduct(Error, Axis);
+	}
+
+	//Returns false once the correction is finished or cancelled, otherwise the delta and yaw to apply this update
+	bool Step(const FVector& Location, float Yaw, float DeltaTime, FVector& OutDelta, float& OutYaw)
+	{
+		if (!bActive)
+		{
+			return false;
+		}
+		const FVector Error = GetRemainingError(Location);
+		const float YawError = FMath::FindDeltaAngleDegrees(Yaw, TargetYaw);
+		if (Error.SizeSquared() < FMath::Square(LocationTolerance) and FMath::Abs(YawError) < YawTolerance)
+		{
+			bActive = false;
+			return false;
+		}
+
+		const float Alpha = FMath::Min(DeltaTime / TimeLeft, 1.0f);
+		TimeLeft -= DeltaTime;
+		bActive = (TimeLeft > 0.0f);
+		OutDelta = Error * Alpha;
+		OutYaw = Yaw + YawError * Alpha;
+		return true;
+	}
+
+private:
+	FVector Target = FVector::ZeroVector;
+	FVector Axis = FVector::ZeroVector;
+	float TargetYaw = 0.0f;
+	float TimeLeft = 0.0f;
+	bool bActive = false;
+};
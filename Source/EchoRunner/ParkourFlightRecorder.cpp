@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourFlightRecorder.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Compression.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryWriter.h"
+#include "Tasks/Task.h"
+
+namespace ParkourFlightRecorder
+{
+	static TAutoConsoleVariable<float> CVarHitchThresholdMs(
+		TEXT("parkour.HitchThresholdMs"),
+		100.0f,
+		TEXT("Frames longer than this dump every parkour flight recorder to Saved/ParkourHitches, 0 disables."));
+
+	static TAutoConsoleVariable<float> CVarHitchCooldownSeconds(
+		TEXT("parkour.HitchCooldownSeconds"),
+		10.0f,
+		TEXT("Minimum time between two parkour hitch dumps."));
+
+	//Game thread only
+	static TArray<FParkourFlightRecorder*> LiveRecorders;
+	static FDelegateHandle EndFrameHandle;
+	static double LastEndFrameSeconds = 0.0;
+	static double LastDumpSeconds = -UE_BIG_NUMBER;
+
+	static void OnEndFrame()
+	{
+		const double Now = FPlatformTime::Seconds();
+		const double FrameMs = (LastEndFrameSeconds > 0.0) ? (Now - LastEndFrameSeconds) * 1000.0 : 0.0;
+		LastEndFrameSeconds = Now;
+
+		const float ThresholdMs = CVarHitchThresholdMs.GetValueOnGameThread();
+		if (ThresholdMs > 0.0f and FrameMs > ThresholdMs)
+		{
+			FParkourFlightRecorder::SnapshotAll(FrameMs);
+		}
+	}
+
+	static FString MakeHitchPath()
+	{
+		return FPaths::ProjectSavedDir() / TEXT("ParkourHitches") / FString::Printf(TEXT("Hitch_%s_%llu.pkh"), *FDateTime::Now().ToString(), (uint64)GFrameCounter);
+	}
+}
+
+FParkourFlightRecorder::FParkourFlightRecorder(const UObject* InOwner)
+	: Head(0)
+	, Owner(InOwner)
+{
+	check(IsInGameThread());
+	if (!ParkourFlightRecorder::EndFrameHandle.IsValid())
+	{
+		ParkourFlightRecorder::EndFrameHandle = FCoreDelegates::OnEndFrame.AddStatic(&ParkourFlightRecorder::OnEndFrame);
+	}
+	ParkourFlightRecorder::LiveRecorders.Add(this);
+}
+
+FParkourFlightRecorder::~FParkourFlightRecorder()
+{
+	check(IsInGameThread());
+	ParkourFlightRecorder::LiveRecorders.RemoveSwap(this);
+}
+
+void FParkourFlightRecorder::Snapshot(TArray<FParkourFlightSample>& OutSamples) const
+{
+	const uint32 End = Head.load(std::memory_order_acquire);
+	const uint32 Count = FMath::Min(End, Capacity);
+	OutSamples.Reset(Count);
+	for (uint32 Index = End - Count; Index != End; Index++)
+	{
+		OutSamples.Add(Samples[Index & (Capacity - 1)]);
+	}
+
+	//Anything the writer lapped while we copied is torn, drop it from the front
+	const uint32 After = Head.load(std::memory_order_acquire);
+	const uint32 Overwritten = FMath::Min(After - End, Count);
+	OutSamples.RemoveAt(0, Overwritten, false);
+}
+
+bool FParkourFlightRecorder::SnapshotAll(double FrameMs)
+{
+	check(IsInGameThread());
+	const double Now = FPlatformTime::Seconds();
+	if (ParkourFlightRecorder::LiveRecorders.Num() == 0
+		or Now - ParkourFlightRecorder::LastDumpSeconds < ParkourFlightRecorder::CVarHitchCooldownSeconds.GetValueOnGameThread())
+	{
+		return false;
+	}
+	ParkourFlightRecorder::LastDumpSeconds = Now;
+
+	//Only the copy happens on the game thread, compression and IO go to the background
+	TArray<uint8> Payload;
+	FMemoryWriter Writer(Payload);
+	double SecondsPerCycle = FPlatformTime::GetSecondsPerCycle();
+	uint64 Frame = GFrameCounter;
+	int32 NumRecorders = ParkourFlightRecorder::LiveRecorders.Num();
+	Writer << FrameMs << SecondsPerCycle << Frame << NumRecorders;
+
+	TArray<FParkourFlightSample> Samples;
+	for (const FParkourFlightRecorder* Recorder : ParkourFlightRecorder::LiveRecorders)
+	{
+		const UObject* RecorderOwner = Recorder->Owner.Get();
+		FString OwnerName = RecorderOwner ? RecorderOwner->GetPathName() : FString();
+		Recorder->Snapshot(Samples);
+		int32 NumSamples = Samples.Num();
+		Writer << OwnerName << NumSamples;
+		Writer.Serialize(Samples.GetData(), Samples.Num() * sizeof(FParkourFlightSample));
+	}
+
+	UE::Tasks::Launch(UE_SOURCE_LOCATION, [Payload = MoveTemp(Payload), Path = ParkourFlightRecorder::MakeHitchPath()]()
+	{
+		int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, Payload.Num());
+		TArray<uint8> File;
+		File.SetNumUninitialized(4 * sizeof(uint32) + CompressedSize);
+		if (!FCompression::CompressMemory(NAME_Zlib, File.GetData() + 4 * sizeof(uint32), CompressedSize, Payload.GetData(), Payload.Num()))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Could not compress parkour hitch %s"), *Path);
+			return;
+		}
+		uint32* FileHeader = reinterpret_cast<uint32*>(File.GetData());
+		FileHeader[0] = FileMagic;
+		FileHeader[1] = FileVersion;
+		FileHeader[2] = (uint32)Payload.Num();
+		FileHeader[3] = (uint32)CompressedSize;
+		File.SetNum(4 * sizeof(uint32) + CompressedSize);
+		if (FFileHelper::SaveArrayToFile(File, *Path))
+		{
+			UE_LOG(LogTemp, Log, TEXT("Wrote parkour hitch %s"), *Path);
+		}
+	}, UE::Tasks::ETaskPriority::BackgroundLow);
+	return true;
+}
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+//One parkour update as seen by the flight recorder
+struct FParkourFlightSample
+{
+	uint32 Frame = 0;
+	//FPlatformTime cycles spent in the update
+	uint32 Cycles = 0;
+	FVector3f Velocity = FVector3f::ZeroVector;
+	float GravityScale = 0.0f;
+	uint16 Queries = 0;
+	uint8 Mode = 0;
+	uint8 PrevMode = 0;
+	uint8 Gates = 0;
+	uint8 Reserved[3] = {};
+};
+static_assert(sizeof(FParkourFlightSample) == 32, "FParkourFlightSample layout is part of the hitch file format");
+
+//Fixed-size ring of a component's last updates, always on.
+//Recording is a sample copy and one release store. A frame over parkour.HitchThresholdMs snapshots every
+//live recorder and a background task writes them zlib compressed to Saved/ParkourHitches/*.pkh.
+class ECHORUNNER_API FParkourFlightRecorder
+{
+public:
+	static constexpr uint32 Capacity = 64;
+	static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+	static constexpr uint32 FileMagic = 0x52464B50; //'PKFR'
+	static constexpr uint32 FileVersion = 1;
+
+	explicit FParkourFlightRecorder(const UObject* InOwner);
+	~FParkourFlightRecorder();
+
+	FParkourFlightRecorder(const FParkourFlightRecorder&) = delete;
+	FParkourFlightRecorder& operator=(const FParkourFlightRecorder&) = delete;
+
+	//Single writer, the owning component's update
+	void Record(const FParkourFlightSample& Sample)
+	{
+		const uint32 Index = Head.load(std::memory_order_relaxed);
+		Samples[Index & (Capacity - 1)] = Sample;
+		Head.store(Index + 1, std::memory_order_release);
+	}
+
+	//Copies out the recorded samples oldest first, skipping any the writer overwrote during the copy
+	void Snapshot(TArray<FParkourFlightSample>& OutSamples) const;
+
+	//Writes a hitch file for every live recorder, returns false when the cooldown suppressed it
+	static bool SnapshotAll(double FrameMs);
+
+private:
+	FParkourFlightSample Samples[Capacity];
+	std::atomic<uint32> Head;
+	TWeakObjectPtr<const UObject> Owner;
+};
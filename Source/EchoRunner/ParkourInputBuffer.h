@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+//Timestamped parkour intents, held until a transition point uses them or their lifetime runs out, plus the coyote
+//window after leaving the ground or a wall without jumping. An input a few milliseconds early or late still lands
+//instead of being dropped or waiting on a timer.
+
+#include "CoreMinimal.h"
+
+enum class EParkourBufferedAction : uint8
+{
+	JUMP,
+	SLIDE,
+	//Also carries an interrupted sprint across a jump
+	SPRINT,
+	DASH,
+	MAX
+};
+
+enum class EParkourCoyote : uint8
+{
+	NONE,
+	GROUND,
+	WALL
+};
+
+class FParkourInputBuffer
+{
+public:
+	void Buffer(EParkourBufferedAction Action, double Time)
+	{
+		FEntry& Entry = Entries[(uint8)Action];
+		Entry.Time = Time;
+		Entry.bPending = true;
+	}
+
+	//A Lifetime of zero or less keeps the action until it is consumed or cleared
+	bool IsBuffered(EParkourBufferedAction Action, double Time, float Lifetime) const
+	{
+		const FEntry& Entry = Entries[(uint8)Action];
+		return Entry.bPending and (Lifetime <= 0.0f or Time - Entry.Time <= Lifetime);
+	}
+
+	//Clears the action, expired or not, and reports how long it waited when it was still live
+	bool Consume(EParkourBufferedAction Action, double Time, float Lifetime, double& OutAge)
+	{
+		const bool bLive = IsBuffered(Action, Time, Lifetime);
+		OutAge = Time - Entries[(uint8)Action].Time;
+		Clear(Action);
+		return bLive;
+	}
+
+	void Clear(EParkourBufferedAction Action) { Entries[(uint8)Action].bPending = false; }
+
+	void OpenCoyote(EParkourCoyote Source, double Time)
+	{
+		CoyoteSource = Source;
+		CoyoteTime = Time;
+	}
+
+	void CloseCoyote() { CoyoteSource = EParkourCoyote::NONE; }
+
+	//Where a jump at Time is taken from, the window closes either way
+	EParkourCoyote ConsumeCoyote(double Time, float Window)
+	{
+		const EParkourCoyote Source = (Time - CoyoteTime <= Window) ? CoyoteSource : EParkourCoyote::NONE;
+		CoyoteSource = EParkourCoyote::NONE;
+		return Source;
+	}
+
+	void Reset()
+	{
+		for (FEntry& Entry : Entries)
+		{
+			Entry.bPending = false;
+		}
+		CloseCoyote();
+	}
+
+private:
+	struct FEntry
+	{
+		double Time = 0.0;
+		bool bPending = false;
+	};
+	FEntry Entries[(uint8)EParkourBufferedAction::MAX];
+	EParkourCoyote CoyoteSource = EParkourCoyote::NONE;
+	double CoyoteTime = 0.0;
+};
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+//On-disk layout of the baked ledge database, Content/ParkourIndex/Ledges/<Map>.bin.
+//The file is used in place after memory mapping, so every record is plain data at a fixed,
+//4-byte aligned offset and nothing needs fixing up on load. Little-endian, like every target platform.
+//
+//	FParkourLedgeBlobHeader
+//	uint32 CellStarts[NumCells + 1]	ledges of cell i are CellLedges[CellStarts[i] .. CellStarts[i + 1])
+//	uint32 CellLedges[...]
+//	FParkourLedgeRecord Ledges[NumLedges]
+
+#include <cstdint>
+
+struct FParkourLedgeBlobHeader
+{
+	//"PKLD"
+	static const uint32_t ExpectedMagic = 0x444C4B50;
+	//Bumped whenever the layout or the bake rules change, stale files are ignored
+	static const uint32_t CurrentVersion = 3;
+
+	enum : uint32_t
+	{
+		//The bake saw every static, Visibility-blocking primitive of the level, so a miss rules out static ledges
+		FLAG_COVERSSTATIC = 1 << 0
+	};
+
+	uint32_t Magic;
+	uint32_t Version;
+	uint32_t FileSize;
+	uint32_t NumLedges;
+	int32_t GridSizeX;
+	int32_t GridSizeY;
+	float CellSize;
+	float OriginX;
+	float OriginY;
+	//MantleHeight the quick-mantle flags were baked against
+	float BakedMantleHeight;
+	uint32_t CellStartsOffset;
+	uint32_t CellLedgesOffset;
+	uint32_t LedgesOffset;
+	//Each ledge is binned into every cell within this distance of its lip or floor strip,
+	//so a probe no wider than this only reads the one cell it starts in
+	float ProbeMargin;
+	uint32_t Flags;
+};
+
+//One straight ledge lip: the top edge of a wall with walkable floor behind it
+struct FParkourLedgeRecord
+{
+	enum : uint32_t
+	{
+		//Lip to ground is at most the baked MantleHeight
+		FLAG_QUICKMANTLE = 1 << 0
+	};
+
+	float LipStart[3];
+	float LipEnd[3];
+	//Horizontal outward wall normal
+	float WallNormal[2];
+	//How far the floor extends behind the lip
+	float FloorDepth;
+	//Ground height at the foot of the wall
+	float GroundZ;
+	uint32_t Flags;
+	uint32_t Reserved;
+};
+
+static_assert(sizeof(FParkourLedgeBlobHeader) == 60, "FParkourLedgeBlobHeader layout is part of the file format");
+static_assert(sizeof(FParkourLedgeRecord) == 48, "FParkourLedgeRecord layout is part of the file format");
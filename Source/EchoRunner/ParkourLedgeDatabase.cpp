@@ -0,0 +1,219 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourLedgeDatabase.h"
+#include "Async/MappedFileHandle.h"
+#include "Engine/World.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+
+namespace ParkourLedgeDatabase
+{
+	//Game thread only, components of one level share one mapping
+	static TMap<FString, TWeakPtr<FParkourLedgeDatabase>> LoadedDatabases;
+}
+
+FParkourLedgeDatabase::FParkourLedgeDatabase()
+	: Header(nullptr)
+	, CellStarts(nullptr)
+	, CellLedges(nullptr)
+	, Ledges(nullptr)
+{
+}
+
+FParkourLedgeDatabase::~FParkourLedgeDatabase()
+{
+	//Region must be unmapped before its file handle closes
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
+
+TSharedPtr<FParkourLedgeDatabase> FParkourLedgeDatabase::LoadForWorld(const UWorld* World)
+{
+	check(IsInGameThread());
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+	FString Path = GetDatabasePath(UWorld::RemovePIEPrefix(World->GetOutermost()->GetName()));
+	if (TSharedPtr<FParkourLedgeDatabase> Existing = ParkourLedgeDatabase::LoadedDatabases.FindRef(Path).Pin())
+	{
+		return Existing;
+	}
+
+	TSharedPtr<FParkourLedgeDatabase> Database = MakeShared<FParkourLedgeDatabase>();
+	if (!Database->Load(Path))
+	{
+		return nullptr;
+	}
+	ParkourLedgeDatabase::LoadedDatabases.Add(Path, Database);
+	return Database;
+}
+
+FString FParkourLedgeDatabase::GetDatabasePath(const FString& MapPackageName)
+{
+	//Staged loose (non-UFS) so the file can be mapped straight from disk rather than read out of a pak
+	return FPaths::ProjectContentDir() / TEXT("ParkourIndex/Ledges") / (FPackageName::GetShortName(MapPackageName) + TEXT(".bin"));
+}
+
+bool FParkourLedgeDatabase::Load(const FString& Path)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.FileExists(*Path))
+	{
+		return false;
+	}
+
+	MappedFile.Reset(PlatformFile.OpenMapped(*Path));
+	if (MappedFile)
+	{
+		MappedRegion.Reset(MappedFile->MapRegion());
+	}
+	if (MappedRegion)
+	{
+		if (Validate(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize()))
+		{
+			return true;
+		}
+	}
+	else if (FFileHelper::LoadFileToArray(LoadedData, *Path))
+	{
+		if (Validate(LoadedData.GetData(), LoadedData.Num()))
+		{
+			return true;
+		}
+	}
+
+	UE_LOG(LogTemp, Warning, TEXT("%s is missing, corrupt or out of date, rerun the ParkourLedgeDatabase commandlet"), *Path);
+	return false;
+}
+
+bool FParkourLedgeDatabase::Validate(const uint8* Data, int64 Size)
+{
+	if (Data == nullptr or Size < (int64)sizeof(FParkourLedgeBlobHeader) or !IsAligned(Data, alignof(FParkourLedgeBlobHeader)))
+	{
+		return false;
+	}
+	const FParkourLedgeBlobHeader* FileHeader = reinterpret_cast<const FParkourLedgeBlobHeader*>(Data);
+	if (FileHeader->Magic != FParkourLedgeBlobHeader::ExpectedMagic
+		or FileHeader->Version != FParkourLedgeBlobHeader::CurrentVersion
+		or FileHeader->FileSize != Size
+		or FileHeader->GridSizeX <= 0 or FileHeader->GridSizeY <= 0
+		or FileHeader->CellSize <= 0.0f)
+	{
+		return false;
+	}
+
+	const int64 NumCells = (int64)FileHeader->GridSizeX * FileHeader->GridSizeY;
+	const int64 CellStartsEnd = FileHeader->CellStartsOffset + (NumCells + 1) * sizeof(uint32);
+	const int64 LedgesEnd = FileHeader->LedgesOffset + (int64)FileHeader->NumLedges * sizeof(FParkourLedgeRecord);
+	if (FileHeader->CellStartsOffset < sizeof(FParkourLedgeBlobHeader) or CellStartsEnd > FileHeader->CellLedgesOffset
+		or FileHeader->CellLedgesOffset > FileHeader->LedgesOffset or LedgesEnd != Size
+		or FileHeader->CellStartsOffset % sizeof(uint32) != 0 or FileHeader->CellLedgesOffset % sizeof(uint32) != 0
+		or FileHeader->LedgesOffset % alignof(FParkourLedgeRecord) != 0)
+	{
+		return false;
+	}
+
+	//Every index is checked here once so FindLedge can trust the file
+	const uint32* FileCellStarts = reinterpret_cast<const uint32*>(Data + FileHeader->CellStartsOffset);
+	const uint32* FileCellLedges = reinterpret_cast<const uint32*>(Data + FileHeader->CellLedgesOffset);
+	const int64 NumCellLedges = (FileHeader->LedgesOffset - FileHeader->CellLedgesOffset) / sizeof(uint32);
+	if (FileCellStarts[0] != 0 or FileCellStarts[NumCells] > NumCellLedges)
+	{
+		return false;
+	}
+	for (int64 Cell = 0; Cell < NumCells; Cell++)
+	{
+		if (FileCellStarts[Cell] > FileCellStarts[Cell + 1])
+		{
+			return false;
+		}
+	}
+	for (int64 Item = 0; Item < FileCellStarts[NumCells]; Item++)
+	{
+		if (FileCellLedges[Item] >= FileHeader->NumLedges)
+		{
+			return false;
+		}
+	}
+
+	Header = FileHeader;
+	CellStarts = FileCellStarts;
+	CellLedges = FileCellLedges;
+	Ledges = reinterpret_cast<const FParkourLedgeRecord*>(Data + FileHeader->LedgesOffset);
+	return true;
+}
+
+bool FParkourLedgeDatabase::FindLedge(const FVector& Top, const FVector& Bottom, const FVector& Forward, float Radius, float HalfHeight, FParkourLedgeQueryResult& OutResult) const
+{
+	const int32 CellX = FMath::FloorToInt((Top.X - Header->OriginX) / Header->CellSize);
+	const int32 CellY = FMath::FloorToInt((Top.Y - Header->OriginY) / Header->CellSize);
+	if (CellX < 0 or CellY < 0 or CellX >= Header->GridSizeX or CellY >= Header->GridSizeY)
+	{
+		return false;
+	}
+	Radius = FMath::Min(Radius, Header->ProbeMargin);
+
+	const FVector2D Probe(Top.X, Top.Y);
+	const FVector2D Facing = FVector2D(Forward.X, Forward.Y).GetSafeNormal();
+	//Floor heights the capsule sweep could touch on its way down
+	const float MaxFloorZ = Top.Z - HalfHeight;
+	const float MinFloorZ = Bottom.Z - HalfHeight;
+
+	const FParkourLedgeRecord* Best = nullptr;
+	float BestZ = -UE_BIG_NUMBER;
+	FVector2D BestFloor = FVector2D::ZeroVector;
+	FVector2D BestLip = FVector2D::ZeroVector;
+
+	const int32 Cell = CellY * Header->GridSizeX + CellX;
+	for (uint32 Item = CellStarts[Cell]; Item < CellStarts[Cell + 1]; Item++)
+	{
+		const FParkourLedgeRecord& Ledge = Ledges[CellLedges[Item]];
+		const FVector2D Normal(Ledge.WallNormal[0], Ledge.WallNormal[1]);
+		//Same facing requirement the forward wall sweep enforces by hitting the wall
+		if (FVector2D::DotProduct(Facing, Normal) > -0.5f)
+		{
+			continue;
+		}
+
+		const FVector2D Start(Ledge.LipStart[0], Ledge.LipStart[1]);
+		const FVector2D Lip = FVector2D(Ledge.LipEnd[0], Ledge.LipEnd[1]) - Start;
+		const float LipLength = Lip.Size();
+		if (LipLength <= UE_KINDA_SMALL_NUMBER)
+		{
+			continue;
+		}
+		const FVector2D LipDir = Lip / LipLength;
+		const float Along = FVector2D::DotProduct(Probe - Start, LipDir);
+		const float Inward = -FVector2D::DotProduct(Probe - Start, Normal);
+		if (Along < -Radius or Along > LipLength + Radius or Inward < -Radius or Inward > Ledge.FloorDepth)
+		{
+			continue;
+		}
+
+		const float Alpha = FMath::Clamp(Along / LipLength, 0.0f, 1.0f);
+		const float LipZ = FMath::Lerp(Ledge.LipStart[2], Ledge.LipEnd[2], Alpha);
+		if (LipZ < MinFloorZ or LipZ > MaxFloorZ or LipZ <= BestZ)
+		{
+			continue;
+		}
+		Best = &Ledge;
+		BestZ = LipZ;
+		BestLip = Start + LipDir * (Alpha * LipLength);
+		BestFloor = BestLip - Normal * FMath::Max(Inward, 0.0f);
+	}
+
+	if (Best == nullptr)
+	{
+		return false;
+	}
+	OutResult.FloorPosition = FVector(BestFloor.X, BestFloor.Y, BestZ);
+	OutResult.WallPosition = FVector(BestLip.X, BestLip.Y, FMath::Clamp(Bottom.Z, Best->GroundZ, BestZ));
+	OutResult.WallNormal = FVector(Best->WallNormal[0], Best->WallNormal[1], 0.0);
+	OutResult.TraceDistance = MaxFloorZ - BestZ;
+	OutResult.GroundZ = Best->GroundZ;
+	OutResult.bQuickMantleHeight = (Best->Flags & FParkourLedgeRecord::FLAG_QUICKMANTLE) != 0;
+	return true;
+}
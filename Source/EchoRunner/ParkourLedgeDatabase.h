@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ParkourLedgeBlob.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+class UWorld;
+
+struct FParkourLedgeQueryResult
+{
+	FVector FloorPosition = FVector::ZeroVector;
+	FVector WallPosition = FVector::ZeroVector;
+	FVector WallNormal = FVector::ZeroVector;
+	//Distance the ledge sweep would have travelled before touching the floor
+	float TraceDistance = 0.0;
+	float GroundZ = 0.0;
+	bool bQuickMantleHeight = false;
+};
+
+//Read-only view of a level's baked ledge lips, memory mapped from Content/ParkourIndex/Ledges/<Map>.bin.
+//Written by UParkourLedgeDatabaseCommandlet. The file is validated once on load, after which
+//queries index into it directly with no copies, allocation or further bounds checks.
+class ECHORUNNER_API FParkourLedgeDatabase
+{
+public:
+	FParkourLedgeDatabase();
+	~FParkourLedgeDatabase();
+
+	//Shared by every component in the same level, null if the level has no current bake
+	static TSharedPtr<FParkourLedgeDatabase> LoadForWorld(const UWorld* World);
+	static FString GetDatabasePath(const FString& MapPackageName);
+
+	//Baked equivalent of the ledge sweep from Top down to Bottom: the highest walkable lip
+	//within Radius of the probe column whose wall faces Forward. Radius is capped at the baked margin.
+	bool FindLedge(const FVector& Top, const FVector& Bottom, const FVector& Forward, float Radius, float HalfHeight, FParkourLedgeQueryResult& OutResult) const;
+
+	int32 NumLedges() const { return Header ? Header->NumLedges : 0; }
+	//MantleHeight the FLAG_QUICKMANTLE flags were baked against
+	float GetBakedMantleHeight() const { return Header ? Header->BakedMantleHeight : 0.0f; }
+	//False when the level had static geometry the bake could not read, so a miss proves nothing about it
+	bool CoversStaticGeometry() const { return Header and (Header->Flags & FParkourLedgeBlobHeader::FLAG_COVERSSTATIC) != 0; }
+
+private:
+	bool Load(const FString& Path);
+	bool Validate(const uint8* Data, int64 Size);
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	//Used where the platform cannot map the file
+	TArray<uint8> LoadedData;
+
+	const FParkourLedgeBlobHeader* Header;
+	const uint32* CellStarts;
+	const uint32* CellLedges;
+	const FParkourLedgeRecord* Ledges;
+};
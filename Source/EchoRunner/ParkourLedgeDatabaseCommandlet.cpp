@@ -0,0 +1,334 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourLedgeDatabaseCommandlet.h"
+#include "Engine/World.h"
+#include "Misc/FileHelper.h"
+#include "ParkourBakeUtils.h"
+#include "ParkourLedgeDatabase.h"
+#include "ParkourSim.h"
+
+#if WITH_EDITOR
+namespace ParkourLedgeBake
+{
+	struct FBakeSettings
+	{
+		float CellSize = 400.0f;
+		float MantleHeight = 44.0f;
+		float WalkableFloorZ = 0.71f;
+		float ProbeMargin = 32.0f;
+		//Steps lower than this are left to walking
+		float MinWallHeight = 20.0f;
+		//Vertices closer than this are welded when matching edges between faces
+		float WeldTolerance = 1.0f;
+		//A floor mesh separate from the wall makes its top edge a lip when it lies this close above or below the edge,
+		//sampled this far behind it
+		float LipFloorTolerance = 20.0f;
+		float LipProbeInset = 8.0f;
+	};
+
+	typedef TPair<FIntVector, FIntVector> FEdgeKey;
+
+	static FIntVector Quantize(const FVector& Point, float Tolerance)
+	{
+		return FIntVector(FMath::RoundToInt(Point.X / Tolerance), FMath::RoundToInt(Point.Y / Tolerance), FMath::RoundToInt(Point.Z / Tolerance));
+	}
+
+	static FEdgeKey MakeEdgeKey(const FVector& A, const FVector& B, float Tolerance)
+	{
+		FIntVector QA = Quantize(A, Tolerance);
+		FIntVector QB = Quantize(B, Tolerance);
+		bool bSwap = (QA.X != QB.X) ? (QA.X > QB.X) : ((QA.Y != QB.Y) ? (QA.Y > QB.Y) : (QA.Z > QB.Z));
+		return bSwap ? FEdgeKey(QB, QA) : FEdgeKey(QA, QB);
+	}
+
+	//Highest walkable floor triangle under Point whose surface there lies between MinZ and MaxZ
+	static bool FindFloorUnder(const TArray<ParkourBake::FTriangle>& Triangles, const TMap<FIntPoint, TArray<int32>>& FloorCells, float CellSize,
+		const FVector2D& Point, double MinZ, double MaxZ, int32& OutFloor, double& OutZ)
+	{
+		const TArray<int32>* Floors = FloorCells.Find(FIntPoint(FMath::FloorToInt(Point.X / CellSize), FMath::FloorToInt(Point.Y / CellSize)));
+		if (Floors == nullptr)
+		{
+			return false;
+		}
+		OutFloor = INDEX_NONE;
+		for (int32 FloorIndex : *Floors)
+		{
+			const ParkourBake::FTriangle& Floor = Triangles[FloorIndex];
+			//Barycentric weights of Point in the triangle's XY projection
+			const FVector2D A(Floor.A), B(Floor.B), C(Floor.C);
+			const double Area = FVector2D::CrossProduct(B - A, C - A);
+			if (FMath::IsNearlyZero(Area))
+			{
+				continue;
+			}
+			const double WeightB = FVector2D::CrossProduct(Point - A, C - A) / Area;
+			const double WeightC = FVector2D::CrossProduct(B - A, Point - A) / Area;
+			if (WeightB < 0.0 or WeightC < 0.0 or WeightB + WeightC > 1.0)
+			{
+				continue;
+			}
+			const double Z = Floor.A.Z + WeightB * (Floor.B.Z - Floor.A.Z) + WeightC * (Floor.C.Z - Floor.A.Z);
+			if (Z >= MinZ and Z <= MaxZ and (OutFloor == INDEX_NONE or Z > OutZ))
+			{
+				OutFloor = FloorIndex;
+				OutZ = Z;
+			}
+		}
+		return OutFloor != INDEX_NONE;
+	}
+
+	//A lip is the horizontal top edge of a wall triangle with a walkable floor triangle behind it. The floor either
+	//shares the edge, or, where wall and floor are separate meshes, sits just behind the edge at about its height
+	//with nothing at that height in front. Winding is not trusted, so the outward side is the one away from the floor.
+	static void FindLedges(const TArray<ParkourBake::FTriangle>& Triangles, const FBakeSettings& Settings, TArray<FParkourLedgeRecord>& OutLedges)
+	{
+		TMap<FEdgeKey, TArray<int32>> FloorEdges;
+		TMap<FIntPoint, TArray<int32>> FloorCells;
+		for (int32 Index = 0; Index < Triangles.Num(); Index++)
+		{
+			const ParkourBake::FTriangle& Tri = Triangles[Index];
+			if (FMath::Abs(Tri.GetUnorientedNormal().Z) >= Settings.WalkableFloorZ)
+			{
+				FloorEdges.FindOrAdd(MakeEdgeKey(Tri.A, Tri.B, Settings.WeldTolerance)).Add(Index);
+				FloorEdges.FindOrAdd(MakeEdgeKey(Tri.B, Tri.C, Settings.WeldTolerance)).Add(Index);
+				FloorEdges.FindOrAdd(MakeEdgeKey(Tri.C, Tri.A, Settings.WeldTolerance)).Add(Index);
+
+				FBox2D Bounds(ForceInit);
+				Bounds += FVector2D(Tri.A);
+				Bounds += FVector2D(Tri.B);
+				Bounds += FVector2D(Tri.C);
+				for (int32 CellY = FMath::FloorToInt(Bounds.Min.Y / Settings.CellSize); CellY <= FMath::FloorToInt(Bounds.Max.Y / Settings.CellSize); CellY++)
+				{
+					for (int32 CellX = FMath::FloorToInt(Bounds.Min.X / Settings.CellSize); CellX <= FMath::FloorToInt(Bounds.Max.X / Settings.CellSize); CellX++)
+					{
+						FloorCells.FindOrAdd(FIntPoint(CellX, CellY)).Add(Index);
+					}
+				}
+			}
+		}
+
+		auto AddLedge = [&OutLedges, &Settings](const FVector& LipStart, const FVector& LipEnd, const FVector2D& Outward, const ParkourBake::FTriangle& Floor, float GroundZ)
+		{
+			const FVector LipMid = 0.5 * (LipStart + LipEnd);
+			float FloorDepth = 0.0f;
+			for (const FVector& Corner : { Floor.A, Floor.B, Floor.C })
+			{
+				FloorDepth = FMath::Max(FloorDepth, (float)-FVector2D::DotProduct(FVector2D(Corner - LipMid), Outward));
+			}
+
+			FParkourLedgeRecord Ledge = {};
+			Ledge.LipStart[0] = LipStart.X;
+			Ledge.LipStart[1] = LipStart.Y;
+			Ledge.LipStart[2] = LipStart.Z;
+			Ledge.LipEnd[0] = LipEnd.X;
+			Ledge.LipEnd[1] = LipEnd.Y;
+			Ledge.LipEnd[2] = LipEnd.Z;
+			Ledge.WallNormal[0] = Outward.X;
+			Ledge.WallNormal[1] = Outward.Y;
+			Ledge.FloorDepth = FloorDepth;
+			Ledge.GroundZ = GroundZ;
+			Ledge.Flags = (LipMid.Z - GroundZ <= Settings.MantleHeight) ? FParkourLedgeRecord::FLAG_QUICKMANTLE : 0;
+			OutLedges.Add(Ledge);
+		};
+
+		for (const ParkourBake::FTriangle& Wall : Triangles)
+		{
+			const FVector WallNormal = Wall.GetUnorientedNormal();
+			if (!FParkourSimRules::IsWallRunnableNormal(WallNormal.Z))
+			{
+				continue;
+			}
+			const FVector2D WallNormal2D = FVector2D(WallNormal.X, WallNormal.Y).GetSafeNormal();
+
+			const FVector Corners[3] = { Wall.A, Wall.B, Wall.C };
+			for (int32 Edge = 0; Edge < 3; Edge++)
+			{
+				const FVector& LipStart = Corners[Edge];
+				const FVector& LipEnd = Corners[(Edge + 1) % 3];
+				const FVector& Below = Corners[(Edge + 2) % 3];
+				const FVector LipMid = 0.5 * (LipStart + LipEnd);
+				if (FMath::Abs(LipStart.Z - LipEnd.Z) > Settings.WeldTolerance or LipMid.Z - Below.Z < Settings.MinWallHeight)
+				{
+					continue;
+				}
+
+				if (const TArray<int32>* Floors = FloorEdges.Find(MakeEdgeKey(LipStart, LipEnd, Settings.WeldTolerance)))
+				{
+					for (int32 FloorIndex : *Floors)
+					{
+						const ParkourBake::FTriangle& Floor = Triangles[FloorIndex];
+						const FVector FloorCentroid = (Floor.A + Floor.B + Floor.C) / 3.0;
+						const FVector2D Outward = (FVector2D::DotProduct(FVector2D(FloorCentroid - LipMid), WallNormal2D) > 0.0) ? -WallNormal2D : WallNormal2D;
+						AddLedge(LipStart, LipEnd, Outward, Floor, Below.Z);
+					}
+					continue;
+				}
+
+				//No floor shares the edge, look for one from another mesh on either side of it
+				const double MinZ = LipMid.Z - Settings.LipFloorTolerance;
+				const double MaxZ = LipMid.Z + Settings.LipFloorTolerance;
+				int32 FloorFront, FloorBack;
+				double FrontZ = 0.0, BackZ = 0.0;
+				const bool bFront = FindFloorUnder(Triangles, FloorCells, Settings.CellSize, FVector2D(LipMid) + WallNormal2D * Settings.LipProbeInset, MinZ, MaxZ, FloorFront, FrontZ);
+				const bool bBack = FindFloorUnder(Triangles, FloorCells, Settings.CellSize, FVector2D(LipMid) - WallNormal2D * Settings.LipProbeInset, MinZ, MaxZ, FloorBack, BackZ);
+				//Floor on both sides is the middle of a floor, on neither the middle of a wall
+				if (bFront == bBack)
+				{
+					continue;
+				}
+				const double FloorZ = bFront ? FrontZ : BackZ;
+				if (FloorZ - Below.Z < Settings.MinWallHeight)
+				{
+					continue;
+				}
+				//The lip is where the mantle lands, on top of the floor rather than the wall under it
+				const FVector Lift(0.0, 0.0, FloorZ - LipMid.Z);
+				AddLedge(LipStart + Lift, LipEnd + Lift, bFront ? -WallNormal2D : WallNormal2D, Triangles[bFront ? FloorFront : FloorBack], Below.Z);
+			}
+		}
+	}
+
+	static void GetLedgeBounds(const FParkourLedgeRecord& Ledge, float Margin, FBox2D& OutBounds)
+	{
+		const FVector2D Start(Ledge.LipStart[0], Ledge.LipStart[1]);
+		const FVector2D End(Ledge.LipEnd[0], Ledge.LipEnd[1]);
+		const FVector2D Inward = -FVector2D(Ledge.WallNormal[0], Ledge.WallNormal[1]) * Ledge.FloorDepth;
+		OutBounds = FBox2D(ForceInit);
+		OutBounds += Start;
+		OutBounds += End;
+		OutBounds += Start + Inward;
+		OutBounds += End + Inward;
+		OutBounds = OutBounds.ExpandBy(Margin);
+	}
+
+	static void WriteBlob(const TArray<FParkourLedgeRecord>& Ledges, const FBakeSettings& Settings, bool bCoversStaticGeometry, TArray<uint8>& OutBlob)
+	{
+		FBox2D Bounds(ForceInit);
+		for (const FParkourLedgeRecord& Ledge : Ledges)
+		{
+			FBox2D LedgeBounds;
+			GetLedgeBounds(Ledge, Settings.ProbeMargin, LedgeBounds);
+			Bounds += LedgeBounds;
+		}
+		if (!Bounds.bIsValid)
+		{
+			Bounds = FBox2D(FVector2D::ZeroVector, FVector2D::ZeroVector);
+		}
+
+		FParkourLedgeBlobHeader Header = {};
+		Header.Magic = FParkourLedgeBlobHeader::ExpectedMagic;
+		Header.Version = FParkourLedgeBlobHeader::CurrentVersion;
+		Header.NumLedges = Ledges.Num();
+		Header.CellSize = Settings.CellSize;
+		Header.OriginX = Bounds.Min.X;
+		Header.OriginY = Bounds.Min.Y;
+		Header.GridSizeX = FMath::FloorToInt(Bounds.GetSize().X / Settings.CellSize) + 1;
+		Header.GridSizeY = FMath::FloorToInt(Bounds.GetSize().Y / Settings.CellSize) + 1;
+		Header.BakedMantleHeight = Settings.MantleHeight;
+		Header.ProbeMargin = Settings.ProbeMargin;
+		Header.Flags = bCoversStaticGeometry ? FParkourLedgeBlobHeader::FLAG_COVERSSTATIC : 0;
+		const int32 NumCells = Header.GridSizeX * Header.GridSizeY;
+
+		//Count, prefix sum, then fill so the cell lists are one flat array
+		auto ForEachCell = [&Header, &Settings](const FParkourLedgeRecord& Ledge, TFunctionRef<void(int32)> Visit)
+		{
+			FBox2D LedgeBounds;
+			GetLedgeBounds(Ledge, Settings.ProbeMargin, LedgeBounds);
+			const int32 MinX = FMath::Clamp(FMath::FloorToInt((LedgeBounds.Min.X - Header.OriginX) / Header.CellSize), 0, Header.GridSizeX - 1);
+			const int32 MinY = FMath::Clamp(FMath::FloorToInt((LedgeBounds.Min.Y - Header.OriginY) / Header.CellSize), 0, Header.GridSizeY - 1);
+			const int32 MaxX = FMath::Clamp(FMath::FloorToInt((LedgeBounds.Max.X - Header.OriginX) / Header.CellSize), 0, Header.GridSizeX - 1);
+			const int32 MaxY = FMath::Clamp(FMath::FloorToInt((LedgeBounds.Max.Y - Header.OriginY) / Header.CellSize), 0, Header.GridSizeY - 1);
+			for (int32 CellY = MinY; CellY <= MaxY; CellY++)
+			{
+				for (int32 CellX = MinX; CellX <= MaxX; CellX++)
+				{
+					Visit(CellY * Header.GridSizeX + CellX);
+				}
+			}
+		};
+		TArray<uint32> CellStarts;
+		CellStarts.SetNumZeroed(NumCells + 1);
+		for (const FParkourLedgeRecord& Ledge : Ledges)
+		{
+			ForEachCell(Ledge, [&CellStarts](int32 Cell) { CellStarts[Cell + 1]++; });
+		}
+		for (int32 Cell = 0; Cell < NumCells; Cell++)
+		{
+			CellStarts[Cell + 1] += CellStarts[Cell];
+		}
+		TArray<uint32> Fill(CellStarts);
+		TArray<uint32> CellLedges;
+		CellLedges.SetNumUninitialized(CellStarts.Last());
+		for (int32 Index = 0; Index < Ledges.Num(); Index++)
+		{
+			ForEachCell(Ledges[Index], [&CellLedges, &Fill, Index](int32 Cell) { CellLedges[Fill[Cell]++] = Index; });
+		}
+
+		Header.CellStartsOffset = sizeof(FParkourLedgeBlobHeader);
+		Header.CellLedgesOffset = Header.CellStartsOffset + CellStarts.Num() * sizeof(uint32);
+		Header.LedgesOffset = Align(Header.CellLedgesOffset + CellLedges.Num() * sizeof(uint32), alignof(FParkourLedgeRecord));
+		Header.FileSize = Header.LedgesOffset + Ledges.Num() * sizeof(FParkourLedgeRecord);
+
+		OutBlob.SetNumZeroed(Header.FileSize);
+		FMemory::Memcpy(OutBlob.GetData(), &Header, sizeof(Header));
+		FMemory::Memcpy(OutBlob.GetData() + Header.CellStartsOffset, CellStarts.GetData(), CellStarts.Num() * sizeof(uint32));
+		FMemory::Memcpy(OutBlob.GetData() + Header.CellLedgesOffset, CellLedges.GetData(), CellLedges.Num() * sizeof(uint32));
+		FMemory::Memcpy(OutBlob.GetData() + Header.LedgesOffset, Ledges.GetData(), Ledges.Num() * sizeof(FParkourLedgeRecord));
+	}
+}
+#endif
+
+UParkourLedgeDatabaseCommandlet::UParkourLedgeDatabaseCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UParkourLedgeDatabaseCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	using namespace ParkourLedgeBake;
+
+	FString MapName;
+	if (!FParse::Value(*Params, TEXT("Map="), MapName))
+	{
+		UE_LOG(LogTemp, Error, TEXT("ParkourLedgeDatabase: missing -Map=/Game/Path/To/Map"));
+		return 1;
+	}
+	FBakeSettings Settings;
+	FParse::Value(*Params, TEXT("CellSize="), Settings.CellSize);
+	FParse::Value(*Params, TEXT("MantleHeight="), Settings.MantleHeight);
+	FParse::Value(*Params, TEXT("WalkableFloorZ="), Settings.WalkableFloorZ);
+	FParse::Value(*Params, TEXT("ProbeMargin="), Settings.ProbeMargin);
+	Settings.CellSize = FMath::Max(Settings.CellSize, 1.0f);
+
+	UWorld* World = ParkourBake::LoadMap(MapName);
+	if (World == nullptr)
+	{
+		return 1;
+	}
+
+	TArray<ParkourBake::FTriangle> Triangles;
+	int32 NumComponents = ParkourBake::CollectStaticTriangles(World, Triangles);
+	const bool bCoversStaticGeometry = ParkourBake::CoversStaticGeometry(World);
+	TArray<FParkourLedgeRecord> Ledges;
+	FindLedges(Triangles, Settings, Ledges);
+
+	TArray<uint8> Blob;
+	WriteBlob(Ledges, Settings, bCoversStaticGeometry, Blob);
+	const FString FileName = FParkourLedgeDatabase::GetDatabasePath(World->GetOutermost()->GetName());
+	if (!FFileHelper::SaveArrayToFile(Blob, *FileName))
+	{
+		UE_LOG(LogTemp, Error, TEXT("ParkourLedgeDatabase: failed to save %s"), *FileName);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("ParkourLedgeDatabase: %d ledges from %d static mesh components, %s, %d bytes -> %s"),
+		Ledges.Num(), NumComponents, bCoversStaticGeometry ? TEXT("covers all static geometry") : TEXT("partial static coverage"), Blob.Num(), *FileName);
+	return 0;
+#else
+	return 1;
+#endif
+}
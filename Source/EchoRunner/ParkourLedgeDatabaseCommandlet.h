@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ParkourLedgeDatabaseCommandlet.generated.h"
+
+//Bakes the ledge lips of a map's static geometry into the flat blob read by FParkourLedgeDatabase.
+//UnrealEditor-Cmd EchoRunner.uproject -run=ParkourLedgeDatabase -Map=/Game/FirstPerson/Maps/Sandbox
+//	[-CellSize=400] [-MantleHeight=44] [-WalkableFloorZ=0.71] [-ProbeMargin=32]
+UCLASS()
+class ECHORUNNER_API UParkourLedgeDatabaseCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UParkourLedgeDatabaseCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
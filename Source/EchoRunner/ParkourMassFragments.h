@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTypes.h"
+#include "ParkourComponent.h"
+#include "ParkourSim.h"
+#include "ParkourMassFragments.generated.h"
+
+//Fragments for Mass-simulated runners. Actor-backed characters keep using UParkourComponent.
+
+namespace ParkourMass
+{
+	class FRunner;
+}
+
+//Movement state the runner integrates and the parkour state mirrored out of its FParkourSim after every step
+USTRUCT()
+struct ECHORUNNER_API FParkourMassStateFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	EParkourMode CurrentParkourMode = EParkourMode::NONE;
+	EParkourMode PrevParkourMode = EParkourMode::NONE;
+	int32 TimesJumped = 0;
+
+	EParkourSimMovementMode MovementMode = EParkourSimMovementMode::WALKING;
+	bool bCrouched = false;
+	float GravityScale = 1.0f;
+	float GroundFriction = 8.0f;
+	float MaxWalkSpeed = 600.0f;
+};
+
+//The runner's FParkourSim and its scene query requests and results, created by UParkourMassProcessor
+USTRUCT()
+struct ECHORUNNER_API FParkourMassSimFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	TSharedPtr<ParkourMass::FRunner> Runner;
+};
+
+//Written by AI or gameplay code, consumed by UParkourMassProcessor
+USTRUCT()
+struct ECHORUNNER_API FParkourMassInputFragment : public FMassFragment
+{
+	GENERATED_BODY()
+
+	enum EEvent : uint8
+	{
+		EVENT_JUMP = 1 << 0,
+		EVENT_SPRINT = 1 << 1,
+		EVENT_CROUCHSLIDE = 1 << 2,
+		EVENT_DASH = 1 << 3
+	};
+
+	FVector MoveInput = FVector::ZeroVector;
+	uint8 PendingEvents = 0;
+};
+
+//Tunables shared by every runner spawned from the same trait. The parkour rules take theirs from ParkourComponentClass,
+//the rest stand in for the character's capsule and CharacterMovement settings.
+USTRUCT()
+struct ECHORUNNER_API FParkourMassConfigFragment : public FMassConstSharedFragment
+{
+	GENERATED_BODY()
+
+	//Class default whose wall-run, mantle, sprint, slide, dash and jump tunables the runners use
+	UPROPERTY(EditAnywhere, Category = "Parkour")
+	TSubclassOf<UParkourComponent> ParkourComponentClass;
+
+	UPROPERTY(EditAnywhere, Category = "Capsule")
+	float CapsuleRadius = 34.0f;
+	UPROPERTY(EditAnywhere, Category = "Capsule")
+	float CapsuleHalfHeight = 96.0f;
+	UPROPERTY(EditAnywhere, Category = "Capsule")
+	float CrouchedHalfHeight = 44.0f;
+	UPROPERTY(EditAnywhere, Category = "Capsule")
+	float EyeHeight = 64.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Movement")
+	float WalkSpeed = 600.0f;
+	UPROPERTY(EditAnywhere, Category = "Movement")
+	float JumpZVelocity = 700.0f;
+	UPROPERTY(EditAnywhere, Category = "Movement")
+	float GravityScale = 1.0f;
+	UPROPERTY(EditAnywhere, Category = "Movement")
+	float GroundFriction = 8.0f;
+	//Cosine of the steepest floor the runners can land on, CharacterMovement's default 44.76 degrees
+	UPROPERTY(EditAnywhere, Category = "Movement")
+	float WalkableFloorZ = 0.71f;
+	//Deceleration on top of friction while sliding
+	UPROPERTY(EditAnywhere, Category = "Slide")
+	float SlideBrakingDeceleration = 1000.0f;
+
+	//The rules' tunables, UParkourComponent's defaults when no class is set
+	FParkourSimConfig GetSimConfig() const
+	{
+		const UParkourComponent* Defaults = ParkourComponentClass ? ParkourComponentClass->GetDefaultObject<UParkourComponent>() : GetDefault<UParkourComponent>();
+		return Defaults->GetSimConfig();
+	}
+};
@@ -0,0 +1,346 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourMassProcessor.h"
+#include "MassCommonFragments.h"
+#include "MassCommonTypes.h"
+#include "MassExecutionContext.h"
+#include "MassMovementFragments.h"
+#include "Engine/World.h"
+#include "ParkourMassFragments.h"
+#include "ParkourSim.h"
+
+namespace ParkourMass
+{
+	//Furthest a queued query's segment ends may have moved and still answer this frame's request, a dash covers about 35 units a frame
+	constexpr float QueryMatchDistance = 64.0f;
+
+	static FParkourSimVector ToSim(const FVector& Vector)
+	{
+		return FParkourSimVector((float)Vector.X, (float)Vector.Y, (float)Vector.Z);
+	}
+
+	static FVector FromSim(const FParkourSimVector& Vector)
+	{
+		return FVector(Vector.X, Vector.Y, Vector.Z);
+	}
+
+	//One Mass runner: its FParkourSim, the movement the sim drives and the scene queries it asked for.
+	//Step runs in the parallel pass and answers queries from the previous frame's results, RunQueries issues
+	//the requests it queued on the game thread. The rules see the same one frame latency as ASYNC probes.
+	class FRunner : public IParkourSimWorld, public IParkourSimMovement
+	{
+	public:
+		explicit FRunner(const FParkourSimConfig& SimConfig)
+			: Sim(*this, *this, SimConfig)
+		{
+		}
+
+		void Step(FTransform& InTransform, FVector& InVelocity, FParkourMassStateFragment& InState, FParkourMassInputFragment& Input,
+			const FParkourMassConfigFragment& InConfig, float GravityZ, float DeltaTime)
+		{
+			Transform = &InTransform;
+			Velocity = &InVelocity;
+			State = &InState;
+			Config = &InConfig;
+			MoveInput = Input.MoveInput;
+
+			const uint8 Events = Input.PendingEvents;
+			Input.PendingEvents = 0;
+			if (Events & FParkourMassInputFragment::EVENT_JUMP)
+			{
+				Sim.JumpEvent();
+			}
+			if (Events & FParkourMassInputFragment::EVENT_SPRINT)
+			{
+				Sim.SprintEvent();
+			}
+			if (Events & FParkourMassInputFragment::EVENT_CROUCHSLIDE)
+			{
+				Sim.CrouchSlideEvent();
+			}
+			if (Events & FParkourMassInputFragment::EVENT_DASH)
+			{
+				Sim.DashEvent();
+			}
+			Sim.Update(DeltaTime);
+			Integrate(GravityZ, DeltaTime);
+
+			const EParkourMode Mode = (EParkourMode)Sim.GetMode();
+			if (Mode != State->CurrentParkourMode)
+			{
+				State->PrevParkourMode = State->CurrentParkourMode;
+				State->CurrentParkourMode = Mode;
+			}
+			State->TimesJumped = Sim.GetTimesJumped();
+
+			Transform = nullptr;
+			Velocity = nullptr;
+			State = nullptr;
+			Config = nullptr;
+		}
+
+		void RunQueries(const UWorld& World)
+		{
+			Results.Reset();
+			for (FQuery& Query : Requests)
+			{
+				FHitResult Hit;
+				const bool bHit = (Query.Radius > 0.0f)
+					? World.SweepSingleByChannel(Hit, FromSim(Query.Start), FromSim(Query.End), FQuat::Identity, ECC_Visibility, FCollisionShape::MakeCapsule(Query.Radius, Query.HalfHeight))
+					: World.LineTraceSingleByChannel(Hit, FromSim(Query.Start), FromSim(Query.End), ECC_Visibility);
+				Query.Hit = FParkourSimHit();
+				Query.Hit.bBlockingHit = bHit;
+				if (bHit)
+				{
+					Query.Hit.Location = ToSim(Hit.Location);
+					Query.Hit.ImpactPoint = ToSim(Hit.ImpactPoint);
+					Query.Hit.Normal = ToSim(Hit.Normal);
+					Query.Hit.Distance = Hit.Distance;
+				}
+				Results.Add(Query);
+			}
+			Requests.Reset();
+		}
+
+		virtual bool LineTrace(const FParkourSimVector& Start, const FParkourSimVector& End, FParkourSimHit& OutHit) override
+		{
+			return Query(Start, End, 0.0f, 0.0f, OutHit);
+		}
+
+		virtual bool SweepCapsule(const FParkourSimVector& Start, const FParkourSimVector& End, float Radius, float HalfHeight, FParkourSimHit& OutHit) override
+		{
+			return Query(Start, End, Radius, HalfHeight, OutHit);
+		}
+
+		virtual FParkourSimVector GetLocation() const override { return ToSim(Transform->GetLocation()); }
+		virtual void SetLocation(const FParkourSimVector& Location) override { Transform->SetLocation(FromSim(Location)); }
+		virtual FParkourSimVector GetForward() const override { return ToSim(Transform->GetRotation().GetForwardVector()); }
+		virtual FParkourSimVector GetRight() const override { return ToSim(Transform->GetRotation().GetRightVector()); }
+		virtual FParkourSimVector GetEyes() const override { return GetLocation() + FParkourSimVector(0.0f, 0.0f, Config->EyeHeight); }
+		virtual FParkourSimVector GetVelocity() const override { return ToSim(*Velocity); }
+		virtual FParkourSimVector GetLastInput() const override { return ToSim(MoveInput); }
+		virtual float GetCapsuleRadius() const override { return Config->CapsuleRadius; }
+		virtual float GetCapsuleHalfHeight() const override { return State->bCrouched ? Config->CrouchedHalfHeight : Config->CapsuleHalfHeight; }
+		virtual float GetJumpZVelocity() const override { return Config->JumpZVelocity; }
+
+		virtual EParkourSimMovementMode GetMovementMode() const override { return State->MovementMode; }
+		virtual void SetMovementMode(EParkourSimMovementMode NewMode) override
+		{
+			if (State->MovementMode != NewMode)
+			{
+				const EParkourSimMovementMode PrevMode = State->MovementMode;
+				State->MovementMode = NewMode;
+				Sim.MovementChanged(PrevMode, NewMode);
+			}
+		}
+		virtual bool IsWalkable(const FParkourSimHit& Hit) const override { return Hit.Normal.Z > Config->WalkableFloorZ; }
+
+		//Applied by the next Integrate, as CharacterMovement applies a launch on its next tick
+		virtual void Launch(const FParkourSimVector& LaunchVelocity, bool bXYOverride, bool bZOverride) override
+		{
+			PendingLaunch = FromSim(LaunchVelocity);
+			bPendingLaunch = true;
+			bPendingXYOverride = bXYOverride;
+			bPendingZOverride = bZOverride;
+		}
+		virtual void StopMovement() override
+		{
+			SetMovementMode(EParkourSimMovementMode::NONE);
+			*Velocity = FVector::ZeroVector;
+			bPendingLaunch = false;
+		}
+		virtual float GetGravityScale() const override { return State->GravityScale; }
+		virtual void SetGravityScale(float Scale) override { State->GravityScale = Scale; }
+		virtual void SetGroundFriction(float Friction) override { State->GroundFriction = Friction; }
+		virtual void SetMaxWalkSpeed(float Speed) override { State->MaxWalkSpeed = Speed; }
+		virtual void SetCrouched(bool bCrouched) override { State->bCrouched = bCrouched; }
+		virtual void BeginSlide(const FParkourSimVector& Impulse) override { *Velocity += FromSim(Impulse); }
+		virtual void RestoreDefaults() override
+		{
+			State->GravityScale = Config->GravityScale;
+			State->GroundFriction = Config->GroundFriction;
+			State->MaxWalkSpeed = Config->WalkSpeed;
+		}
+
+	private:
+		struct FQuery
+		{
+			FParkourSimVector Start;
+			FParkourSimVector End;
+			//0 for a line trace
+			float Radius = 0.0f;
+			float HalfHeight = 0.0f;
+			FParkourSimHit Hit;
+		};
+
+		//Queues the query for RunQueries and answers with last frame's closest matching one, a miss when there is none
+		bool Query(const FParkourSimVector& Start, const FParkourSimVector& End, float Radius, float HalfHeight, FParkourSimHit& OutHit)
+		{
+			FQuery& Request = Requests.AddDefaulted_GetRef();
+			Request.Start = Start;
+			Request.End = End;
+			Request.Radius = Radius;
+			Request.HalfHeight = HalfHeight;
+
+			const FQuery* Best = nullptr;
+			float BestDistanceSq = QueryMatchDistance * QueryMatchDistance;
+			for (const FQuery& Result : Results)
+			{
+				if (Result.Radius != Radius or Result.HalfHeight != HalfHeight)
+				{
+					continue;
+				}
+				const float DistanceSq = FMath::Max((Result.Start - Start).SizeSquared(), (Result.End - End).SizeSquared());
+				if (DistanceSq <= BestDistanceSq)
+				{
+					Best = &Result;
+					BestDistanceSq = DistanceSq;
+				}
+			}
+			OutHit = Best ? Best->Hit : FParkourSimHit();
+			return OutHit.bBlockingHit;
+		}
+
+		void Integrate(float GravityZ, float DeltaTime)
+		{
+			if (bPendingLaunch)
+			{
+				Velocity->X = bPendingXYOverride ? PendingLaunch.X : Velocity->X + PendingLaunch.X;
+				Velocity->Y = bPendingXYOverride ? PendingLaunch.Y : Velocity->Y + PendingLaunch.Y;
+				Velocity->Z = bPendingZOverride ? PendingLaunch.Z : Velocity->Z + PendingLaunch.Z;
+				bPendingLaunch = false;
+				if (Velocity->Z > 0.0f)
+				{
+					SetMovementMode(EParkourSimMovementMode::FALLING);
+				}
+			}
+
+			//Ledge hangs and mantles are placed by the sim
+			if (State->MovementMode == EParkourSimMovementMode::WALKING)
+			{
+				if (Sim.GetMode() == EParkourSimMode::SLIDE)
+				{
+					//Braking as CharacterMovement applies it without input, friction scaled by speed plus the slide deceleration
+					const float Braking = State->GroundFriction * Velocity->Size() + Config->SlideBrakingDeceleration;
+					*Velocity = FMath::VInterpConstantTo(*Velocity, FVector::ZeroVector, DeltaTime, Braking);
+				}
+				else
+				{
+					const FVector Input = MoveInput.GetClampedToMaxSize(1.0f);
+					*Velocity = FVector(Input.X, Input.Y, 0.0f) * State->MaxWalkSpeed;
+				}
+			}
+			else if (State->MovementMode == EParkourSimMovementMode::FALLING)
+			{
+				Velocity->Z += GravityZ * State->GravityScale * DeltaTime;
+			}
+			else
+			{
+				return;
+			}
+
+			const FVector Location = Transform->GetLocation();
+			FVector NewLocation = Location + *Velocity * DeltaTime;
+			if (State->MovementMode == EParkourSimMovementMode::FALLING and Velocity->Z <= 0.0f)
+			{
+				//Only descending runners probe for the floor. The answer arrives a frame late, so the probe reaches a
+				//frame further down and the runner only lands once this frame's move would take it through the floor.
+				FParkourSimHit FloorHit;
+				const FVector FloorEnd = NewLocation + *Velocity * DeltaTime - FVector(0.0f, 0.0f, GetCapsuleHalfHeight());
+				if (LineTrace(ToSim(Location), ToSim(FloorEnd), FloorHit) and IsWalkable(FloorHit) and FloorHit.ImpactPoint.Z + GetCapsuleHalfHeight() >= NewLocation.Z)
+				{
+					NewLocation.Z = FloorHit.ImpactPoint.Z + GetCapsuleHalfHeight();
+					Velocity->Z = 0.0f;
+					//Forwarded like the character Blueprint forwards CharacterMovement's landing
+					SetMovementMode(EParkourSimMovementMode::WALKING);
+					Sim.LandEvent();
+				}
+			}
+			Transform->SetLocation(NewLocation);
+		}
+
+		FParkourSim Sim;
+
+		//Fragments of the entity being stepped, only set inside Step
+		FTransform* Transform = nullptr;
+		FVector* Velocity = nullptr;
+		FParkourMassStateFragment* State = nullptr;
+		const FParkourMassConfigFragment* Config = nullptr;
+		FVector MoveInput = FVector::ZeroVector;
+
+		FVector PendingLaunch = FVector::ZeroVector;
+		bool bPendingLaunch = false;
+		bool bPendingXYOverride = false;
+		bool bPendingZOverride = false;
+
+		TArray<FQuery, TInlineAllocator<6>> Requests;
+		TArray<FQuery, TInlineAllocator<6>> Results;
+	};
+}
+
+UParkourMassProcessor::UParkourMassProcessor()
+	: EntityQuery(*this)
+{
+	bAutoRegisterWithProcessingPhases = true;
+	ExecutionFlags = (int32)EProcessorExecutionFlags::All;
+	ProcessingPhase = EMassProcessingPhase::PrePhysics;
+	ExecutionOrder.ExecuteBefore.Add(UE::Mass::ProcessorGroupNames::Movement);
+}
+
+void UParkourMassProcessor::ConfigureQueries()
+{
+	EntityQuery.AddRequirement<FTransformFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FMassVelocityFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FParkourMassStateFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FParkourMassSimFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddRequirement<FParkourMassInputFragment>(EMassFragmentAccess::ReadWrite);
+	EntityQuery.AddConstSharedRequirement<FParkourMassConfigFragment>();
+}
+
+void UParkourMassProcessor::Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context)
+{
+	//Chunks only touch their own fragments and the runners answer their queries from last frame, so chunks run in parallel
+	EntityQuery.ParallelForEachEntityChunk(EntityManager, Context, [](FMassExecutionContext& Context)
+	{
+		const UWorld* World = Context.GetWorld();
+		check(World);
+		const int32 NumEntities = Context.GetNumEntities();
+		const float DeltaTime = Context.GetDeltaTimeSeconds();
+		const float GravityZ = World->GetGravityZ();
+		const FParkourMassConfigFragment& Config = Context.GetConstSharedFragment<FParkourMassConfigFragment>();
+		const TArrayView<FTransformFragment> Transforms = Context.GetMutableFragmentView<FTransformFragment>();
+		const TArrayView<FMassVelocityFragment> Velocities = Context.GetMutableFragmentView<FMassVelocityFragment>();
+		const TArrayView<FParkourMassStateFragment> States = Context.GetMutableFragmentView<FParkourMassStateFragment>();
+		const TArrayView<FParkourMassSimFragment> Sims = Context.GetMutableFragmentView<FParkourMassSimFragment>();
+		const TArrayView<FParkourMassInputFragment> Inputs = Context.GetMutableFragmentView<FParkourMassInputFragment>();
+
+		for (int32 Index = 0; Index < NumEntities; Index++)
+		{
+			//Created by the query pass on a runner's first frame
+			if (ParkourMass::FRunner* Runner = Sims[Index].Runner.Get())
+			{
+				Runner->Step(Transforms[Index].GetMutableTransform(), Velocities[Index].Value, States[Index], Inputs[Index], Config, GravityZ, DeltaTime);
+			}
+		}
+	});
+
+	//Scene queries the steps asked for run here on the game thread, their results answer next frame's steps
+	EntityQuery.ForEachEntityChunk(EntityManager, Context, [](FMassExecutionContext& Context)
+	{
+		const UWorld* World = Context.GetWorld();
+		check(World);
+		const int32 NumEntities = Context.GetNumEntities();
+		const TArrayView<FParkourMassSimFragment> Sims = Context.GetMutableFragmentView<FParkourMassSimFragment>();
+		for (int32 Index = 0; Index < NumEntities; Index++)
+		{
+			TSharedPtr<ParkourMass::FRunner>& Runner = Sims[Index].Runner;
+			if (!Runner)
+			{
+				//The component class default is only read here on the game thread
+				Runner = MakeShared<ParkourMass::FRunner>(Context.GetConstSharedFragment<FParkourMassConfigFragment>().GetSimConfig());
+				continue;
+			}
+			Runner->RunQueries(*World);
+		}
+	});
+}
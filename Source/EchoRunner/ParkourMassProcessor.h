@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassProcessor.h"
+#include "MassEntityQuery.h"
+#include "ParkourMassProcessor.generated.h"
+
+//Steps each Mass runner's FParkourSim with its UParkourComponent class's tunables, one parallel task per archetype chunk,
+//then issues the scene queries the steps asked for on the game thread
+UCLASS()
+class ECHORUNNER_API UParkourMassProcessor : public UMassProcessor
+{
+	GENERATED_BODY()
+
+public:
+	UParkourMassProcessor();
+
+protected:
+	virtual void ConfigureQueries() override;
+	virtual void Execute(FMassEntityManager& EntityManager, FMassExecutionContext& Context) override;
+
+	FMassEntityQuery EntityQuery;
+};
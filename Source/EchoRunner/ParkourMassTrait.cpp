@@ -0,0 +1,25 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourMassTrait.h"
+#include "MassEntityTemplateRegistry.h"
+#include "MassEntityUtils.h"
+#include "MassCommonFragments.h"
+#include "MassMovementFragments.h"
+
+void UParkourMassTrait::BuildTemplate(FMassEntityTemplateBuildContext& BuildContext, const UWorld& World) const
+{
+	FMassEntityManager& EntityManager = UE::Mass::Utils::GetEntityManagerChecked(World);
+
+	BuildContext.RequireFragment<FTransformFragment>();
+	BuildContext.RequireFragment<FMassVelocityFragment>();
+
+	FParkourMassStateFragment& State = BuildContext.AddFragment_GetRef<FParkourMassStateFragment>();
+	State.MaxWalkSpeed = Config.WalkSpeed;
+	State.GroundFriction = Config.GroundFriction;
+	State.GravityScale = Config.GravityScale;
+	BuildContext.AddFragment<FParkourMassSimFragment>();
+	BuildContext.AddFragment<FParkourMassInputFragment>();
+
+	const FConstSharedStruct ConfigFragment = EntityManager.GetOrCreateConstSharedFragment(Config);
+	BuildContext.AddConstSharedFragment(ConfigFragment);
+}
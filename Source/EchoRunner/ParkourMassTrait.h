@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MassEntityTraitBase.h"
+#include "ParkourMassFragments.h"
+#include "ParkourMassTrait.generated.h"
+
+//Adds the parkour fragments to a Mass entity config so UParkourMassProcessor picks the entity up
+UCLASS(meta = (DisplayName = "Parkour Runner"))
+class ECHORUNNER_API UParkourMassTrait : public UMassEntityTraitBase
+{
+	GENERATED_BODY()
+
+protected:
+	virtual void BuildTemplate(FMassEntityTemplateBuildContext& BuildContext, const UWorld& World) const override;
+
+	UPROPERTY(EditAnywhere, Category = "Parkour")
+	FParkourMassConfigFragment Config;
+};
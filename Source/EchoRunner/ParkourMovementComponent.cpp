@@ -0,0 +1,660 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourMovementComponent.h"
+#include "GameFramework/Character.h"
+#include "Components/CapsuleComponent.h"
+#include "ParkourRootMotion.h"
+#include "ParkourSim.h"
+
+static_assert((uint8)EParkourCustomMovement::NONE == (uint8)EParkourSimPhysics::NONE
+	and (uint8)EParkourCustomMovement::WALLRUN == (uint8)EParkourSimPhysics::WALLRUN
+	and (uint8)EParkourCustomMovement::VERTICALWALLRUN == (uint8)EParkourSimPhysics::VERTICALWALLRUN
+	and (uint8)EParkourCustomMovement::LEDGEHANG == (uint8)EParkourSimPhysics::LEDGEHANG
+	and (uint8)EParkourCustomMovement::MANTLE == (uint8)EParkourSimPhysics::MANTLE,
+	"EParkourCustomMovement must mirror EParkourSimPhysics");
+
+void FSavedMove_Parkour::Clear()
+{
+	Super::Clear();
+	SavedParkourMode = 0;
+	SavedTimesJumped = 0;
+	bSavedWantsToDash = false;
+	bSavedHasLaunch = false;
+	bSavedLaunchXYOverride = false;
+	bSavedLaunchZOverride = false;
+	bSavedHasMantle = false;
+	SavedLaunchVelocity = FVector::ZeroVector;
+	SavedMantleTarget = FVector::ZeroVector;
+	SavedMantleSpeed = 0.0;
+	SavedWallNormal = FVector::ZeroVector;
+	SavedParkourPhysicsTime = 0.0;
+}
+
+uint8 FSavedMove_Parkour::GetCompressedFlags() const
+{
+	uint8 Result = Super::GetCompressedFlags();
+	if (bSavedWantsToDash)
+	{
+		Result |= FLAG_Custom_0;
+	}
+	return Result;
+}
+
+bool FSavedMove_Parkour::CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const
+{
+	const FSavedMove_Parkour* NewParkourMove = static_cast<const FSavedMove_Parkour*>(NewMove.Get());
+	if (SavedParkourMode != NewParkourMove->SavedParkourMode
+		or SavedTimesJumped != NewParkourMove->SavedTimesJumped
+		or bSavedWantsToDash or NewParkourMove->bSavedWantsToDash
+		or bSavedHasLaunch or NewParkourMove->bSavedHasLaunch
+		or bSavedHasMantle or NewParkourMove->bSavedHasMantle)
+	{
+		return false;
+	}
+	return Super::CanCombineWith(NewMove, InCharacter, MaxDelta);
+}
+
+void FSavedMove_Parkour::SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData)
+{
+	Super::SetMoveFor(C, InDeltaTime, NewAccel, ClientData);
+
+	UParkourMovementComponent* Movement = Cast<UParkourMovementComponent>(C->GetCharacterMovement());
+	if (Movement)
+	{
+		SavedParkourMode = Movement->ParkourMode;
+		SavedTimesJumped = Movement->ParkourTimesJumped;
+		bSavedWantsToDash = Movement->bWantsToDash;
+		bSavedHasLaunch = Movement->bHasPendingLaunch;
+		bSavedLaunchXYOverride = Movement->bPendingLaunchXYOverride;
+		bSavedLaunchZOverride = Movement->bPendingLaunchZOverride;
+		SavedLaunchVelocity = Movement->PendingParkourLaunch;
+		bSavedHasMantle = Movement->bHasPendingMantle;
+		SavedMantleTarget = Movement->PendingMantleTarget;
+		SavedMantleSpeed = Movement->PendingMantleSpeed;
+		SavedWallNormal = Movement->WallNormal;
+		SavedParkourPhysicsTime = Movement->ParkourPhysicsTime;
+	}
+}
+
+void FSavedMove_Parkour::PrepMoveFor(ACharacter* C)
+{
+	Super::PrepMoveFor(C);
+
+	//Restore the launch so a replayed move applies it again
+	UParkourMovementComponent* Movement = Cast<UParkourMovementComponent>(C->GetCharacterMovement());
+	if (Movement)
+	{
+		Movement->ParkourMode = SavedParkourMode;
+		Movement->ParkourTimesJumped = SavedTimesJumped;
+		Movement->bWantsToDash = bSavedWantsToDash;
+		Movement->bHasPendingLaunch = bSavedHasLaunch;
+		Movement->bPendingLaunchXYOverride = bSavedLaunchXYOverride;
+		Movement->bPendingLaunchZOverride = bSavedLaunchZOverride;
+		Movement->PendingParkourLaunch = SavedLaunchVelocity;
+		Movement->bHasPendingMantle = bSavedHasMantle;
+		Movement->PendingMantleTarget = SavedMantleTarget;
+		Movement->PendingMantleSpeed = SavedMantleSpeed;
+		Movement->WallNormal = SavedWallNormal;
+		Movement->ParkourPhysicsTime = SavedParkourPhysicsTime;
+	}
+}
+
+bool FSavedMove_Parkour::IsImportantMove(const FSavedMovePtr& LastAckedMove) const
+{
+	//The server only takes transitions the mode table allows from the mode it has, a lost mode change must be resent
+	const FSavedMove_Parkour* AckedMove = static_cast<const FSavedMove_Parkour*>(LastAckedMove.Get());
+	if (AckedMove and AckedMove->SavedParkourMode != SavedParkourMode)
+	{
+		return true;
+	}
+	return Super::IsImportantMove(LastAckedMove);
+}
+
+FSavedMovePtr FNetworkPredictionData_Client_Parkour::AllocateNewMove()
+{
+	return FSavedMovePtr(new FSavedMove_Parkour());
+}
+
+void FParkourNetworkMoveData::ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType)
+{
+	Super::ClientFillNetworkMoveData(ClientMove, MoveType);
+
+	const FSavedMove_Parkour& ParkourMove = static_cast<const FSavedMove_Parkour&>(ClientMove);
+	PackedParkourState = (ParkourMove.SavedParkourMode & MODE_MASK)
+		| ((FMath::Min<uint8>(ParkourMove.SavedTimesJumped, JUMPS_MASK) & JUMPS_MASK) << JUMPS_SHIFT)
+		| (ParkourMove.bSavedHasLaunch ? HAS_LAUNCH : 0);
+	LaunchFlags = (ParkourMove.bSavedLaunchXYOverride ? LAUNCH_XY_OVERRIDE : 0) | (ParkourMove.bSavedLaunchZOverride ? LAUNCH_Z_OVERRIDE : 0);
+	LaunchVelocity = ParkourMove.SavedLaunchVelocity;
+	bHasMantle = ParkourMove.bSavedHasMantle;
+	MantleTarget = ParkourMove.SavedMantleTarget;
+	MantleSpeed = ParkourMove.SavedMantleSpeed;
+}
+
+bool FParkourNetworkMoveData::Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType)
+{
+	Super::Serialize(CharacterMovement, Ar, PackageMap, MoveType);
+
+	Ar.SerializeBits(&PackedParkourState, 8);
+	if (PackedParkourState & HAS_LAUNCH)
+	{
+		bool bLocalSuccess = true;
+		LaunchVelocity.NetSerialize(Ar, PackageMap, bLocalSuccess);
+		Ar.SerializeBits(&LaunchFlags, 2);
+	}
+	Ar.SerializeBits(&bHasMantle, 1);
+	if (bHasMantle)
+	{
+		bool bLocalSuccess = true;
+		MantleTarget.NetSerialize(Ar, PackageMap, bLocalSuccess);
+		//Tenths, like the quantized vectors
+		uint16 QuantizedMantleSpeed = (uint16)FMath::Clamp(FMath::RoundToInt(MantleSpeed * 10.0f), 0, (int32)MAX_uint16);
+		Ar << QuantizedMantleSpeed;
+		MantleSpeed = QuantizedMantleSpeed / 10.0f;
+	}
+	return !Ar.IsError();
+}
+
+UParkourMovementComponent::UParkourMovementComponent()
+{
+	SetNetworkMoveDataContainer(ParkourMoveDataContainer);
+	WallRunTargetGravity = 0.2;
+	bInterpolateWallRunGravity = true;
+	ParkourMode = 0;
+	ParkourTimesJumped = 0;
+	bWantsToDash = false;
+	bHasPendingLaunch = false;
+	bPendingLaunchXYOverride = false;
+	bPendingLaunchZOverride = false;
+	bServerCanDash = true;
+	bHasPendingMantle = false;
+	bHadMovementInput = false;
+	bParkourWallLost = false;
+	PendingParkourLaunch = FVector::ZeroVector;
+	PendingMantleTarget = FVector::ZeroVector;
+	PendingMantleSpeed = 0.0;
+
+	bUseParkourPhysics = true;
+	WallRunSpeed = 850.0;
+	WallRunSprintSpeed = 1100.0;
+	WallRunGravityDelay = 1.0;
+	VerticalWallRunSpeed = 300.0;
+	WallStickSpeed = 200.0;
+	MaxLaunchSpeedXY = 1100.0;
+	MaxLaunchSpeedZ = 600.0;
+	DashScale = 15.0;
+	DashRange = 2000.0;
+	GroundDashRange = 200000.0;
+	MantleSpeed = 10.0;
+	QuickMantleSpeed = 20.0;
+	LaunchTolerance = 0.1;
+	WallNormal = FVector::ZeroVector;
+	ParkourPhysicsTime = 0.0;
+}
+
+FNetworkPredictionData_Client* UParkourMovementComponent::GetPredictionData_Client() const
+{
+	if (ClientPredictionData == nullptr)
+	{
+		UParkourMovementComponent* MutableThis = const_cast<UParkourMovementComponent*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Parkour(*this);
+	}
+	return ClientPredictionData;
+}
+
+void UParkourMovementComponent::SetParkourState(uint8 InParkourMode, uint8 InTimesJumped)
+{
+	ParkourMode = InParkourMode;
+	ParkourTimesJumped = InTimesJumped;
+}
+
+void UParkourMovementComponent::ParkourLaunch(const FVector& LaunchVelocity, bool bXYOverride, bool bZOverride)
+{
+	PendingParkourLaunch = LaunchVelocity;
+	bPendingLaunchXYOverride = bXYOverride;
+	bPendingLaunchZOverride = bZOverride;
+	bHasPendingLaunch = true;
+}
+
+void UParkourMovementComponent::ParkourDash(const FVector& LaunchVelocity)
+{
+	ParkourLaunch(LaunchVelocity, true, false);
+	bWantsToDash = true;
+}
+
+void UParkourMovementComponent::ParkourMantle(const FVector& Target, float InterpSpeed)
+{
+	PendingMantleTarget = Target;
+	PendingMantleSpeed = InterpSpeed;
+	bHasPendingMantle = true;
+}
+
+bool UParkourMovementComponent::IsMantling() const
+{
+	if (bHasPendingMantle)
+	{
+		return true;
+	}
+	for (const TSharedPtr<FRootMotionSource>& Source : CurrentRootMotion.RootMotionSources)
+	{
+		if (Source.IsValid() and Source->InstanceName == FRootMotionSource_ParkourMantle::SourceName)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void UParkourMovementComponent::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+	bWantsToDash = ((Flags & FSavedMove_Character::FLAG_Custom_0) != 0);
+}
+
+void UParkourMovementComponent::MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel)
+{
+	const FParkourNetworkMoveData* MoveData = static_cast<const FParkourNetworkMoveData*>(GetCurrentNetworkMoveData());
+	if (MoveData)
+	{
+		uint8 NewMode = MoveData->PackedParkourState & FParkourNetworkMoveData::MODE_MASK;
+		uint8 NewTimesJumped = (MoveData->PackedParkourState >> FParkourNetworkMoveData::JUMPS_SHIFT) & FParkourNetworkMoveData::JUMPS_MASK;
+		//A rejected mode keeps the server's, the client is corrected back to where that mode leaves it
+		if (NewMode != ParkourMode and !IsRemoteParkourModeValid(NewMode))
+		{
+			UE_LOG(LogTemp, Verbose, TEXT("Rejected parkour transition %d -> %d from %s"), ParkourMode, NewMode, *GetNameSafe(CharacterOwner));
+			NewMode = ParkourMode;
+		}
+		//The count only drops on landing or with a mode change, resetting it in the air would hand the jumps back
+		if (NewTimesJumped < ParkourTimesJumped and NewMode == ParkourMode and !IsMovingOnGround())
+		{
+			NewTimesJumped = ParkourTimesJumped;
+		}
+		bool bChanged = (NewMode != ParkourMode or NewTimesJumped != ParkourTimesJumped);
+		ParkourMode = NewMode;
+		ParkourTimesJumped = NewTimesJumped;
+		bHasPendingLaunch = (MoveData->PackedParkourState & FParkourNetworkMoveData::HAS_LAUNCH) != 0;
+		bPendingLaunchXYOverride = (MoveData->LaunchFlags & FParkourNetworkMoveData::LAUNCH_XY_OVERRIDE) != 0;
+		bPendingLaunchZOverride = (MoveData->LaunchFlags & FParkourNetworkMoveData::LAUNCH_Z_OVERRIDE) != 0;
+		PendingParkourLaunch = MoveData->LaunchVelocity;
+		bHasPendingMantle = MoveData->bHasMantle;
+		PendingMantleTarget = MoveData->MantleTarget;
+		PendingMantleSpeed = MoveData->MantleSpeed;
+
+		//Mode side effects (gravity, friction, walk speed) must land inside this move, not on the next tick
+		if (bChanged)
+		{
+			OnServerParkourState.ExecuteIfBound(ParkourMode, ParkourTimesJumped);
+		}
+	}
+
+	Super::MoveAutonomous(ClientTimeStamp, DeltaTime, CompressedFlags, NewAccel);
+}
+
+bool UParkourMovementComponent::IsServerForRemoteClient() const
+{
+	return CharacterOwner->GetLocalRole() == ROLE_Authority and !CharacterOwner->IsLocallyControlled();
+}
+
+bool UParkourMovementComponent::IsRemoteParkourModeValid(uint8 NewMode) const
+{
+	if (NewMode >= (uint8)EParkourSimMode::MAX or !FParkourSimRules::CanTransition((EParkourSimMode)ParkourMode, (EParkourSimMode)NewMode))
+	{
+		return false;
+	}
+	//Modes that hold the character on a wall or a ledge need one where the server has the character
+	switch ((EParkourSimMode)NewMode)
+	{
+	case EParkourSimMode::LEFTWALLRUN:
+	case EParkourSimMode::RIGHTWALLRUN:
+	case EParkourSimMode::VERTICALWALLRUN:
+	case EParkourSimMode::LEDGEGRAB:
+	{
+		FVector Normal;
+		return OnParkourWallProbe.IsBound() and OnParkourWallProbe.Execute(NewMode, Normal);
+	}
+	default:
+		return true;
+	}
+}
+
+bool UParkourMovementComponent::IsRemoteParkourLaunchValid() const
+{
+	const FVector& LaunchVelocity = PendingParkourLaunch;
+	const float Slack = 1.0f + LaunchTolerance;
+	//Move data is quantized to a tenth
+	const float Quantization = 0.1f;
+	if (bWantsToDash)
+	{
+		const float Range = IsFalling() ? DashRange : GroundDashRange;
+		const float MaxDash = FMath::Min(Range, Velocity.Size2D() * DashScale * Slack);
+		return bPendingLaunchXYOverride and !bPendingLaunchZOverride and FMath::Abs(LaunchVelocity.Z) <= Quantization
+			and LaunchVelocity.Size2D() <= MaxDash + Quantization;
+	}
+	if (LaunchVelocity.Size2D() > MaxLaunchSpeedXY * Slack + Quantization)
+	{
+		return false;
+	}
+	//Only jumps and the vertical wall run set a height, every additive launch is horizontal
+	if (bPendingLaunchZOverride)
+	{
+		const float MaxZ = FMath::Max(MaxLaunchSpeedZ, JumpZVelocity);
+		return LaunchVelocity.Z >= -Quantization and LaunchVelocity.Z <= MaxZ * Slack + Quantization;
+	}
+	return FMath::Abs(LaunchVelocity.Z) <= Quantization;
+}
+
+void UParkourMovementComponent::UpdateCharacterStateBeforeMovement(float DeltaSeconds)
+{
+	Super::UpdateCharacterStateBeforeMovement(DeltaSeconds);
+
+	//Acceleration holds the input on the owner and the server alike, so both can wake their parkour update
+	const bool bHasMovementInput = !Acceleration.IsNearlyZero();
+	if (bHasMovementInput and !bHadMovementInput)
+	{
+		OnParkourInputStarted.ExecuteIfBound();
+	}
+	bHadMovementInput = bHasMovementInput;
+
+	if (bInterpolateWallRunGravity and FParkourSimRules::IsWallRunning((EParkourSimMode)ParkourMode))
+	{
+		GravityScale = FParkourSimRules::InterpTo(GravityScale, WallRunTargetGravity, DeltaSeconds, 20.0f);
+	}
+
+	if (bUseParkourPhysics)
+	{
+		UpdateParkourPhysics();
+		ApplyParkourWallLost();
+	}
+	ApplyPendingParkourLaunch();
+	ApplyPendingParkourMantle();
+}
+
+void UParkourMovementComponent::UpdateParkourPhysics()
+{
+	//The predicted parkour mode picks the physics, so client and server switch inside the same move
+	EParkourSimPhysics Physics = FParkourSimRules::GetPhysics((EParkourSimMode)ParkourMode);
+	if (Physics != EParkourSimPhysics::NONE)
+	{
+		if (MovementMode != MOVE_Custom or CustomMovementMode != (uint8)Physics)
+		{
+			SetMovementMode(MOVE_Custom, (uint8)Physics);
+		}
+	}
+	else if (MovementMode == MOVE_Custom)
+	{
+		SetMovementMode(MOVE_Falling);
+	}
+}
+
+void UParkourMovementComponent::ApplyParkourWallLost()
+{
+	if (bParkourWallLost)
+	{
+		bParkourWallLost = false;
+		SetMovementMode(MOVE_Falling);
+	}
+}
+
+void UParkourMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode)
+{
+	Super::OnMovementModeChanged(PreviousMovementMode, PreviousCustomMode);
+
+	bParkourWallLost = false;
+	if (MovementMode != MOVE_Custom)
+	{
+		return;
+	}
+	ParkourPhysicsTime = 0.0;
+	switch ((EParkourCustomMovement)CustomMovementMode)
+	{
+	case EParkourCustomMovement::WALLRUN:
+	case EParkourCustomMovement::VERTICALWALLRUN:
+		//Leaving the custom mode alone would have UpdateParkourPhysics put it back next move, the parkour mode ends instead.
+		//The switch to falling waits until this notification has returned.
+		if (!FindWall())
+		{
+			OnParkourWallLost.ExecuteIfBound();
+			ParkourMode = (uint8)EParkourSimMode::NONE;
+			bParkourWallLost = true;
+		}
+		break;
+	case EParkourCustomMovement::LEDGEHANG:
+		StopMovementImmediately();
+		break;
+	default:
+		break;
+	}
+}
+
+bool UParkourMovementComponent::FindWall()
+{
+	FVector Normal;
+	if (!OnParkourWallProbe.IsBound() or !OnParkourWallProbe.Execute(ParkourMode, Normal))
+	{
+		return false;
+	}
+	WallNormal = Normal.GetSafeNormal2D();
+	return true;
+}
+
+void UParkourMovementComponent::PhysCustom(float DeltaTime, int32 Iterations)
+{
+	//Entered a wall mode outside UpdateParkourPhysics with no wall to run on
+	if (bParkourWallLost)
+	{
+		ApplyParkourWallLost();
+		StartNewPhysics(DeltaTime, Iterations);
+		return;
+	}
+	switch ((EParkourCustomMovement)CustomMovementMode)
+	{
+	case EParkourCustomMovement::WALLRUN:
+		PhysWallRun(DeltaTime, Iterations);
+		break;
+	case EParkourCustomMovement::VERTICALWALLRUN:
+		PhysVerticalWallRun(DeltaTime, Iterations);
+		break;
+	case EParkourCustomMovement::LEDGEHANG:
+		PhysLedgeHang(DeltaTime, Iterations);
+		break;
+	case EParkourCustomMovement::MANTLE:
+		PhysMantle(DeltaTime, Iterations);
+		break;
+	default:
+		Super::PhysCustom(DeltaTime, Iterations);
+		break;
+	}
+}
+
+bool UParkourMovementComponent::CanRunParkourPhysics() const
+{
+	return CharacterOwner and (CharacterOwner->Controller or bRunPhysicsWithNoController or HasAnimRootMotion()
+		or CurrentRootMotion.HasOverrideVelocity() or CharacterOwner->GetLocalRole() == ROLE_SimulatedProxy);
+}
+
+bool UParkourMovementComponent::MoveAlongWall(const FVector& Delta, float TimeTick, float& RemainingTime, int32 Iterations)
+{
+	FHitResult Hit(1.0f);
+	SafeMoveUpdatedComponent(Delta, UpdatedComponent->GetComponentQuat(), true, Hit);
+	if (!Hit.IsValidBlockingHit())
+	{
+		return true;
+	}
+	if (IsValidLandingSpot(UpdatedComponent->GetComponentLocation(), Hit))
+	{
+		RemainingTime += TimeTick * (1.0f - Hit.Time);
+		ProcessLanded(Hit, RemainingTime, Iterations);
+		return false;
+	}
+	if (FParkourSimRules::IsWallRunnableNormal(Hit.Normal.Z))
+	{
+		WallNormal = Hit.Normal.GetSafeNormal2D();
+	}
+	SlideAlongSurface(Delta, 1.0f - Hit.Time, Hit.Normal, Hit, true);
+	return true;
+}
+
+void UParkourMovementComponent::PhysWallRun(float DeltaTime, int32 Iterations)
+{
+	if (DeltaTime < MIN_TICK_TIME)
+	{
+		return;
+	}
+	float RemainingTime = DeltaTime;
+	while (RemainingTime >= MIN_TICK_TIME and Iterations < MaxSimulationIterations and CanRunParkourPhysics())
+	{
+		Iterations++;
+		const float TimeTick = GetSimulationTimeStep(RemainingTime, Iterations);
+		RemainingTime -= TimeTick;
+		ParkourPhysicsTime += TimeTick;
+
+		//Keep the run direction the character already has along the wall, at wall-run speed
+		const FVector Along = FVector::CrossProduct(WallNormal, FVector::UpVector);
+		const float AlongSpeed = FVector::DotProduct(Velocity, Along);
+		const float Speed = FMath::Clamp(FMath::Abs(AlongSpeed), WallRunSpeed, WallRunSprintSpeed);
+		const float VerticalSpeed = (ParkourPhysicsTime > WallRunGravityDelay) ? Velocity.Z + GetGravityZ() * TimeTick : 0.0f;
+
+		Velocity = Along * ((AlongSpeed < 0.0f) ? -Speed : Speed) + FVector(0.0, 0.0, VerticalSpeed);
+		if (!MoveAlongWall((Velocity - WallNormal * WallStickSpeed) * TimeTick, TimeTick, RemainingTime, Iterations))
+		{
+			return;
+		}
+	}
+}
+
+void UParkourMovementComponent::PhysVerticalWallRun(float DeltaTime, int32 Iterations)
+{
+	if (DeltaTime < MIN_TICK_TIME)
+	{
+		return;
+	}
+	float RemainingTime = DeltaTime;
+	while (RemainingTime >= MIN_TICK_TIME and Iterations < MaxSimulationIterations and CanRunParkourPhysics())
+	{
+		Iterations++;
+		const float TimeTick = GetSimulationTimeStep(RemainingTime, Iterations);
+		RemainingTime -= TimeTick;
+		ParkourPhysicsTime += TimeTick;
+
+		Velocity = FVector(0.0, 0.0, VerticalWallRunSpeed);
+		if (!MoveAlongWall((Velocity - WallNormal * WallStickSpeed) * TimeTick, TimeTick, RemainingTime, Iterations))
+		{
+			return;
+		}
+	}
+}
+
+void UParkourMovementComponent::PhysLedgeHang(float DeltaTime, int32 Iterations)
+{
+	//Held in place with no gravity until a jump, mantle or drop changes the parkour mode
+	ParkourPhysicsTime += DeltaTime;
+	Velocity = FVector::ZeroVector;
+}
+
+void UParkourMovementComponent::PhysMantle(float DeltaTime, int32 Iterations)
+{
+	if (DeltaTime < MIN_TICK_TIME)
+	{
+		return;
+	}
+	ParkourPhysicsTime += DeltaTime;
+
+	float RemainingTime = DeltaTime;
+	while (RemainingTime >= MIN_TICK_TIME and Iterations < MaxSimulationIterations and CanRunParkourPhysics())
+	{
+		Iterations++;
+		const float TimeTick = GetSimulationTimeStep(RemainingTime, Iterations);
+		RemainingTime -= TimeTick;
+
+		//The mantle root motion overrides the velocity, without it the capsule holds still like a ledge hang
+		Velocity = FVector::ZeroVector;
+		ApplyRootMotionToVelocity(TimeTick);
+		const FVector Delta = Velocity * TimeTick;
+		if (Delta.IsNearlyZero())
+		{
+			return;
+		}
+
+		FHitResult Hit(1.0f);
+		SafeMoveUpdatedComponent(Delta, UpdatedComponent->GetComponentQuat(), true, Hit);
+		if (Hit.IsValidBlockingHit())
+		{
+			SlideAlongSurface(Delta, 1.0f - Hit.Time, Hit.Normal, Hit, true);
+		}
+	}
+}
+
+void UParkourMovementComponent::ApplyPendingParkourLaunch()
+{
+	if (!bHasPendingLaunch)
+	{
+		return;
+	}
+	bHasPendingLaunch = false;
+
+	const bool bRemote = IsServerForRemoteClient();
+	if (bRemote and !IsRemoteParkourLaunchValid())
+	{
+		UE_LOG(LogTemp, Verbose, TEXT("Rejected parkour launch %s from %s"), *PendingParkourLaunch.ToString(), *GetNameSafe(CharacterOwner));
+		bWantsToDash = false;
+		return;
+	}
+	if (bWantsToDash)
+	{
+		bWantsToDash = false;
+		//Only one dash per landing is accepted from a remote client
+		if (bRemote)
+		{
+			if (!bServerCanDash)
+			{
+				return;
+			}
+			bServerCanDash = false;
+		}
+	}
+
+	//Same velocity composition as ACharacter::LaunchCharacter
+	FVector FinalVel = PendingParkourLaunch;
+	if (!bPendingLaunchXYOverride)
+	{
+		FinalVel.X += Velocity.X;
+		FinalVel.Y += Velocity.Y;
+	}
+	if (!bPendingLaunchZOverride)
+	{
+		FinalVel.Z += Velocity.Z;
+	}
+	Launch(FinalVel);
+}
+
+void UParkourMovementComponent::ApplyPendingParkourMantle()
+{
+	//A mantle cut short by a mode change must not keep pulling the capsule toward the ledge
+	if (ParkourMode != (uint8)EParkourSimMode::MANTLE and CurrentRootMotion.HasActiveRootMotionSources())
+	{
+		RemoveRootMotionSource(FRootMotionSource_ParkourMantle::SourceName);
+	}
+	if (!bHasPendingMantle)
+	{
+		return;
+	}
+	bHasPendingMantle = false;
+
+	//Replayed moves still carry the pending mantle, the one already running keeps its start point
+	if (CurrentRootMotion.GetRootMotionSource(FRootMotionSource_ParkourMantle::SourceName).IsValid())
+	{
+		return;
+	}
+	FVector Target = PendingMantleTarget;
+	float Speed = PendingMantleSpeed;
+	if (IsServerForRemoteClient())
+	{
+		//A remote client only asks for the mantle, the ledge it climbs to comes from the server's probe
+		if (ParkourMode != (uint8)EParkourSimMode::MANTLE or !OnParkourMantleProbe.IsBound() or !OnParkourMantleProbe.Execute(PendingMantleTarget, Target))
+		{
+			UE_LOG(LogTemp, Verbose, TEXT("Rejected parkour mantle to %s from %s"), *PendingMantleTarget.ToString(), *GetNameSafe(CharacterOwner));
+			return;
+		}
+		Speed = FMath::Clamp(Speed, FMath::Min(MantleSpeed, QuickMantleSpeed), FMath::Max(MantleSpeed, QuickMantleSpeed));
+	}
+	ApplyRootMotionSource(FRootMotionSource_ParkourMantle::Make(UpdatedComponent->GetComponentLocation(), Target, Speed));
+}
@@ -0,0 +1,236 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "ParkourMovementComponent.generated.h"
+
+class UParkourMovementComponent;
+
+//CustomMovementMode values while MovementMode is MOVE_Custom, mirror EParkourSimPhysics
+UENUM(BlueprintType)
+enum class EParkourCustomMovement : uint8
+{
+	NONE	UMETA(Hidden),
+	WALLRUN	UMETA(DisplayName = "WallRun"),
+	VERTICALWALLRUN	UMETA(DisplayName = "VerticalWallRun"),
+	LEDGEHANG	UMETA(DisplayName = "LedgeHang"),
+	MANTLE	UMETA(DisplayName = "Mantle")
+};
+
+DECLARE_DELEGATE_TwoParams(FOnServerParkourState, uint8 /*ParkourMode*/, uint8 /*TimesJumped*/);
+DECLARE_DELEGATE_RetVal_TwoParams(bool, FOnParkourWallProbe, uint8 /*ParkourMode*/, FVector& /*OutWallNormal*/);
+DECLARE_DELEGATE_RetVal_TwoParams(bool, FOnParkourMantleProbe, const FVector& /*ClientTarget*/, FVector& /*OutTarget*/);
+
+//Saved client move carrying the parkour state so wall runs, slides, mantles and dashes replay identically
+class FSavedMove_Parkour : public FSavedMove_Character
+{
+public:
+	typedef FSavedMove_Character Super;
+
+	virtual void Clear() override;
+	virtual uint8 GetCompressedFlags() const override;
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* InCharacter, float MaxDelta) const override;
+	virtual void SetMoveFor(ACharacter* C, float InDeltaTime, FVector const& NewAccel, FNetworkPredictionData_Client_Character& ClientData) override;
+	virtual void PrepMoveFor(ACharacter* C) override;
+	virtual bool IsImportantMove(const FSavedMovePtr& LastAckedMove) const override;
+
+	uint8 SavedParkourMode;
+	uint8 SavedTimesJumped;
+	uint8 bSavedWantsToDash : 1;
+	uint8 bSavedHasLaunch : 1;
+	uint8 bSavedLaunchXYOverride : 1;
+	uint8 bSavedLaunchZOverride : 1;
+	uint8 bSavedHasMantle : 1;
+	FVector SavedLaunchVelocity;
+	FVector SavedMantleTarget;
+	float SavedMantleSpeed;
+	FVector SavedWallNormal;
+	float SavedParkourPhysicsTime;
+};
+
+class FNetworkPredictionData_Client_Parkour : public FNetworkPredictionData_Client_Character
+{
+public:
+	typedef FNetworkPredictionData_Client_Character Super;
+
+	FNetworkPredictionData_Client_Parkour(const UCharacterMovementComponent& ClientMovement) : Super(ClientMovement) {}
+	virtual FSavedMovePtr AllocateNewMove() override;
+};
+
+//Parkour state packed into the move RPC: mode 4 bits, jump count 3 bits, launch present 1 bit, then one mantle bit
+struct FParkourNetworkMoveData : public FCharacterNetworkMoveData
+{
+	typedef FCharacterNetworkMoveData Super;
+
+	enum : uint8
+	{
+		MODE_MASK = 0x0F,
+		JUMPS_SHIFT = 4,
+		JUMPS_MASK = 0x07,
+		HAS_LAUNCH = 0x80,
+		LAUNCH_XY_OVERRIDE = 0x01,
+		LAUNCH_Z_OVERRIDE = 0x02
+	};
+
+	uint8 PackedParkourState = 0;
+	uint8 LaunchFlags = 0;
+	FVector_NetQuantize10 LaunchVelocity;
+	uint8 bHasMantle = 0;
+	FVector_NetQuantize10 MantleTarget;
+	float MantleSpeed = 0.0f;
+
+	virtual void ClientFillNetworkMoveData(const FSavedMove_Character& ClientMove, ENetworkMoveType MoveType) override;
+	virtual bool Serialize(UCharacterMovementComponent& CharacterMovement, FArchive& Ar, UPackageMap* PackageMap, ENetworkMoveType MoveType) override;
+};
+
+struct FParkourNetworkMoveDataContainer : public FCharacterNetworkMoveDataContainer
+{
+	FParkourNetworkMoveDataContainer()
+	{
+		NewMoveData = &ParkourMoveData[0];
+		PendingMoveData = &ParkourMoveData[1];
+		OldMoveData = &ParkourMoveData[2];
+	}
+
+	FParkourNetworkMoveData ParkourMoveData[3];
+};
+
+//CharacterMovement that predicts the parkour mode, jump count, launches and dashes issued by UParkourComponent
+UCLASS()
+class ECHORUNNER_API UParkourMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	UParkourMovementComponent();
+
+	virtual FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
+	//Called by UParkourComponent on the controlling client to record state for the next saved move
+	void SetParkourState(uint8 InParkourMode, uint8 InTimesJumped);
+	//Predicted replacement for ACharacter::LaunchCharacter
+	void ParkourLaunch(const FVector& LaunchVelocity, bool bXYOverride, bool bZOverride);
+	void ParkourDash(const FVector& LaunchVelocity);
+	//Server re-enables the dash when the owner lands
+	void ResetDash() { bServerCanDash = true; }
+	//Predicted mantle, starts a FRootMotionSource_ParkourMantle from the current location inside the next move
+	void ParkourMantle(const FVector& Target, float InterpSpeed);
+	//True from ParkourMantle until the mantle root motion has run its duration
+	bool IsMantling() const;
+
+	//True while the parkour mode is integrated by PhysCustom instead of a per-update launch
+	bool UsesParkourPhysics() const { return bUseParkourPhysics; }
+	bool IsInParkourPhysics(EParkourCustomMovement Mode) const { return MovementMode == MOVE_Custom and CustomMovementMode == (uint8)Mode; }
+
+	uint8 GetParkourMode() const { return ParkourMode; }
+	uint8 GetParkourTimesJumped() const { return ParkourTimesJumped; }
+
+	//Lets UParkourComponent follow a remote client's parkour state inside the server move
+	FOnServerParkourState OnServerParkourState;
+	//Fired when movement input starts after a stretch without any, wakes a sleeping UParkourComponent
+	FSimpleDelegate OnParkourInputStarted;
+	//Finds the wall a wall mode runs on with UParkourComponent's own probes
+	FOnParkourWallProbe OnParkourWallProbe;
+	//A wall mode started with no wall to run on, UParkourComponent ends the mode
+	FSimpleDelegate OnParkourWallLost;
+	//Places a remote client's mantle from the server's own ledge probe
+	FOnParkourMantleProbe OnParkourMantleProbe;
+
+	//Wall-run gravity is interpolated per move so client and server integrate the same curve
+	UPROPERTY(BlueprintReadWrite, Category = "Parkour")
+	float WallRunTargetGravity;
+	UPROPERTY(BlueprintReadWrite, Category = "Parkour")
+	bool bInterpolateWallRunGravity;
+
+	//Run wall runs, vertical wall runs, ledge hangs and mantles as MOVE_Custom modes
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Parkour")
+	bool bUseParkourPhysics;
+	//Speed along the wall is held between these, copied from UParkourComponent
+	UPROPERTY(BlueprintReadWrite, Category = "Parkour")
+	float WallRunSpeed;
+	UPROPERTY(BlueprintReadWrite, Category = "Parkour")
+	float WallRunSprintSpeed;
+	//Seconds a wall run holds its height before gravity applies
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Parkour")
+	float WallRunGravityDelay;
+	UPROPERTY(BlueprintReadWrite, Category = "Parkour")
+	float VerticalWallRunSpeed;
+	//Velocity into the wall that keeps the capsule in contact, the sweep turns it into the wall normal
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Parkour")
+	float WallStickSpeed;
+
+	//Largest launches UParkourComponent issues outside a dash, a remote client's launch over them is dropped.
+	//Only launches that override Z may set a height, JumpZVelocity always counts toward it.
+	UPROPERTY(BlueprintReadWrite, Category = "Parkour|Validation")
+	float MaxLaunchSpeedXY;
+	UPROPERTY(BlueprintReadWrite, Category = "Parkour|Validation")
+	float MaxLaunchSpeedZ;
+	//A dash is the horizontal velocity times DashScale, clamped to DashRange in the air and GroundDashRange on the ground
+	UPROPERTY(BlueprintReadWrite, Category = "Parkour|Validation")
+	float DashScale;
+	UPROPERTY(BlueprintReadWrite, Category = "Parkour|Validation")
+	float DashRange;
+	UPROPERTY(BlueprintReadWrite, Category = "Parkour|Validation")
+	float GroundDashRange;
+	//A remote client's mantle speed is clamped between these, copied from UParkourComponent
+	UPROPERTY(BlueprintReadWrite, Category = "Parkour|Validation")
+	float MantleSpeed;
+	UPROPERTY(BlueprintReadWrite, Category = "Parkour|Validation")
+	float QuickMantleSpeed;
+	//Fraction the checked launches may exceed their bound by, covers the client's velocity differing from the server's
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Parkour|Validation")
+	float LaunchTolerance;
+
+protected:
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+	virtual void MoveAutonomous(float ClientTimeStamp, float DeltaTime, uint8 CompressedFlags, const FVector& NewAccel) override;
+	virtual void UpdateCharacterStateBeforeMovement(float DeltaSeconds) override;
+	virtual void OnMovementModeChanged(EMovementMode PreviousMovementMode, uint8 PreviousCustomMode) override;
+	virtual void PhysCustom(float DeltaTime, int32 Iterations) override;
+
+private:
+	friend class FSavedMove_Parkour;
+	friend struct FParkourNetworkMoveData;
+
+	void ApplyPendingParkourLaunch();
+	//Server checks on a remote client's move data before it is taken
+	bool IsServerForRemoteClient() const;
+	bool IsRemoteParkourModeValid(uint8 NewMode) const;
+	bool IsRemoteParkourLaunchValid() const;
+	void ApplyPendingParkourMantle();
+	void UpdateParkourPhysics();
+	//Falls out of a wall mode OnMovementModeChanged found no wall for
+	void ApplyParkourWallLost();
+	bool FindWall();
+	void PhysWallRun(float DeltaTime, int32 Iterations);
+	void PhysVerticalWallRun(float DeltaTime, int32 Iterations);
+	void PhysLedgeHang(float DeltaTime, int32 Iterations);
+	void PhysMantle(float DeltaTime, int32 Iterations);
+	//Sweeps Delta, lands on walkable floors and slides along anything else, returns false once physics changed mode
+	bool MoveAlongWall(const FVector& Delta, float TimeTick, float& RemainingTime, int32 Iterations);
+	bool CanRunParkourPhysics() const;
+
+	FParkourNetworkMoveDataContainer ParkourMoveDataContainer;
+
+	uint8 ParkourMode;
+	uint8 ParkourTimesJumped;
+	uint8 bWantsToDash : 1;
+	uint8 bHasPendingLaunch : 1;
+	uint8 bPendingLaunchXYOverride : 1;
+	uint8 bPendingLaunchZOverride : 1;
+	uint8 bServerCanDash : 1;
+	uint8 bHasPendingMantle : 1;
+	uint8 bHadMovementInput : 1;
+	//Set by OnMovementModeChanged, which must not change the mode again from inside the notification
+	uint8 bParkourWallLost : 1;
+	FVector PendingParkourLaunch;
+	FVector PendingMantleTarget;
+	float PendingMantleSpeed;
+
+	//Horizontal normal of the wall the current custom mode runs on
+	FVector WallNormal;
+	//Seconds spent in the current custom mode
+	float ParkourPhysicsTime;
+};
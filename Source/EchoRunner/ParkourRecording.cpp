@@ -0,0 +1,318 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourRecording.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Engine/World.h"
+#include "GameFramework/Actor.h"
+
+namespace ParkourRecording
+{
+	//Chunk size handed to the background writer, roughly a minute of busy parkour
+	constexpr int32 FlushSize = 4096;
+
+	static TAutoConsoleVariable<bool> CVarRecordSessions(
+		TEXT("parkour.RecordSessions"),
+		false,
+		TEXT("Record every locally controlled parkour character to Saved/ParkourRecordings."));
+
+	static void WriteVarint(TArray<uint8>& Out, uint32 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Out.Add((uint8)(Value | 0x80));
+			Value >>= 7;
+		}
+		Out.Add((uint8)Value);
+	}
+
+	static bool ReadVarint(const uint8*& Data, const uint8* End, uint32& OutValue)
+	{
+		OutValue = 0;
+		for (int32 Shift = 0; Shift < 35; Shift += 7)
+		{
+			if (Data >= End)
+			{
+				return false;
+			}
+			uint8 Byte = *Data++;
+			OutValue |= (uint32)(Byte & 0x7F) << Shift;
+			if ((Byte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	static uint32 ZigZag(int32 Value)
+	{
+		return ((uint32)Value << 1) ^ (uint32)(Value >> 31);
+	}
+
+	static int32 UnZigZag(uint32 Value)
+	{
+		return (int32)(Value >> 1) ^ -(int32)(Value & 1);
+	}
+
+	int8 QuantizeInput(float Value)
+	{
+		return (int8)FMath::Clamp(FMath::RoundToInt(Value * InputSteps), -InputSteps, InputSteps);
+	}
+
+	float DequantizeInput(int8 Value)
+	{
+		return (float)Value / InputSteps;
+	}
+
+	FRotator DecompressView(const uint16 View[3])
+	{
+		return FRotator(FRotator::DecompressAxisFromShort(View[0]), FRotator::DecompressAxisFromShort(View[1]), FRotator::DecompressAxisFromShort(View[2]));
+	}
+
+	FString MakeRecordingPath(const UObject* Owner)
+	{
+		FString MapName = TEXT("NoMap");
+		if (const UWorld* World = Owner ? Owner->GetWorld() : nullptr)
+		{
+			MapName = UWorld::RemovePIEPrefix(World->GetMapName());
+		}
+		FString OwnerName = (Owner and Owner->GetTypedOuter<AActor>()) ? Owner->GetTypedOuter<AActor>()->GetName() : TEXT("Parkour");
+		return FPaths::ProjectSavedDir() / TEXT("ParkourRecordings") / FString::Printf(TEXT("%s_%s_%s.pkr"), *MapName, *OwnerName, *FDateTime::Now().ToString());
+	}
+
+	bool ShouldRecordSessions()
+	{
+		return CVarRecordSessions.GetValueOnGameThread();
+	}
+}
+
+FParkourRecordingWriter::FParkourRecordingWriter(const FString& InPath, const FParkourRecordingHeader& Header)
+	: Path(InPath)
+	, File(MakeShared<FFile, ESPMode::ThreadSafe>())
+{
+	File->Path = Path;
+	Buffer.Reserve(ParkourRecording::FlushSize);
+	Buffer.Append(reinterpret_cast<const uint8*>(&Header), sizeof(Header));
+}
+
+FParkourRecordingWriter::~FParkourRecordingWriter()
+{
+	Flush(true);
+	//Nothing waits on the writer during play, but the last chunk must land before the process goes away
+	if (IsEngineExitRequested())
+	{
+		LastWrite.Wait();
+	}
+}
+
+void FParkourRecordingWriter::WriteInput(uint32 Update, const FVector& Input)
+{
+	int8 InputX = ParkourRecording::QuantizeInput(Input.X);
+	int8 InputY = ParkourRecording::QuantizeInput(Input.Y);
+	if (InputX == LastInputX and InputY == LastInputY)
+	{
+		return;
+	}
+	WriteKey(Update, EParkourRecordOp::INPUT);
+	ParkourRecording::WriteVarint(Buffer, ParkourRecording::ZigZag(InputX - LastInputX));
+	ParkourRecording::WriteVarint(Buffer, ParkourRecording::ZigZag(InputY - LastInputY));
+	LastInputX = InputX;
+	LastInputY = InputY;
+	if (Buffer.Num() >= ParkourRecording::FlushSize)
+	{
+		Flush(false);
+	}
+}
+
+void FParkourRecordingWriter::WriteView(uint32 Update, const FRotator& ControlRotation)
+{
+	const uint16 View[3] = {
+		FRotator::CompressAxisToShort(ControlRotation.Pitch),
+		FRotator::CompressAxisToShort(ControlRotation.Yaw),
+		FRotator::CompressAxisToShort(ControlRotation.Roll)};
+	if (bWroteView and View[0] == LastView[0] and View[1] == LastView[1] and View[2] == LastView[2])
+	{
+		return;
+	}
+	WriteKey(Update, EParkourRecordOp::VIEW);
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		//Deltas wrap around the short so turning past 180 degrees stays a small step
+		ParkourRecording::WriteVarint(Buffer, ParkourRecording::ZigZag((int16)(View[Axis] - LastView[Axis])));
+		LastView[Axis] = View[Axis];
+	}
+	bWroteView = true;
+	if (Buffer.Num() >= ParkourRecording::FlushSize)
+	{
+		Flush(false);
+	}
+}
+
+void FParkourRecordingWriter::WriteDeltaTime(uint32 Update, float DeltaTime)
+{
+	const uint32 DeltaMicroseconds = (uint32)FMath::Max(FMath::RoundToInt(DeltaTime * 1000000.0f), 1);
+	if (DeltaMicroseconds == LastDeltaMicroseconds)
+	{
+		return;
+	}
+	WriteKey(Update, EParkourRecordOp::DELTATIME);
+	ParkourRecording::WriteVarint(Buffer, ParkourRecording::ZigZag((int32)(DeltaMicroseconds - LastDeltaMicroseconds)));
+	LastDeltaMicroseconds = DeltaMicroseconds;
+	if (Buffer.Num() >= ParkourRecording::FlushSize)
+	{
+		Flush(false);
+	}
+}
+
+void FParkourRecordingWriter::WriteOp(uint32 Update, EParkourRecordOp Op, uint8 Mode)
+{
+	check(Op != EParkourRecordOp::INPUT and Op != EParkourRecordOp::VIEW and Op != EParkourRecordOp::DELTATIME and Op < EParkourRecordOp::MAX);
+	WriteKey(Update, Op);
+	if (Op == EParkourRecordOp::MODE)
+	{
+		Buffer.Add(Mode);
+	}
+	if (Buffer.Num() >= ParkourRecording::FlushSize)
+	{
+		Flush(false);
+	}
+}
+
+void FParkourRecordingWriter::WriteKey(uint32 Update, EParkourRecordOp Op)
+{
+	check(Update >= LastUpdate);
+	ParkourRecording::WriteVarint(Buffer, ((Update - LastUpdate) << 4) | (uint32)Op);
+	LastUpdate = Update;
+}
+
+void FParkourRecordingWriter::Flush(bool bClose)
+{
+	if (Buffer.Num() == 0 and !bClose)
+	{
+		return;
+	}
+	auto WriteChunk = [File = File, Chunk = MoveTemp(Buffer), bClose]() mutable
+	{
+		if (!File->Archive and !File->bFailed)
+		{
+			File->Archive.Reset(IFileManager::Get().CreateFileWriter(*File->Path));
+			File->bFailed = !File->Archive;
+			if (File->bFailed)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("Could not open parkour recording %s"), *File->Path);
+			}
+		}
+		if (File->Archive)
+		{
+			File->Archive->Serialize(Chunk.GetData(), Chunk.Num());
+			if (bClose)
+			{
+				File->Archive->Close();
+				File->Archive.Reset();
+			}
+		}
+	};
+	LastWrite = LastWrite.IsValid()
+		? UE::Tasks::Launch(UE_SOURCE_LOCATION, MoveTemp(WriteChunk), UE::Tasks::Prerequisites(LastWrite), UE::Tasks::ETaskPriority::BackgroundNormal)
+		: UE::Tasks::Launch(UE_SOURCE_LOCATION, MoveTemp(WriteChunk), UE::Tasks::ETaskPriority::BackgroundNormal);
+
+	Buffer.Reset();
+	Buffer.Reserve(ParkourRecording::FlushSize);
+}
+
+bool FParkourRecordingReader::Load(const FString& Path)
+{
+	TArray<uint8> Data;
+	if (!FFileHelper::LoadFileToArray(Data, *Path) or Data.Num() < (int32)sizeof(FParkourRecordingHeader))
+	{
+		return false;
+	}
+	FMemory::Memcpy(&Header, Data.GetData(), sizeof(Header));
+	if (Header.Magic != FParkourRecordingHeader::ExpectedMagic or Header.Version < 1 or Header.Version > FParkourRecordingHeader::CurrentVersion)
+	{
+		return false;
+	}
+
+	Ops.Reset();
+	Transitions.Reset();
+	NextOpIndex = 0;
+	NextTransitionIndex = 0;
+
+	const uint8* Cursor = Data.GetData() + sizeof(Header);
+	const uint8* End = Data.GetData() + Data.Num();
+	FParkourRecordedOp Op;
+	while (Cursor < End)
+	{
+		uint32 Key = 0;
+		if (!ParkourRecording::ReadVarint(Cursor, End, Key) or (Key & 15) >= (uint32)EParkourRecordOp::MAX)
+		{
+			//A session cut short by a crash ends mid-op, keep everything before it
+			UE_LOG(LogTemp, Warning, TEXT("%s is truncated after %d ops"), *Path, Ops.Num() + Transitions.Num());
+			break;
+		}
+		Op.Update += Key >> 4;
+		Op.Op = (EParkourRecordOp)(Key & 15);
+		if (Op.Op == EParkourRecordOp::INPUT)
+		{
+			uint32 DeltaX = 0;
+			uint32 DeltaY = 0;
+			if (!ParkourRecording::ReadVarint(Cursor, End, DeltaX) or !ParkourRecording::ReadVarint(Cursor, End, DeltaY))
+			{
+				break;
+			}
+			Op.InputX = (int8)(Op.InputX + ParkourRecording::UnZigZag(DeltaX));
+			Op.InputY = (int8)(Op.InputY + ParkourRecording::UnZigZag(DeltaY));
+		}
+		else if (Op.Op == EParkourRecordOp::VIEW)
+		{
+			uint32 Deltas[3] = {};
+			if (!ParkourRecording::ReadVarint(Cursor, End, Deltas[0]) or !ParkourRecording::ReadVarint(Cursor, End, Deltas[1])
+				or !ParkourRecording::ReadVarint(Cursor, End, Deltas[2]))
+			{
+				break;
+			}
+			for (int32 Axis = 0; Axis < 3; Axis++)
+			{
+				Op.View[Axis] = (uint16)(Op.View[Axis] + ParkourRecording::UnZigZag(Deltas[Axis]));
+			}
+		}
+		else if (Op.Op == EParkourRecordOp::DELTATIME)
+		{
+			uint32 Delta = 0;
+			if (!ParkourRecording::ReadVarint(Cursor, End, Delta))
+			{
+				break;
+			}
+			Op.DeltaMicroseconds = (uint32)((int32)Op.DeltaMicroseconds + ParkourRecording::UnZigZag(Delta));
+		}
+		else if (Op.Op == EParkourRecordOp::MODE)
+		{
+			if (Cursor >= End)
+			{
+				break;
+			}
+			Op.Mode = *Cursor++;
+			Transitions.Add(Op);
+			continue;
+		}
+		Ops.Add(Op);
+	}
+	return true;
+}
+
+const FParkourRecordedOp* FParkourRecordingReader::NextOp(uint32 Update)
+{
+	if (NextOpIndex < Ops.Num() and Ops[NextOpIndex].Update <= Update)
+	{
+		return &Ops[NextOpIndex++];
+	}
+	return nullptr;
+}
+
+const FParkourRecordedOp* FParkourRecordingReader::NextTransition()
+{
+	return (NextTransitionIndex < Transitions.Num()) ? &Transitions[NextTransitionIndex++] : nullptr;
+}
@@ -0,0 +1,135 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tasks/Task.h"
+
+//Parkour session recordings, Saved/ParkourRecordings/*.pkr.
+//A recording holds the input vector ForwardInput() is derived from, the control rotation, the update's delta time,
+//the event entry points and every mode transition, keyed by parkour update. Updates where nothing changed write nothing.
+//The file is a FParkourRecordingHeader followed by ops, each one varint((UpdateDelta << 4) | Op) and its payload.
+
+enum class EParkourRecordOp : uint8
+{
+	//Zigzag varint X and Y deltas of the quantized input vector
+	INPUT,
+	JUMP,
+	DASH,
+	CROUCHSLIDE,
+	SPRINT,
+	LAND,
+	//EParkourMode byte, checked against the replayed transition during playback
+	MODE,
+	//Zigzag varint pitch, yaw and roll deltas of the control rotation compressed to shorts
+	VIEW,
+	//Zigzag varint delta of the update's delta time in microseconds
+	DELTATIME,
+	MAX
+};
+static_assert((uint8)EParkourRecordOp::MAX <= 16, "EParkourRecordOp must fit in the low 4 bits of an op key");
+
+struct FParkourRecordingHeader
+{
+	static constexpr uint32 ExpectedMagic = 0x43524B50; //'PKRC'
+	//Version 1 has no VIEW or DELTATIME ops, it plays back with the live view and delta time
+	static constexpr uint32 CurrentVersion = 2;
+
+	uint32 Magic = ExpectedMagic;
+	uint32 Version = CurrentVersion;
+	float Location[3] = {};
+	float Rotation[3] = {};
+	float ControlRotation[3] = {};
+	float Velocity[3] = {};
+	uint8 Mode = 0;
+	uint8 Reserved[3] = {};
+};
+static_assert(sizeof(FParkourRecordingHeader) == 60, "FParkourRecordingHeader layout is part of the file format");
+
+struct FParkourRecordedOp
+{
+	uint32 Update = 0;
+	EParkourRecordOp Op = EParkourRecordOp::MAX;
+	//Absolute quantized input for INPUT, new mode for MODE, compressed rotation for VIEW, microseconds for DELTATIME
+	int8 InputX = 0;
+	int8 InputY = 0;
+	uint8 Mode = 0;
+	uint16 View[3] = {};
+	uint32 DeltaMicroseconds = 0;
+};
+
+namespace ParkourRecording
+{
+	//Input is stored in 1/32 steps, fine enough for the ForwardInput() thresholds and one byte per changed axis
+	constexpr int32 InputSteps = 32;
+
+	int8 QuantizeInput(float Value);
+	float DequantizeInput(int8 Value);
+	FRotator DecompressView(const uint16 View[3]);
+	//Saved/ParkourRecordings/<Map>_<Owner>_<Time>.pkr
+	FString MakeRecordingPath(const UObject* Owner);
+	//parkour.RecordSessions, lets playtest builds record every locally controlled character
+	bool ShouldRecordSessions();
+}
+
+//Encodes a recording on the game thread and hands full chunks to a background task that appends them to disk
+class ECHORUNNER_API FParkourRecordingWriter
+{
+public:
+	FParkourRecordingWriter(const FString& InPath, const FParkourRecordingHeader& Header);
+	//Flushes the remaining ops and closes the file on the background task
+	~FParkourRecordingWriter();
+
+	//Writes an INPUT op only when the quantized vector differs from the last one written
+	void WriteInput(uint32 Update, const FVector& Input);
+	//Same for the control rotation and the update's delta time
+	void WriteView(uint32 Update, const FRotator& ControlRotation);
+	void WriteDeltaTime(uint32 Update, float DeltaTime);
+	void WriteOp(uint32 Update, EParkourRecordOp Op, uint8 Mode = 0);
+
+	const FString& GetPath() const { return Path; }
+
+private:
+	struct FFile
+	{
+		FString Path;
+		TUniquePtr<FArchive> Archive;
+		bool bFailed = false;
+	};
+
+	void WriteKey(uint32 Update, EParkourRecordOp Op);
+	void Flush(bool bClose);
+
+	FString Path;
+	TSharedRef<FFile, ESPMode::ThreadSafe> File;
+	//Writes are chained so chunks land in order
+	UE::Tasks::FTask LastWrite;
+	TArray<uint8> Buffer;
+	uint32 LastUpdate = 0;
+	int8 LastInputX = 0;
+	int8 LastInputY = 0;
+	uint16 LastView[3] = {};
+	bool bWroteView = false;
+	uint32 LastDeltaMicroseconds = 0;
+};
+
+//Decodes a whole recording up front, recordings are some tens of KB per minute
+class ECHORUNNER_API FParkourRecordingReader
+{
+public:
+	bool Load(const FString& Path);
+
+	const FParkourRecordingHeader& GetHeader() const { return Header; }
+	//Next input or event op recorded at or before Update, null once Update is caught up
+	const FParkourRecordedOp* NextOp(uint32 Update);
+	//Next recorded mode transition, null when there are no more
+	const FParkourRecordedOp* NextTransition();
+	bool IsFinished() const { return NextOpIndex >= Ops.Num(); }
+
+private:
+	FParkourRecordingHeader Header;
+	TArray<FParkourRecordedOp> Ops;
+	TArray<FParkourRecordedOp> Transitions;
+	int32 NextOpIndex = 0;
+	int32 NextTransitionIndex = 0;
+};
@@ -0,0 +1,223 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourReplication.h"
+#include "HAL/IConsoleManager.h"
+#include "ParkourComponent.h"
+
+namespace ParkourReplication
+{
+	enum EChangedField : uint8
+	{
+		CHANGED_HEADER = 1 << 0,
+		CHANGED_WALLRUNNORMAL = 1 << 1,
+		CHANGED_LEDGENORMAL = 1 << 2,
+		CHANGED_BITS = 3
+	};
+
+	constexpr int32 NumModes = 9;
+	static_assert(NumModes <= (1 << FParkourReplicatedState::ModeBits), "EParkourMode no longer fits in ModeBits");
+
+	//Base state kept per connection, the engine rolls it back to the last acked one on packet loss
+	class FDeltaState : public INetDeltaBaseState
+	{
+	public:
+		FParkourReplicatedState State;
+
+		virtual bool IsStateEqual(INetDeltaBaseState* OtherState) override
+		{
+			return State == static_cast<FDeltaState*>(OtherState)->State;
+		}
+	};
+
+#if PARKOUR_NETSTATS_ENABLED
+	static int64 BitsPerMode[NumModes];
+	static double SecondsPerMode[NumModes];
+
+	static void DumpNetStats()
+	{
+		static const TCHAR* ModeNames[NumModes] = { TEXT("None"), TEXT("LeftWallRun"), TEXT("RightWallRun"), TEXT("VerticalWallRun"),
+			TEXT("LedgeGrab"), TEXT("Mantle"), TEXT("Slide"), TEXT("Sprint"), TEXT("Crouch") };
+		UE_LOG(LogNet, Display, TEXT("Parkour state bandwidth, bytes per character-second summed over connections:"));
+		for (int32 Mode = 0; Mode < NumModes; Mode++)
+		{
+			double BytesPerSecond = (SecondsPerMode[Mode] > 0.0) ? (BitsPerMode[Mode] / 8.0) / SecondsPerMode[Mode] : 0.0;
+			UE_LOG(LogNet, Display, TEXT("  %-16s %8.2f B/s  (%lld bytes over %.1fs)"), ModeNames[Mode], BytesPerSecond, BitsPerMode[Mode] / 8, SecondsPerMode[Mode]);
+		}
+	}
+
+	static FAutoConsoleCommand NetStatsCommand(
+		TEXT("parkour.NetStats"),
+		TEXT("Reports replicated parkour state bandwidth per parkour mode. Pass 'reset' to clear the counters."),
+		FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+		{
+			if (Args.Num() > 0 and Args[0] == TEXT("reset"))
+			{
+				FMemory::Memzero(BitsPerMode);
+				FMemory::Memzero(SecondsPerMode);
+				return;
+			}
+			DumpNetStats();
+		}));
+#endif
+}
+
+void FParkourReplicatedState::Set(EParkourMode InMode, int32 InTimesJumped, bool bInCanDash, const FVector& InWallRunNormal, const FVector& InLedgeClimbWallNormal)
+{
+	Mode = (uint8)InMode;
+	TimesJumped = (uint8)FMath::Clamp(InTimesJumped, 0, (1 << JumpBits) - 1);
+	bCanDash = bInCanDash;
+	WallRunNormal = EncodeNormal(InWallRunNormal);
+	LedgeClimbWallNormal = EncodeNormal(InLedgeClimbWallNormal);
+}
+
+EParkourMode FParkourReplicatedState::GetMode() const
+{
+	return (EParkourMode)Mode;
+}
+
+uint32 FParkourReplicatedState::EncodeNormal(const FVector& Normal)
+{
+	//Octahedral projection onto the unit square
+	float L1 = FMath::Abs(Normal.X) + FMath::Abs(Normal.Y) + FMath::Abs(Normal.Z);
+	if (L1 <= KINDA_SMALL_NUMBER)
+	{
+		return 0;
+	}
+	float U = Normal.X / L1;
+	float V = Normal.Y / L1;
+	if (Normal.Z < 0.0f)
+	{
+		float OldU = U;
+		U = (1.0f - FMath::Abs(V)) * (OldU >= 0.0f ? 1.0f : -1.0f);
+		V = (1.0f - FMath::Abs(OldU)) * (V >= 0.0f ? 1.0f : -1.0f);
+	}
+
+	const uint32 MaxValue = (1u << NormalBitsPerAxis) - 1;
+	uint32 QU = (uint32)FMath::RoundToInt((U * 0.5f + 0.5f) * MaxValue);
+	uint32 QV = (uint32)FMath::RoundToInt((V * 0.5f + 0.5f) * MaxValue);
+	//Zero is reserved for "no normal"
+	uint32 Encoded = (FMath::Min(QU, MaxValue) << NormalBitsPerAxis) | FMath::Min(QV, MaxValue);
+	return (Encoded == 0) ? 1 : Encoded;
+}
+
+FVector FParkourReplicatedState::DecodeNormal(uint32 Encoded)
+{
+	if (Encoded == 0)
+	{
+		return FVector::ZeroVector;
+	}
+	const uint32 MaxValue = (1u << NormalBitsPerAxis) - 1;
+	float U = ((Encoded >> NormalBitsPerAxis) & MaxValue) / (float)MaxValue * 2.0f - 1.0f;
+	float V = (Encoded & MaxValue) / (float)MaxValue * 2.0f - 1.0f;
+	FVector Normal(U, V, 1.0f - FMath::Abs(U) - FMath::Abs(V));
+	if (Normal.Z < 0.0f)
+	{
+		float OldX = Normal.X;
+		Normal.X = (1.0f - FMath::Abs(Normal.Y)) * (OldX >= 0.0f ? 1.0f : -1.0f);
+		Normal.Y = (1.0f - FMath::Abs(OldX)) * (Normal.Y >= 0.0f ? 1.0f : -1.0f);
+	}
+	return Normal.GetSafeNormal();
+}
+
+bool FParkourReplicatedState::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	using namespace ParkourReplication;
+	const int32 NormalBits = NormalBitsPerAxis * 2;
+
+	if (DeltaParms.Writer)
+	{
+		FBitWriter& Writer = *DeltaParms.Writer;
+		const FDeltaState* OldState = static_cast<const FDeltaState*>(DeltaParms.OldState);
+		if (OldState and OldState->State == *this)
+		{
+			return false;
+		}
+
+		uint8 Changed = CHANGED_HEADER | CHANGED_WALLRUNNORMAL | CHANGED_LEDGENORMAL;
+		if (OldState)
+		{
+			const FParkourReplicatedState& Old = OldState->State;
+			Changed = 0;
+			Changed |= (Old.Mode != Mode or Old.TimesJumped != TimesJumped or Old.bCanDash != bCanDash) ? CHANGED_HEADER : 0;
+			Changed |= (Old.WallRunNormal != WallRunNormal) ? CHANGED_WALLRUNNORMAL : 0;
+			Changed |= (Old.LedgeClimbWallNormal != LedgeClimbWallNormal) ? CHANGED_LEDGENORMAL : 0;
+		}
+
+#if PARKOUR_NETSTATS_ENABLED
+		const int64 StartBits = Writer.GetNumBits();
+#endif
+		Writer.SerializeBits(&Changed, CHANGED_BITS);
+		if (Changed & CHANGED_HEADER)
+		{
+			uint8 CanDash = bCanDash ? 1 : 0;
+			Writer.SerializeBits(&Mode, ModeBits);
+			Writer.SerializeBits(&TimesJumped, JumpBits);
+			Writer.SerializeBits(&CanDash, 1);
+		}
+		if (Changed & CHANGED_WALLRUNNORMAL)
+		{
+			Writer.SerializeBits(&WallRunNormal, NormalBits);
+		}
+		if (Changed & CHANGED_LEDGENORMAL)
+		{
+			Writer.SerializeBits(&LedgeClimbWallNormal, NormalBits);
+		}
+#if PARKOUR_NETSTATS_ENABLED
+		FParkourNetStats::AddBits(GetMode(), Writer.GetNumBits() - StartBits);
+#endif
+
+		TSharedPtr<FDeltaState> NewState = MakeShared<FDeltaState>();
+		NewState->State = *this;
+		*DeltaParms.NewState = NewState;
+		return true;
+	}
+	else if (DeltaParms.Reader)
+	{
+		//Fields not in the changed mask keep the value from the last received delta
+		FBitReader& Reader = *DeltaParms.Reader;
+		uint8 Changed = 0;
+		Reader.SerializeBits(&Changed, CHANGED_BITS);
+		if (Changed & CHANGED_HEADER)
+		{
+			uint8 NewMode = 0;
+			uint8 NewTimesJumped = 0;
+			uint8 CanDash = 0;
+			Reader.SerializeBits(&NewMode, ModeBits);
+			Reader.SerializeBits(&NewTimesJumped, JumpBits);
+			Reader.SerializeBits(&CanDash, 1);
+			Mode = (NewMode < NumModes) ? NewMode : 0;
+			TimesJumped = NewTimesJumped;
+			bCanDash = (CanDash != 0);
+		}
+		if (Changed & CHANGED_WALLRUNNORMAL)
+		{
+			WallRunNormal = 0;
+			Reader.SerializeBits(&WallRunNormal, NormalBits);
+		}
+		if (Changed & CHANGED_LEDGENORMAL)
+		{
+			LedgeClimbWallNormal = 0;
+			Reader.SerializeBits(&LedgeClimbWallNormal, NormalBits);
+		}
+		return !Reader.IsError();
+	}
+	return true;
+}
+
+#if PARKOUR_NETSTATS_ENABLED
+void FParkourNetStats::AddBits(EParkourMode Mode, int64 Bits)
+{
+	if ((uint8)Mode < ParkourReplication::NumModes)
+	{
+		ParkourReplication::BitsPerMode[(uint8)Mode] += Bits;
+	}
+}
+
+void FParkourNetStats::AddCharacterSeconds(EParkourMode Mode, float Seconds)
+{
+	if ((uint8)Mode < ParkourReplication::NumModes)
+	{
+		ParkourReplication::SecondsPerMode[(uint8)Mode] += Seconds;
+	}
+}
+#endif
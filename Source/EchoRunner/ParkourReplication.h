@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "ParkourReplication.generated.h"
+
+enum class EParkourMode : uint8;
+
+//Parkour state replicated to simulated proxies and spectators.
+//Values are stored quantized so comparisons ignore sub-quantum noise,
+//and NetDeltaSerialize only sends fields that differ from the last acknowledged state.
+USTRUCT()
+struct ECHORUNNER_API FParkourReplicatedState
+{
+	GENERATED_BODY()
+
+	static constexpr int32 ModeBits = 4;
+	static constexpr int32 JumpBits = 3;
+	//Octahedral normals use this many bits per axis, 20 bits per normal
+	static constexpr int32 NormalBitsPerAxis = 10;
+
+	void Set(EParkourMode InMode, int32 InTimesJumped, bool bInCanDash, const FVector& InWallRunNormal, const FVector& InLedgeClimbWallNormal);
+
+	EParkourMode GetMode() const;
+	int32 GetTimesJumped() const { return TimesJumped; }
+	bool GetCanDash() const { return bCanDash; }
+	FVector GetWallRunNormal() const { return DecodeNormal(WallRunNormal); }
+	FVector GetLedgeClimbWallNormal() const { return DecodeNormal(LedgeClimbWallNormal); }
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+
+	bool operator==(const FParkourReplicatedState& Other) const
+	{
+		return Mode == Other.Mode and TimesJumped == Other.TimesJumped and bCanDash == Other.bCanDash
+			and WallRunNormal == Other.WallRunNormal and LedgeClimbWallNormal == Other.LedgeClimbWallNormal;
+	}
+
+	static uint32 EncodeNormal(const FVector& Normal);
+	static FVector DecodeNormal(uint32 Encoded);
+
+private:
+	uint8 Mode = 0;
+	uint8 TimesJumped = 0;
+	bool bCanDash = true;
+	uint32 WallRunNormal = 0;
+	uint32 LedgeClimbWallNormal = 0;
+};
+
+template<>
+struct TStructOpsTypeTraits<FParkourReplicatedState> : public TStructOpsTypeTraitsBase2<FParkourReplicatedState>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
+
+#define PARKOUR_NETSTATS_ENABLED (!UE_BUILD_SHIPPING)
+
+#if PARKOUR_NETSTATS_ENABLED
+//Server-side bandwidth accounting per parkour mode, reported by parkour.NetStats.
+//Compiled out of shipping builds along with the command.
+struct FParkourNetStats
+{
+	static void AddBits(EParkourMode Mode, int64 Bits);
+	static void AddCharacterSeconds(EParkourMode Mode, float Seconds);
+};
+#endif
@@ -0,0 +1,137 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourRootMotion.h"
+#include "GameFramework/Character.h"
+
+const FName FRootMotionSource_ParkourMantle::SourceName(TEXT("ParkourMantle"));
+
+FRootMotionSource_ParkourMantle::FRootMotionSource_ParkourMantle()
+	: StartLocation(ForceInitToZero)
+	, TargetLocation(ForceInitToZero)
+	, InterpSpeed(0.0f)
+{
+	InstanceName = SourceName;
+	AccumulateMode = ERootMotionAccumulateMode::Override;
+	//The capsule stops on the ledge instead of carrying the climb velocity into the walk
+	FinishVelocityParams.Mode = ERootMotionFinishVelocityMode::SetVelocity;
+	FinishVelocityParams.SetVelocity = FVector::ZeroVector;
+	BuildCurve();
+}
+
+float FRootMotionSource_ParkourMantle::GetDuration(float Distance, float InterpSpeed)
+{
+	//VInterpTo closes Speed * DeltaTime of the gap each step, so the gap decays as exp(-Speed * t)
+	if (InterpSpeed <= 0.0f or Distance <= ArriveDistance)
+	{
+		return 0.05f;
+	}
+	return FMath::Max(FMath::Loge(Distance / ArriveDistance) / InterpSpeed, 0.05f);
+}
+
+TSharedPtr<FRootMotionSource_ParkourMantle> FRootMotionSource_ParkourMantle::Make(const FVector& Start, const FVector& Target, float InInterpSpeed)
+{
+	TSharedPtr<FRootMotionSource_ParkourMantle> Source = MakeShared<FRootMotionSource_ParkourMantle>();
+	Source->StartLocation = Start;
+	Source->TargetLocation = Target;
+	Source->InterpSpeed = InInterpSpeed;
+	Source->Duration = GetDuration(FVector::Distance(Start, Target), InInterpSpeed);
+	Source->BuildCurve();
+	return Source;
+}
+
+void FRootMotionSource_ParkourMantle::BuildCurve()
+{
+	//Normalised so the last sample lands exactly on the target
+	const float Decay = InterpSpeed * Duration;
+	const float End = 1.0f - FMath::Exp(-Decay);
+	for (int32 Index = 0; Index <= CurveSamples; Index++)
+	{
+		const float Fraction = (float)Index / CurveSamples;
+		Curve[Index] = (End > UE_KINDA_SMALL_NUMBER) ? (1.0f - FMath::Exp(-Decay * Fraction)) / End : Fraction;
+	}
+}
+
+float FRootMotionSource_ParkourMantle::SampleCurve(float Fraction) const
+{
+	const float Position = FMath::Clamp(Fraction, 0.0f, 1.0f) * CurveSamples;
+	const int32 Index = FMath::Min((int32)Position, CurveSamples - 1);
+	return FMath::Lerp(Curve[Index], Curve[Index + 1], Position - Index);
+}
+
+FRootMotionSource* FRootMotionSource_ParkourMantle::Clone() const
+{
+	return new FRootMotionSource_ParkourMantle(*this);
+}
+
+bool FRootMotionSource_ParkourMantle::Matches(const FRootMotionSource* Other) const
+{
+	if (!FRootMotionSource::Matches(Other))
+	{
+		return false;
+	}
+	const FRootMotionSource_ParkourMantle* OtherCast = static_cast<const FRootMotionSource_ParkourMantle*>(Other);
+	return FMath::IsNearlyEqual(InterpSpeed, OtherCast->InterpSpeed)
+		and FVector::PointsAreNear(StartLocation, OtherCast->StartLocation, 1.0f)
+		and FVector::PointsAreNear(TargetLocation, OtherCast->TargetLocation, 1.0f);
+}
+
+bool FRootMotionSource_ParkourMantle::MatchesAndHasSameState(const FRootMotionSource* Other) const
+{
+	//Everything that varies is already compared by Matches and the base time checks
+	return FRootMotionSource::MatchesAndHasSameState(Other) and Matches(Other);
+}
+
+bool FRootMotionSource_ParkourMantle::UpdateStateFrom(const FRootMotionSource* SourceToTakeStateFrom, bool bMarkForSimulatedCatchup)
+{
+	if (!FRootMotionSource::UpdateStateFrom(SourceToTakeStateFrom, bMarkForSimulatedCatchup))
+	{
+		return false;
+	}
+	const FRootMotionSource_ParkourMantle* OtherCast = static_cast<const FRootMotionSource_ParkourMantle*>(SourceToTakeStateFrom);
+	StartLocation = OtherCast->StartLocation;
+	TargetLocation = OtherCast->TargetLocation;
+	InterpSpeed = OtherCast->InterpSpeed;
+	BuildCurve();
+	return true;
+}
+
+void FRootMotionSource_ParkourMantle::PrepareRootMotion(float SimulationTime, float MovementTickTime, const ACharacter& Character, const UCharacterMovementComponent& MoveComponent)
+{
+	RootMotionParams.Clear();
+	if (Duration > UE_SMALL_NUMBER and MovementTickTime > UE_SMALL_NUMBER)
+	{
+		//Aim at where the curve says the capsule should be at the end of this step, so sweeps that cut a step short are caught up
+		const float MoveFraction = (GetTime() + SimulationTime) / Duration;
+		const FVector PathLocation = FMath::Lerp(StartLocation, TargetLocation, SampleCurve(MoveFraction));
+		const FVector Force = (PathLocation - Character.GetActorLocation()) / MovementTickTime;
+		RootMotionParams.Set(FTransform(Force));
+	}
+	SetTime(GetTime() + SimulationTime);
+}
+
+bool FRootMotionSource_ParkourMantle::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	if (!FRootMotionSource::NetSerialize(Ar, Map, bOutSuccess))
+	{
+		return false;
+	}
+	Ar << StartLocation;
+	Ar << TargetLocation;
+	Ar << InterpSpeed;
+	if (Ar.IsLoading())
+	{
+		BuildCurve();
+	}
+	bOutSuccess = true;
+	return true;
+}
+
+UScriptStruct* FRootMotionSource_ParkourMantle::GetScriptStruct() const
+{
+	return FRootMotionSource_ParkourMantle::StaticStruct();
+}
+
+FString FRootMotionSource_ParkourMantle::ToSimpleString() const
+{
+	return FString::Printf(TEXT("[ID:%u]FRootMotionSource_ParkourMantle %s"), LocalID, *InstanceName.GetPlainNameString());
+}
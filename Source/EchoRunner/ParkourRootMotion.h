@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/RootMotionSource.h"
+#include "ParkourRootMotion.generated.h"
+
+//Mantle onto a ledge as a root motion source.
+//The old per-update VInterpTo is turned into a fixed duration, the time its exponential approach takes to
+//come within ArriveDistance of the ledge, and its ease-out shape is sampled once into Curve when the mantle
+//starts. Every movement tick is then one table lookup, and the mantle ends on a known frame.
+USTRUCT()
+struct ECHORUNNER_API FRootMotionSource_ParkourMantle : public FRootMotionSource
+{
+	GENERATED_BODY()
+
+	//InstanceName of every mantle source, so a replayed move never stacks a second one
+	static const FName SourceName;
+	//Distance at which the old interpolation counted the mantle as done
+	static constexpr float ArriveDistance = 8.0f;
+	static constexpr int32 CurveSamples = 16;
+
+	FRootMotionSource_ParkourMantle();
+
+	//Seconds VInterpTo at InterpSpeed needs to bring Distance down to ArriveDistance
+	static float GetDuration(float Distance, float InterpSpeed);
+	static TSharedPtr<FRootMotionSource_ParkourMantle> Make(const FVector& Start, const FVector& Target, float InterpSpeed);
+
+	UPROPERTY()
+	FVector StartLocation;
+	UPROPERTY()
+	FVector TargetLocation;
+	UPROPERTY()
+	float InterpSpeed;
+
+	virtual FRootMotionSource* Clone() const override;
+	virtual bool Matches(const FRootMotionSource* Other) const override;
+	virtual bool MatchesAndHasSameState(const FRootMotionSource* Other) const override;
+	virtual bool UpdateStateFrom(const FRootMotionSource* SourceToTakeStateFrom, bool bMarkForSimulatedCatchup = false) override;
+	virtual void PrepareRootMotion(float SimulationTime, float MovementTickTime, const ACharacter& Character, const UCharacterMovementComponent& MoveComponent) override;
+	virtual bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess) override;
+	virtual UScriptStruct* GetScriptStruct() const override;
+	virtual FString ToSimpleString() const override;
+
+private:
+	//Fraction of the path covered at each of CurveSamples + 1 evenly spaced times, rebuilt from InterpSpeed and Duration
+	void BuildCurve();
+	float SampleCurve(float Fraction) const;
+
+	float Curve[CurveSamples + 1];
+};
+
+template<>
+struct TStructOpsTypeTraits<FRootMotionSource_ParkourMantle> : public TStructOpsTypeTraitsBase2<FRootMotionSource_ParkourMantle>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithCopy = true
+	};
+};
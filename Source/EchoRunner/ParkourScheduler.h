@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+//Fixed-capacity delayed-call scheduler advanced by its owner's update.
+//Entries are kept sorted by fire time so an idle Advance is one comparison.
+//Engine-independent so both UParkourComponent and FParkourSim can use it.
+
+#include <cstdint>
+
+template<typename OwnerType, int32_t Capacity>
+class TParkourScheduler
+{
+public:
+	typedef void (OwnerType::*FCallback)();
+	//Zero is never a live handle
+	typedef uint32_t FHandle;
+
+	TParkourScheduler()
+		: Count(0)
+		, Now(0.0)
+		, LastHandle(0)
+	{
+	}
+
+	//Like FTimerManager, a non-positive delay schedules nothing. Returns 0 when full.
+	FHandle Schedule(FCallback Callback, float Delay)
+	{
+		if (Delay <= 0.0f or Count >= Capacity)
+		{
+			return 0;
+		}
+
+		LastHandle = (LastHandle == UINT32_MAX) ? 1 : LastHandle + 1;
+		double FireTime = Now + Delay;
+		int32_t Insert = Count;
+		while (Insert > 0 and Entries[Insert - 1].FireTime > FireTime)
+		{
+			Entries[Insert] = Entries[Insert - 1];
+			Insert--;
+		}
+		Entries[Insert].FireTime = FireTime;
+		Entries[Insert].Handle = LastHandle;
+		Entries[Insert].Callback = Callback;
+		Count++;
+		return LastHandle;
+	}
+
+	//Cancels whatever InOutHandle pointed at before scheduling, so repeated calls never stack
+	void Reschedule(FHandle& InOutHandle, FCallback Callback, float Delay)
+	{
+		Cancel(InOutHandle);
+		InOutHandle = Schedule(Callback, Delay);
+	}
+
+	bool Cancel(FHandle& InOutHandle)
+	{
+		FHandle Handle = InOutHandle;
+		InOutHandle = 0;
+		if (Handle == 0)
+		{
+			return false;
+		}
+		for (int32_t Index = 0; Index < Count; Index++)
+		{
+			if (Entries[Index].Handle == Handle)
+			{
+				RemoveAt(Index);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool IsPending(FHandle Handle) const
+	{
+		for (int32_t Index = 0; Handle != 0 and Index < Count; Index++)
+		{
+			if (Entries[Index].Handle == Handle)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void Advance(OwnerType& Owner, float DeltaTime)
+	{
+		Now += DeltaTime;
+		//Callbacks may schedule or cancel, so pop before invoking
+		while (Count > 0 and Entries[0].FireTime <= Now)
+		{
+			FCallback Callback = Entries[0].Callback;
+			RemoveAt(0);
+			(Owner.*Callback)();
+		}
+	}
+
+	void Reset()
+	{
+		Count = 0;
+	}
+
+	int32_t Num() const { return Count; }
+
+private:
+	struct FEntry
+	{
+		double FireTime = 0.0;
+		FHandle Handle = 0;
+		FCallback Callback = nullptr;
+	};
+
+	void RemoveAt(int32_t Index)
+	{
+		for (int32_t Move = Index; Move < Count - 1; Move++)
+		{
+			Entries[Move] = Entries[Move + 1];
+		}
+		Count--;
+	}
+
+	FEntry Entries[Capacity];
+	int32_t Count;
+	double Now;
+	FHandle LastHandle;
+};
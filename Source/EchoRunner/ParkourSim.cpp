@@ -0,0 +1,698 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourSim.h"
+#include <cassert>
+
+//Each function mirrors the UParkourComponent function of the same name.
+//Camera shakes, camera tilt and mantle look-at rotation are cosmetic and are not simulated,
+//and the 0.1s wall and ledge location corrections are applied instantly.
+
+FParkourSim::FParkourSim(IParkourSimWorld& InWorld, IParkourSimMovement& InMovement, const FParkourSimConfig& InConfig)
+	: World(InWorld)
+	, Movement(InMovement)
+	, Config(InConfig)
+	, WallRunGateTimer(0)
+	, WallRunGravityTimer(0)
+	, VerticalWallRunGateTimer(0)
+	, CheckMantleGateTimer(0)
+	, CheckQueuesTimer(0)
+	, SprintGateTimer(0)
+	, DeltaSeconds(0.0f)
+	, QueryCount(0)
+	, Gates(0)
+	, CurrentMode(EParkourSimMode::NONE)
+	, PrevMode(EParkourSimMode::NONE)
+	, TimesJumped(0)
+	, bCanDash(true)
+	, bWallRunGravityOn(true)
+	, bSprintQueued(false)
+	, bSlideQueued(false)
+	, bLedgeCloseToGround(false)
+	, MantleTraceDistance(0.0f)
+{
+}
+
+void FParkourSim::Update(float DeltaTime)
+{
+	DeltaSeconds = DeltaTime;
+	Scheduler.Advance(*this, DeltaTime);
+
+	if (Gates & GATE_WALLRUN)
+	{
+		WallRunUpdate();
+	}
+	if (Gates & GATE_VERTICALWALLRUN)
+	{
+		VerticalWallRunUpdate();
+	}
+	if (Gates & GATE_CHECKMANTLE)
+	{
+		MantleCheck();
+	}
+	if (Gates & GATE_MANTLE)
+	{
+		MantleMovement();
+	}
+	if (Gates & GATE_SLIDE)
+	{
+		SlideUpdate();
+	}
+	if (Gates & GATE_SPRINT)
+	{
+		SprintUpdate();
+	}
+}
+
+void FParkourSim::JumpEvent()
+{
+	JumpMovement();
+	if (CurrentMode == EParkourSimMode::NONE)
+	{
+		if (IsFalling() == false)
+		{
+			OpenGates();
+		}
+	}
+	else
+	{
+		JumpEvents();
+	}
+}
+
+void FParkourSim::LandEvent()
+{
+	TimesJumped = 0;
+	bCanDash = true;
+	EndEvents();
+	CloseGates();
+}
+
+void FParkourSim::DashEvent()
+{
+	if (bCanDash)
+	{
+		Movement.Launch(GetDashLaunchVelocity(), true, false);
+		bCanDash = false;
+	}
+}
+
+void FParkourSim::SprintEvent()
+{
+	SprintStart();
+}
+
+void FParkourSim::CrouchSlideEvent()
+{
+	if (FParkourSimRules::IsLedgeMantleOrVertical(CurrentMode))
+	{
+		VerticalWallRunEnd(0.5f);
+	}
+	else if (FParkourSimRules::IsWallRunning(CurrentMode))
+	{
+		WallRunEnd(0.5f);
+	}
+	else
+	{
+		if (FParkourSimRules::CanSlide(CurrentMode, ForwardInput(), bSprintQueued))
+		{
+			if (IsWalking())
+			{
+				SlideStart();
+			}
+			else
+			{
+				bSlideQueued = true;
+			}
+		}
+		else
+		{
+			ToggleCrouch();
+		}
+	}
+}
+
+void FParkourSim::MovementChanged(EParkourSimMovementMode PrevMovement, EParkourSimMovementMode CurrentMovement)
+{
+	if (PrevMovement == EParkourSimMovementMode::WALKING and CurrentMovement == EParkourSimMovementMode::FALLING)
+	{
+		SprintJump();
+		EndEvents();
+		OpenGates();
+	}
+	else if (PrevMovement == EParkourSimMovementMode::FALLING and CurrentMovement == EParkourSimMovementMode::WALKING)
+	{
+		CheckQueues();
+	}
+}
+
+void FParkourSim::WallRunEnableGravity()
+{
+	bWallRunGravityOn = FParkourSimRules::IsWallRunning(CurrentMode);
+}
+
+void FParkourSim::CancelStaleTimers()
+{
+	if (FParkourSimRules::IsWallRunning(CurrentMode))
+	{
+		Scheduler.Cancel(WallRunGateTimer);
+	}
+	else if (FParkourSimRules::IsLedgeMantleOrVertical(CurrentMode))
+	{
+		Scheduler.Cancel(VerticalWallRunGateTimer);
+		Scheduler.Cancel(CheckQueuesTimer);
+	}
+	else if (CurrentMode == EParkourSimMode::SPRINT)
+	{
+		Scheduler.Cancel(SprintGateTimer);
+	}
+}
+
+void FParkourSim::OpenGates()
+{
+	OpenGate(GATE_WALLRUN | GATE_VERTICALWALLRUN | GATE_SLIDE | GATE_SPRINT);
+}
+
+void FParkourSim::CloseGates()
+{
+	Scheduler.Cancel(WallRunGateTimer);
+	Scheduler.Cancel(VerticalWallRunGateTimer);
+	Scheduler.Cancel(SprintGateTimer);
+	CloseGate(GATE_WALLRUN | GATE_VERTICALWALLRUN | GATE_SLIDE | GATE_SPRINT);
+}
+
+bool FParkourSim::LineTrace(const FParkourSimVector& Start, const FParkourSimVector& End, FParkourSimHit& OutHit)
+{
+	QueryCount++;
+	return World.LineTrace(Start, End, OutHit);
+}
+
+bool FParkourSim::SweepCapsule(const FParkourSimVector& Start, const FParkourSimVector& End, float Radius, float HalfHeight, FParkourSimHit& OutHit)
+{
+	QueryCount++;
+	return World.SweepCapsule(Start, End, Radius, HalfHeight, OutHit);
+}
+
+bool FParkourSim::WallRunMovement(const FParkourSimVector& Start, const FParkourSimVector& End, float WallRunDir)
+{
+	FParkourSimHit WallHit;
+	LineTrace(Start, End, WallHit);
+	if (WallHit.bBlockingHit)
+	{
+		WallRunNormal = WallHit.Normal;
+		WallRunLocation = WallHit.ImpactPoint;
+
+		if (FParkourSimRules::IsWallRunnableNormal(WallRunNormal.Z) and IsFalling())
+		{
+			FParkourSimVector CrossProdWallRunNormal = FParkourSimVector::Cross(WallRunNormal, FParkourSimVector(0, 0, 1));
+			float Speed = bSprintQueued ? Config.WallRunSprintSpeed : Config.WallRunSpeed;
+			bool bZOverride = (!FParkourSimRules::IsWallRunning(CurrentMode) or !bWallRunGravityOn);
+			Movement.Launch(CrossProdWallRunNormal * (WallRunDir * Speed), true, bZOverride);
+			return true;
+		}
+	}
+	return false;
+}
+
+void FParkourSim::WallRunUpdate()
+{
+	if (FParkourSimRules::CanWallRun(CurrentMode, ForwardInput()))
+	{
+		FParkourSimVector Location = Movement.GetLocation();
+		if (WallRunMovement(Location, GetWallRunEndVector(75.0f), -1.0f))
+		{
+			if (SetParkourMode(EParkourSimMode::RIGHTWALLRUN))
+			{
+				ApplyGravityAndCorrectLocation();
+			}
+			else
+			{
+				Movement.SetGravityScale(FParkourSimRules::InterpTo(Movement.GetGravityScale(), Config.WallRunTargetGravity, DeltaSeconds, 20.0f));
+			}
+		}
+		else if (CurrentMode == EParkourSimMode::RIGHTWALLRUN)
+		{
+			WallRunEnd(0.5f);
+		}
+		else if (WallRunMovement(Location, GetWallRunEndVector(-75.0f), 1.0f))
+		{
+			if (SetParkourMode(EParkourSimMode::LEFTWALLRUN))
+			{
+				ApplyGravityAndCorrectLocation();
+			}
+			else
+			{
+				Movement.SetGravityScale(FParkourSimRules::InterpTo(Movement.GetGravityScale(), Config.WallRunTargetGravity, DeltaSeconds, 20.0f));
+			}
+		}
+		else
+		{
+			WallRunEnd(0.5f);
+		}
+	}
+	else
+	{
+		WallRunEnd(1.0f);
+	}
+}
+
+void FParkourSim::ApplyGravityAndCorrectLocation()
+{
+	Scheduler.Reschedule(WallRunGravityTimer, &FParkourSim::WallRunEnableGravity, 1.0f);
+	if (FParkourSimRules::IsWallRunning(CurrentMode))
+	{
+		Movement.SetLocation(WallRunLocation + WallRunNormal * Movement.GetCapsuleRadius());
+	}
+	Movement.SetGravityScale(FParkourSimRules::InterpTo(Movement.GetGravityScale(), Config.WallRunTargetGravity, DeltaSeconds, 20.0f));
+}
+
+void FParkourSim::WallRunJump()
+{
+	if (FParkourSimRules::IsWallRunning(CurrentMode))
+	{
+		WallRunEnd(0.35f);
+		FParkourSimVector LaunchVelocity(Config.WallJumpScale * WallRunNormal.X, Config.WallJumpScale * WallRunNormal.Y, Config.WallJumpForce);
+		Movement.Launch(LaunchVelocity, false, true);
+	}
+}
+
+void FParkourSim::WallRunEnd(float ResetTime)
+{
+	if (FParkourSimRules::IsWallRunning(CurrentMode))
+	{
+		if (SetParkourMode(EParkourSimMode::NONE))
+		{
+			CloseGate(GATE_WALLRUN);
+			Scheduler.Reschedule(WallRunGateTimer, &FParkourSim::OpenWallRunGate, ResetTime);
+			Scheduler.Cancel(WallRunGravityTimer);
+			bWallRunGravityOn = false;
+		}
+	}
+}
+
+void FParkourSim::VerticalWallRunMovement()
+{
+	FParkourSimHit FwdTracerHit;
+	bool bTracerValidHit;
+	ForwardTracer(FwdTracerHit, bTracerValidHit);
+	if (bTracerValidHit)
+	{
+		VerticalWallRunLocation = FwdTracerHit.Location;
+		VerticalWallRunNormal = FwdTracerHit.Normal;
+		SetParkourMode(EParkourSimMode::VERTICALWALLRUN);
+		FParkourSimVector VertWROverride = VerticalWallRunNormal * -600.0f;
+		Movement.Launch(FParkourSimVector(VertWROverride.X, VertWROverride.Y, Config.VerticalWallRunSpeed), true, true);
+	}
+	else
+	{
+		VerticalWallRunEnd(0.35f);
+	}
+}
+
+void FParkourSim::VerticalWallRunUpdate()
+{
+	if (!FParkourSimRules::CanVerticalWallRun(CurrentMode, ForwardInput(), IsFalling()))
+	{
+		VerticalWallRunEnd(0.35f);
+		return;
+	}
+
+	FParkourSimVector Eyes, Feet;
+	GetMantleVectors(Eyes, Feet);
+	FParkourSimHit OutHit;
+	if (!SweepCapsule(Eyes, Feet, 20.0f, 10.0f, OutHit))
+	{
+		VerticalWallRunMovement();
+		return;
+	}
+
+	MantleTraceDistance = OutHit.Distance;
+	LedgeFloorPosition = OutHit.ImpactPoint;
+	FParkourSimHit FTOutHit;
+	bool bFTValidHit;
+	ForwardTracer(FTOutHit, bFTValidHit);
+	if (Movement.IsWalkable(OutHit) and bFTValidHit)
+	{
+		LedgeClimbWallPosition = FTOutHit.ImpactPoint;
+		LedgeClimbWallNormal = FTOutHit.Normal;
+		float CapHalfHeight = Movement.GetCapsuleHalfHeight();
+		MantlePosition = LedgeFloorPosition + FParkourSimVector(0.0f, 0.0f, CapHalfHeight);
+		CloseGate(GATE_VERTICALWALLRUN);
+		GrabLedge();
+
+		FParkourSimHit LedgeOutHit;
+		FParkourSimVector Location = Movement.GetLocation();
+		FParkourSimVector EndVec = Location - FParkourSimVector(0.0f, 0.0f, CapHalfHeight + 40.0f);
+		bLedgeCloseToGround = LineTrace(Location, EndVec, LedgeOutHit);
+
+		if (CanQuickMantle())
+		{
+			OpenGate(GATE_CHECKMANTLE);
+		}
+		else
+		{
+			if (CurrentMode == EParkourSimMode::LEDGEGRAB)
+			{
+				Movement.SetLocation(GetLedgeTargetVector());
+			}
+			Scheduler.Reschedule(CheckMantleGateTimer, &FParkourSim::OpenCheckMantleGate, 0.25f);
+		}
+	}
+	else
+	{
+		VerticalWallRunMovement();
+	}
+}
+
+void FParkourSim::VerticalWallRunEnd(float ResetTime)
+{
+	if (FParkourSimRules::IsLedgeMantleOrVertical(CurrentMode))
+	{
+		if (SetParkourMode(EParkourSimMode::NONE))
+		{
+			CloseGate(GATE_VERTICALWALLRUN | GATE_CHECKMANTLE | GATE_MANTLE);
+			bLedgeCloseToGround = false;
+			Scheduler.Cancel(CheckMantleGateTimer);
+			Scheduler.Reschedule(VerticalWallRunGateTimer, &FParkourSim::OpenVerticalWallRunGate, ResetTime);
+			Scheduler.Reschedule(CheckQueuesTimer, &FParkourSim::CheckQueues, 0.02f);
+		}
+	}
+}
+
+void FParkourSim::ForwardTracer(FParkourSimHit& OutHit, bool& bValidHit)
+{
+	FParkourSimVector Eyes, Feet;
+	GetMantleVectors(Eyes, Feet);
+	FParkourSimVector EndVec = Feet + Movement.GetForward() * 50.0f;
+	SweepCapsule(Feet, EndVec, 10.0f, 5.0f, OutHit);
+	bValidHit = OutHit.bBlockingHit and (OutHit.Normal.Z >= -0.1f);
+}
+
+void FParkourSim::MantleCheck()
+{
+	if (FParkourSimRules::CanMantle(CurrentMode, ForwardInput(), CanQuickMantle()))
+	{
+		MantleStart();
+	}
+}
+
+void FParkourSim::MantleStart()
+{
+	if (SetParkourMode(EParkourSimMode::MANTLE))
+	{
+		CloseGate(GATE_CHECKMANTLE);
+		OpenGate(GATE_MANTLE);
+	}
+}
+
+void FParkourSim::MantleMovement()
+{
+	float InterpSpeed = CanQuickMantle() ? Config.QuickMantleSpeed : Config.MantleSpeed;
+	FParkourSimVector NewLoc = FParkourSimRules::InterpTo(Movement.GetLocation(), MantlePosition, DeltaSeconds, InterpSpeed);
+	Movement.SetLocation(NewLoc);
+
+	if ((NewLoc - MantlePosition).Size() < 8.0f)
+	{
+		VerticalWallRunEnd(0.5f);
+	}
+}
+
+void FParkourSim::LedgeGrabJump()
+{
+	if (FParkourSimRules::IsLedgeMantleOrVertical(CurrentMode))
+	{
+		VerticalWallRunEnd(0.35f);
+		FParkourSimVector LaunchVelocity(VerticalWallRunNormal.X * Config.LedgeGrabJumpOffForce, VerticalWallRunNormal.Y * Config.LedgeGrabJumpOffForce, Config.LedgeGrabJumpOffHeight);
+		Movement.Launch(LaunchVelocity, false, true);
+	}
+}
+
+void FParkourSim::GrabLedge()
+{
+	if (SetParkourMode(EParkourSimMode::LEDGEGRAB))
+	{
+		Movement.StopMovement();
+	}
+}
+
+void FParkourSim::SlideUpdate()
+{
+	if (CurrentMode == EParkourSimMode::SLIDE and Movement.GetVelocity().Size() <= 35.0f)
+	{
+		SlideEnd(false);
+	}
+}
+
+void FParkourSim::SlideStart()
+{
+	if (FParkourSimRules::CanSlide(CurrentMode, ForwardInput(), bSprintQueued) and IsWalking())
+	{
+		SprintEnd();
+		SetParkourMode(EParkourSimMode::SLIDE);
+		Movement.SetCrouched(true);
+		FParkourSimVector SlideVector = GetSlideVector();
+		FParkourSimVector Impulse = (SlideVector.Z <= 0.02f) ? SlideVector * Config.SlideImpulseAmount : FParkourSimVector();
+		Movement.BeginSlide(Impulse);
+		OpenGate(GATE_SLIDE);
+		bSprintQueued = false;
+		bSlideQueued = false;
+	}
+}
+
+void FParkourSim::SlideEnd(bool bCrouch)
+{
+	if (CurrentMode == EParkourSimMode::SLIDE)
+	{
+		if (SetParkourMode(bCrouch ? EParkourSimMode::CROUCH : EParkourSimMode::NONE))
+		{
+			CloseGate(GATE_SLIDE);
+			if (bCrouch == false)
+			{
+				Movement.SetCrouched(false);
+			}
+		}
+	}
+}
+
+void FParkourSim::SlideJump()
+{
+	if (CurrentMode == EParkourSimMode::SLIDE)
+	{
+		SlideEnd(false);
+	}
+}
+
+void FParkourSim::SprintUpdate()
+{
+	if (CurrentMode == EParkourSimMode::SPRINT and (ForwardInput() > 0.0f) == false)
+	{
+		SprintEnd();
+	}
+}
+
+void FParkourSim::SprintStart()
+{
+	SlideEnd(false);
+	CrouchEnd();
+
+	if (FParkourSimRules::CanSprint(CurrentMode, IsWalking()))
+	{
+		if (SetParkourMode(EParkourSimMode::SPRINT))
+		{
+			Movement.SetMaxWalkSpeed(Config.SprintSpeed);
+			OpenGate(GATE_SPRINT);
+			bSprintQueued = false;
+			bSlideQueued = false;
+		}
+	}
+}
+
+void FParkourSim::SprintEnd()
+{
+	if (CurrentMode == EParkourSimMode::SPRINT)
+	{
+		if (SetParkourMode(EParkourSimMode::NONE))
+		{
+			CloseGate(GATE_SPRINT);
+			Scheduler.Reschedule(SprintGateTimer, &FParkourSim::OpenSprintGate, 0.1f);
+		}
+	}
+}
+
+void FParkourSim::SprintJump()
+{
+	if (CurrentMode == EParkourSimMode::SPRINT)
+	{
+		SprintEnd();
+		bSprintQueued = true;
+	}
+}
+
+void FParkourSim::CrouchStart()
+{
+	if (CurrentMode == EParkourSimMode::NONE)
+	{
+		Movement.SetCrouched(true);
+		SetParkourMode(EParkourSimMode::CROUCH);
+		bSprintQueued = false;
+		bSlideQueued = false;
+	}
+}
+
+void FParkourSim::CrouchEnd()
+{
+	if (CurrentMode == EParkourSimMode::CROUCH)
+	{
+		Movement.SetCrouched(false);
+		SetParkourMode(EParkourSimMode::NONE);
+		bSprintQueued = false;
+		bSlideQueued = false;
+	}
+}
+
+void FParkourSim::CrouchJump()
+{
+	if (CurrentMode == EParkourSimMode::CROUCH)
+	{
+		CrouchEnd();
+	}
+}
+
+void FParkourSim::ToggleCrouch()
+{
+	if (FParkourSimRules::HasCategory(CurrentMode, MODECAT_CROUCHSTART))
+	{
+		CrouchStart();
+	}
+	else if (FParkourSimRules::HasCategory(CurrentMode, MODECAT_CROUCHEND))
+	{
+		CrouchEnd();
+	}
+}
+
+void FParkourSim::JumpMovement()
+{
+	if (FParkourSimRules::CanJump(TimesJumped, Config.MaxJumps))
+	{
+		Movement.Launch(FParkourSimVector(0.0f, 0.0f, Movement.GetJumpZVelocity()), false, true);
+		TimesJumped++;
+	}
+}
+
+void FParkourSim::CheckQueues()
+{
+	if (bSlideQueued)
+	{
+		SlideStart();
+	}
+	else if (bSprintQueued)
+	{
+		SprintStart();
+	}
+}
+
+void FParkourSim::JumpEvents()
+{
+	WallRunJump();
+	LedgeGrabJump();
+	SlideJump();
+	CrouchJump();
+	SprintJump();
+	TimesJumped++;
+}
+
+void FParkourSim::EndEvents()
+{
+	WallRunEnd(0.0f);
+	VerticalWallRunEnd(0.0f);
+	SprintEnd();
+	SlideEnd(false);
+}
+
+bool FParkourSim::SetParkourMode(EParkourSimMode NewMode)
+{
+	if (CurrentMode == NewMode)
+	{
+		return false;
+	}
+	if (!FParkourSimRules::CanTransition(CurrentMode, NewMode))
+	{
+		assert(!"Parkour transition is missing from FParkourSimRules::ModeTable");
+		return false;
+	}
+	PrevMode = CurrentMode;
+	CurrentMode = NewMode;
+	CancelStaleTimers();
+	ResetMovement();
+	TimesJumped = 0;
+	return true;
+}
+
+void FParkourSim::ResetMovement()
+{
+	if (FParkourSimRules::IsResetMode(CurrentMode))
+	{
+		Movement.RestoreDefaults();
+		Movement.SetMovementMode(FParkourSimRules::GetResetMovementMode(PrevMode));
+	}
+	const FParkourModeInfo& Info = FParkourSimRules::GetModeInfo(CurrentMode);
+	if (Info.GravityScale != FParkourModeInfo::NoOverride)
+	{
+		Movement.SetGravityScale(Info.GravityScale);
+	}
+	if (Info.GroundFriction != FParkourModeInfo::NoOverride)
+	{
+		Movement.SetGroundFriction(Info.GroundFriction);
+	}
+}
+
+FParkourSimVector FParkourSim::GetWallRunEndVector(float LineTraceRange) const
+{
+	return Movement.GetLocation() + Movement.GetRight() * LineTraceRange + Movement.GetForward() * -35.0f;
+}
+
+FParkourSimVector FParkourSim::GetLedgeTargetVector() const
+{
+	FParkourSimVector SumOfNormalAndPosition = LedgeClimbWallNormal * Movement.GetCapsuleRadius() + LedgeClimbWallPosition;
+	return FParkourSimVector(SumOfNormalAndPosition.X, SumOfNormalAndPosition.Y, LedgeFloorPosition.Z - Movement.GetCapsuleHalfHeight());
+}
+
+FParkourSimVector FParkourSim::GetDashLaunchVelocity() const
+{
+	FParkourSimVector Velocity = Movement.GetVelocity();
+	FParkourSimVector NewVel(Velocity.X * Config.DashScale, Velocity.Y * Config.DashScale, 0.0f);
+	float Range = IsFalling() ? Config.DashRange : (Config.DashRange * Config.MaxRangeScale);
+	float Size2D = std::sqrt(NewVel.X * NewVel.X + NewVel.Y * NewVel.Y);
+	if (Size2D > Range and Size2D > 0.0f)
+	{
+		float Scale = Range / Size2D;
+		NewVel.X *= Scale;
+		NewVel.Y *= Scale;
+	}
+	return NewVel;
+}
+
+FParkourSimVector FParkourSim::GetSlideVector()
+{
+	FParkourSimVector Location = Movement.GetLocation();
+	FParkourSimHit OutHit;
+	LineTrace(Location, Location + FParkourSimVector(0.0f, 0.0f, -200.0f), OutHit);
+	return FParkourSimVector::Cross(OutHit.Normal, Movement.GetRight()) * -1.0f;
+}
+
+void FParkourSim::GetMantleVectors(FParkourSimVector& OutEyes, FParkourSimVector& OutFeet) const
+{
+	FParkourSimVector FwdVec = Movement.GetForward() * 50.0f;
+	OutEyes = Movement.GetEyes() + FParkourSimVector(0.0f, 0.0f, 50.0f) + FwdVec;
+	FParkourSimVector FeetLocation = Movement.GetLocation() - FParkourSimVector(0.0f, 0.0f, Movement.GetCapsuleHalfHeight() - Config.MantleHeight);
+	OutFeet = FeetLocation + FwdVec;
+}
+
+float FParkourSim::ForwardInput() const
+{
+	return FParkourSimVector::Dot(Movement.GetForward(), Movement.GetLastInput());
+}
+
+bool FParkourSim::CanQuickMantle() const
+{
+	return FParkourSimRules::CanQuickMantle(MantleTraceDistance, Config.MantleHeight, bLedgeCloseToGround);
+}
@@ -0,0 +1,501 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+//Engine-independent parkour rules and state machine.
+//Nothing in this header may depend on Unreal so it can be built and benchmarked headless.
+
+#include <cstdint>
+#include <cmath>
+#include "ParkourScheduler.h"
+
+//Mirrors EParkourMode, UParkourComponent static_asserts the values match
+enum class EParkourSimMode : uint8_t
+{
+	NONE,
+	LEFTWALLRUN,
+	RIGHTWALLRUN,
+	VERTICALWALLRUN,
+	LEDGEGRAB,
+	MANTLE,
+	SLIDE,
+	SPRINT,
+	CROUCH,
+	MAX
+};
+
+enum class EParkourSimMovementMode : uint8_t
+{
+	NONE,
+	WALKING,
+	FALLING
+};
+
+//Custom physics a mode runs under with UParkourMovementComponent, NONE leaves walking and falling in charge
+enum class EParkourSimPhysics : uint8_t
+{
+	NONE,
+	WALLRUN,
+	VERTICALWALLRUN,
+	LEDGEHANG,
+	MANTLE
+};
+
+struct FParkourSimVector
+{
+	float X = 0.0f;
+	float Y = 0.0f;
+	float Z = 0.0f;
+
+	FParkourSimVector() {}
+	FParkourSimVector(float InX, float InY, float InZ) : X(InX), Y(InY), Z(InZ) {}
+
+	FParkourSimVector operator+(const FParkourSimVector& V) const { return FParkourSimVector(X + V.X, Y + V.Y, Z + V.Z); }
+	FParkourSimVector operator-(const FParkourSimVector& V) const { return FParkourSimVector(X - V.X, Y - V.Y, Z - V.Z); }
+	FParkourSimVector operator*(float Scale) const { return FParkourSimVector(X * Scale, Y * Scale, Z * Scale); }
+
+	float SizeSquared() const { return X * X + Y * Y + Z * Z; }
+	float Size() const { return std::sqrt(SizeSquared()); }
+
+	static float Dot(const FParkourSimVector& A, const FParkourSimVector& B) { return A.X * B.X + A.Y * B.Y + A.Z * B.Z; }
+	static FParkourSimVector Cross(const FParkourSimVector& A, const FParkourSimVector& B)
+	{
+		return FParkourSimVector(A.Y * B.Z - A.Z * B.Y, A.Z * B.X - A.X * B.Z, A.X * B.Y - A.Y * B.X);
+	}
+};
+
+struct FParkourSimHit
+{
+	bool bBlockingHit = false;
+	FParkourSimVector Location;
+	FParkourSimVector ImpactPoint;
+	FParkourSimVector Normal;
+	float Distance = 0.0f;
+};
+
+//Scene queries the state machine issues, equivalent to the ECC_Visibility traces in UParkourComponent
+class IParkourSimWorld
+{
+public:
+	virtual ~IParkourSimWorld() {}
+	virtual bool LineTrace(const FParkourSimVector& Start, const FParkourSimVector& End, FParkourSimHit& OutHit) = 0;
+	virtual bool SweepCapsule(const FParkourSimVector& Start, const FParkourSimVector& End, float Radius, float HalfHeight, FParkourSimHit& OutHit) = 0;
+};
+
+//The subset of ACharacter/UCharacterMovementComponent the state machine reads and writes
+class IParkourSimMovement
+{
+public:
+	virtual ~IParkourSimMovement() {}
+	virtual FParkourSimVector GetLocation() const = 0;
+	virtual void SetLocation(const FParkourSimVector& Location) = 0;
+	virtual FParkourSimVector GetForward() const = 0;
+	virtual FParkourSimVector GetRight() const = 0;
+	virtual FParkourSimVector GetEyes() const = 0;
+	virtual FParkourSimVector GetVelocity() const = 0;
+	virtual FParkourSimVector GetLastInput() const = 0;
+	virtual float GetCapsuleRadius() const = 0;
+	virtual float GetCapsuleHalfHeight() const = 0;
+	virtual float GetJumpZVelocity() const = 0;
+
+	virtual EParkourSimMovementMode GetMovementMode() const = 0;
+	virtual void SetMovementMode(EParkourSimMovementMode Mode) = 0;
+	virtual bool IsWalkable(const FParkourSimHit& Hit) const = 0;
+
+	virtual void Launch(const FParkourSimVector& Velocity, bool bXYOverride, bool bZOverride) = 0;
+	virtual void StopMovement() = 0;
+	virtual float GetGravityScale() const = 0;
+	virtual void SetGravityScale(float Scale) = 0;
+	virtual void SetGroundFriction(float Friction) = 0;
+	virtual void SetMaxWalkSpeed(float Speed) = 0;
+	virtual void SetCrouched(bool bCrouched) = 0;
+	//Plane constraint along velocity and an impulse along SlideVector, the zero friction comes from the mode table
+	virtual void BeginSlide(const FParkourSimVector& Impulse) = 0;
+	//Restores the defaults captured when the character was bound
+	virtual void RestoreDefaults() = 0;
+};
+
+//Mode sets the rules test against, several bits per mode
+enum EParkourModeCategory : uint16_t
+{
+	MODECAT_WALLRUN = 1 << 0,
+	MODECAT_LEDGEMANTLEVERTICAL = 1 << 1,
+	//Entering restores the default movement settings
+	MODECAT_RESET = 1 << 2,
+	MODECAT_CANWALLRUN = 1 << 3,
+	MODECAT_CANVERTICALWALLRUN = 1 << 4,
+	MODECAT_CANSPRINT = 1 << 5,
+	//Slide without a queued sprint
+	MODECAT_CANSLIDE = 1 << 6,
+	//Mantle without a quick mantle
+	MODECAT_CANMANTLE = 1 << 7,
+	//ToggleCrouch crouches from these and stands up from CROUCHEND
+	MODECAT_CROUCHSTART = 1 << 8,
+	MODECAT_CROUCHEND = 1 << 9,
+	MODECAT_ORIENTTOMOVEMENT = 1 << 10
+};
+
+constexpr uint16_t ParkourModeBit(EParkourSimMode Mode)
+{
+	return (uint16_t)(1u << (uint8_t)Mode);
+}
+
+//Everything that varies per mode, one row per EParkourSimMode
+struct FParkourModeInfo
+{
+	//Gravity and friction overrides applied on entry, NoOverride keeps the current value
+	static constexpr float NoOverride = -1.0f;
+
+	EParkourSimMode Mode;
+	uint16_t Categories;
+	//Modes SetParkourMode may enter from this one
+	uint16_t Transitions;
+	//Movement mode restored when leaving this mode for a MODECAT_RESET mode
+	EParkourSimMovementMode ExitMovementMode;
+	EParkourSimPhysics Physics;
+	float CameraRoll;
+	float GravityScale;
+	float GroundFriction;
+};
+
+//Pure rules shared by UParkourComponent and FParkourSim
+struct FParkourSimRules
+{
+	static constexpr uint16_t AnyMode = (uint16_t)((1u << (uint8_t)EParkourSimMode::MAX) - 1);
+	static constexpr uint16_t WallRunModes = ParkourModeBit(EParkourSimMode::LEFTWALLRUN) | ParkourModeBit(EParkourSimMode::RIGHTWALLRUN);
+
+	static constexpr FParkourModeInfo ModeTable[] =
+	{
+		{ EParkourSimMode::NONE,
+			MODECAT_RESET | MODECAT_CANWALLRUN | MODECAT_CANVERTICALWALLRUN | MODECAT_CANSPRINT | MODECAT_CROUCHSTART,
+			WallRunModes | ParkourModeBit(EParkourSimMode::VERTICALWALLRUN) | ParkourModeBit(EParkourSimMode::LEDGEGRAB)
+				| ParkourModeBit(EParkourSimMode::SLIDE) | ParkourModeBit(EParkourSimMode::SPRINT) | ParkourModeBit(EParkourSimMode::CROUCH),
+			EParkourSimMovementMode::WALKING, EParkourSimPhysics::NONE, 0.0f, FParkourModeInfo::NoOverride, FParkourModeInfo::NoOverride },
+		{ EParkourSimMode::LEFTWALLRUN,
+			MODECAT_WALLRUN | MODECAT_CANWALLRUN | MODECAT_CANVERTICALWALLRUN,
+			ParkourModeBit(EParkourSimMode::NONE) | WallRunModes | ParkourModeBit(EParkourSimMode::VERTICALWALLRUN) | ParkourModeBit(EParkourSimMode::LEDGEGRAB),
+			EParkourSimMovementMode::FALLING, EParkourSimPhysics::WALLRUN, 15.0f, FParkourModeInfo::NoOverride, FParkourModeInfo::NoOverride },
+		{ EParkourSimMode::RIGHTWALLRUN,
+			MODECAT_WALLRUN | MODECAT_CANWALLRUN | MODECAT_CANVERTICALWALLRUN,
+			ParkourModeBit(EParkourSimMode::NONE) | WallRunModes | ParkourModeBit(EParkourSimMode::VERTICALWALLRUN) | ParkourModeBit(EParkourSimMode::LEDGEGRAB),
+			EParkourSimMovementMode::FALLING, EParkourSimPhysics::WALLRUN, -15.0f, FParkourModeInfo::NoOverride, FParkourModeInfo::NoOverride },
+		{ EParkourSimMode::VERTICALWALLRUN,
+			MODECAT_LEDGEMANTLEVERTICAL | MODECAT_CANVERTICALWALLRUN,
+			ParkourModeBit(EParkourSimMode::NONE) | ParkourModeBit(EParkourSimMode::LEDGEGRAB) | ParkourModeBit(EParkourSimMode::MANTLE),
+			EParkourSimMovementMode::FALLING, EParkourSimPhysics::VERTICALWALLRUN, 0.0f, FParkourModeInfo::NoOverride, FParkourModeInfo::NoOverride },
+		{ EParkourSimMode::LEDGEGRAB,
+			MODECAT_LEDGEMANTLEVERTICAL | MODECAT_CANMANTLE,
+			ParkourModeBit(EParkourSimMode::NONE) | ParkourModeBit(EParkourSimMode::MANTLE),
+			EParkourSimMovementMode::FALLING, EParkourSimPhysics::LEDGEHANG, 0.0f, 0.0f, FParkourModeInfo::NoOverride },
+		{ EParkourSimMode::MANTLE,
+			MODECAT_LEDGEMANTLEVERTICAL,
+			ParkourModeBit(EParkourSimMode::NONE),
+			EParkourSimMovementMode::WALKING, EParkourSimPhysics::MANTLE, 0.0f, FParkourModeInfo::NoOverride, FParkourModeInfo::NoOverride },
+		{ EParkourSimMode::SLIDE,
+			0,
+			ParkourModeBit(EParkourSimMode::NONE) | ParkourModeBit(EParkourSimMode::CROUCH),
+			EParkourSimMovementMode::WALKING, EParkourSimPhysics::NONE, -15.0f, FParkourModeInfo::NoOverride, 0.0f },
+		{ EParkourSimMode::SPRINT,
+			MODECAT_CANSLIDE | MODECAT_ORIENTTOMOVEMENT,
+			ParkourModeBit(EParkourSimMode::NONE) | ParkourModeBit(EParkourSimMode::SLIDE),
+			EParkourSimMovementMode::WALKING, EParkourSimPhysics::NONE, 0.0f, FParkourModeInfo::NoOverride, FParkourModeInfo::NoOverride },
+		{ EParkourSimMode::CROUCH,
+			MODECAT_RESET | MODECAT_CROUCHEND,
+			ParkourModeBit(EParkourSimMode::NONE) | ParkourModeBit(EParkourSimMode::SLIDE),
+			EParkourSimMovementMode::WALKING, EParkourSimPhysics::NONE, 0.0f, FParkourModeInfo::NoOverride, FParkourModeInfo::NoOverride },
+	};
+
+	static constexpr bool IsModeTableComplete()
+	{
+		for (uint8_t Mode = 0; Mode < (uint8_t)EParkourSimMode::MAX; Mode++)
+		{
+			if ((uint8_t)ModeTable[Mode].Mode != Mode or (ModeTable[Mode].Transitions & ~AnyMode) != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//Out of range modes, e.g. from a corrupt packet, read the NONE row
+	static constexpr const FParkourModeInfo& GetModeInfo(EParkourSimMode Mode)
+	{
+		return ModeTable[((uint8_t)Mode < (uint8_t)EParkourSimMode::MAX) ? (uint8_t)Mode : 0];
+	}
+
+	static constexpr bool HasCategory(EParkourSimMode Mode, uint16_t Category)
+	{
+		return (GetModeInfo(Mode).Categories & Category) != 0;
+	}
+
+	static constexpr bool CanTransition(EParkourSimMode From, EParkourSimMode To)
+	{
+		return (GetModeInfo(From).Transitions & ParkourModeBit(To)) != 0;
+	}
+
+	static bool IsWallRunning(EParkourSimMode Mode)
+	{
+		return HasCategory(Mode, MODECAT_WALLRUN);
+	}
+
+	static bool IsLedgeMantleOrVertical(EParkourSimMode Mode)
+	{
+		return HasCategory(Mode, MODECAT_LEDGEMANTLEVERTICAL);
+	}
+
+	static bool IsResetMode(EParkourSimMode Mode)
+	{
+		return HasCategory(Mode, MODECAT_RESET);
+	}
+
+	static bool IsWallRunnableNormal(float NormalZ)
+	{
+		return (NormalZ > -0.52f and NormalZ < 0.52f);
+	}
+
+	static bool CanWallRun(EParkourSimMode Mode, float ForwardInput)
+	{
+		return (HasCategory(Mode, MODECAT_CANWALLRUN) & (ForwardInput > 0.0f));
+	}
+
+	static bool CanQuickMantle(float MantleTraceDistance, float MantleHeight, bool bLedgeCloseToGround)
+	{
+		return ((MantleTraceDistance > MantleHeight) or bLedgeCloseToGround);
+	}
+
+	static bool CanMantle(EParkourSimMode Mode, float ForwardInput, bool bCanQuickMantle)
+	{
+		return ((ForwardInput > 0.0f) & (HasCategory(Mode, MODECAT_CANMANTLE) | bCanQuickMantle));
+	}
+
+	static bool CanVerticalWallRun(EParkourSimMode Mode, float ForwardInput, bool bFalling)
+	{
+		return ((ForwardInput > 0.0f) & bFalling & HasCategory(Mode, MODECAT_CANVERTICALWALLRUN));
+	}
+
+	static bool CanSprint(EParkourSimMode Mode, bool bWalking)
+	{
+		return (bWalking & HasCategory(Mode, MODECAT_CANSPRINT));
+	}
+
+	static bool CanSlide(EParkourSimMode Mode, float ForwardInput, bool bSprintQueued)
+	{
+		return ((ForwardInput > 0.0f) & (HasCategory(Mode, MODECAT_CANSLIDE) | bSprintQueued));
+	}
+
+	static bool CanJump(int32_t TimesJumped, int32_t MaxJumps)
+	{
+		return (TimesJumped < MaxJumps);
+	}
+
+	//Movement mode ResetMovement restores when leaving PrevMode for NONE or CROUCH
+	static EParkourSimMovementMode GetResetMovementMode(EParkourSimMode PrevMode)
+	{
+		return GetModeInfo(PrevMode).ExitMovementMode;
+	}
+
+	static EParkourSimPhysics GetPhysics(EParkourSimMode Mode)
+	{
+		return GetModeInfo(Mode).Physics;
+	}
+
+	static float GetCameraRoll(EParkourSimMode Mode)
+	{
+		return GetModeInfo(Mode).CameraRoll;
+	}
+
+	//Same behaviour as FMath::FInterpTo
+	static float InterpTo(float Current, float Target, float DeltaTime, float InterpSpeed)
+	{
+		if (InterpSpeed <= 0.0f)
+		{
+			return Target;
+		}
+		float Dist = Target - Current;
+		if (Dist * Dist < 1.e-8f)
+		{
+			return Target;
+		}
+		float Alpha = DeltaTime * InterpSpeed;
+		Alpha = (Alpha < 0.0f) ? 0.0f : ((Alpha > 1.0f) ? 1.0f : Alpha);
+		return Current + Dist * Alpha;
+	}
+
+	//Same behaviour as FMath::VInterpTo
+	static FParkourSimVector InterpTo(const FParkourSimVector& Current, const FParkourSimVector& Target, float DeltaTime, float InterpSpeed)
+	{
+		if (InterpSpeed <= 0.0f)
+		{
+			return Target;
+		}
+		FParkourSimVector Dist = Target - Current;
+		if (Dist.SizeSquared() < 1.e-8f)
+		{
+			return Target;
+		}
+		float Alpha = DeltaTime * InterpSpeed;
+		Alpha = (Alpha < 0.0f) ? 0.0f : ((Alpha > 1.0f) ? 1.0f : Alpha);
+		return Current + Dist * Alpha;
+	}
+};
+
+static_assert(sizeof(FParkourSimRules::ModeTable) / sizeof(FParkourModeInfo) == (size_t)EParkourSimMode::MAX, "FParkourSimRules::ModeTable needs one row per EParkourSimMode");
+static_assert(FParkourSimRules::IsModeTableComplete(), "FParkourSimRules::ModeTable rows must be in EParkourSimMode order");
+static_assert((uint8_t)EParkourSimMode::MAX <= 16, "EParkourSimMode no longer fits the 16 bit transition masks");
+
+//Tunables, defaults match UParkourComponent's constructor
+struct FParkourSimConfig
+{
+	float WallRunSpeed = 850.0f;
+	float WallRunSprintSpeed = 1100.0f;
+	float WallRunTargetGravity = 0.2f;
+	float WallJumpForce = 600.0f;
+	float WallJumpScale = 600.0f;
+	float MantleHeight = 44.0f;
+	float MantleSpeed = 10.0f;
+	float QuickMantleSpeed = 20.0f;
+	float VerticalWallRunSpeed = 300.0f;
+	float LedgeGrabJumpOffForce = 500.0f;
+	float LedgeGrabJumpOffHeight = 500.0f;
+	float SprintSpeed = 1000.0f;
+	float SlideImpulseAmount = 600.0f;
+	float DashScale = 15.0f;
+	float DashRange = 2000.0f;
+	float MaxRangeScale = 100.0f;
+	int32_t MaxJumps = 2;
+};
+
+//Headless equivalent of UParkourComponent's update pipeline and event cascades.
+//Gates mirror the EParkourGate bitmask dispatched by UParkourComponent.
+class FParkourSim
+{
+public:
+	enum EGate : uint8_t
+	{
+		GATE_WALLRUN = 1 << 0,
+		GATE_VERTICALWALLRUN = 1 << 1,
+		GATE_CHECKMANTLE = 1 << 2,
+		GATE_MANTLE = 1 << 3,
+		GATE_SLIDE = 1 << 4,
+		GATE_SPRINT = 1 << 5
+	};
+
+	FParkourSim(IParkourSimWorld& InWorld, IParkourSimMovement& InMovement, const FParkourSimConfig& InConfig);
+
+	void Update(float DeltaTime);
+
+	void JumpEvent();
+	void LandEvent();
+	void DashEvent();
+	void SprintEvent();
+	void CrouchSlideEvent();
+	void MovementChanged(EParkourSimMovementMode PrevMovement, EParkourSimMovementMode CurrentMovement);
+
+	EParkourSimMode GetMode() const { return CurrentMode; }
+	uint8_t GetGates() const { return Gates; }
+	int32_t GetTimesJumped() const { return TimesJumped; }
+	//Scene queries issued since construction
+	uint64_t GetQueryCount() const { return QueryCount; }
+
+private:
+	typedef TParkourScheduler<FParkourSim, 16> FScheduler;
+
+	void OpenWallRunGate() { OpenGate(GATE_WALLRUN); }
+	void OpenVerticalWallRunGate() { OpenGate(GATE_VERTICALWALLRUN); }
+	void OpenCheckMantleGate() { OpenGate(GATE_CHECKMANTLE); }
+	void OpenSprintGate() { OpenGate(GATE_SPRINT); }
+	void WallRunEnableGravity();
+	void CancelStaleTimers();
+
+	void OpenGate(uint8_t Gate) { Gates |= Gate; }
+	void CloseGate(uint8_t Gate) { Gates &= ~Gate; }
+	void OpenGates();
+	void CloseGates();
+
+	bool LineTrace(const FParkourSimVector& Start, const FParkourSimVector& End, FParkourSimHit& OutHit);
+	bool SweepCapsule(const FParkourSimVector& Start, const FParkourSimVector& End, float Radius, float HalfHeight, FParkourSimHit& OutHit);
+
+	bool WallRunMovement(const FParkourSimVector& Start, const FParkourSimVector& End, float WallRunDir);
+	void WallRunUpdate();
+	void ApplyGravityAndCorrectLocation();
+	void WallRunJump();
+	void WallRunEnd(float ResetTime);
+
+	void VerticalWallRunMovement();
+	void VerticalWallRunUpdate();
+	void VerticalWallRunEnd(float ResetTime);
+	void ForwardTracer(FParkourSimHit& OutHit, bool& bValidHit);
+
+	void MantleCheck();
+	void MantleStart();
+	void MantleMovement();
+	void LedgeGrabJump();
+	void GrabLedge();
+
+	void SlideUpdate();
+	void SlideStart();
+	void SlideEnd(bool bCrouch);
+	void SlideJump();
+
+	void SprintUpdate();
+	void SprintStart();
+	void SprintEnd();
+	void SprintJump();
+
+	void CrouchStart();
+	void CrouchEnd();
+	void CrouchJump();
+	void ToggleCrouch();
+
+	void JumpMovement();
+	void CheckQueues();
+	void JumpEvents();
+	void EndEvents();
+
+	bool SetParkourMode(EParkourSimMode NewMode);
+	void ResetMovement();
+
+	FParkourSimVector GetWallRunEndVector(float LineTraceRange) const;
+	FParkourSimVector GetLedgeTargetVector() const;
+	FParkourSimVector GetDashLaunchVelocity() const;
+	FParkourSimVector GetSlideVector();
+	void GetMantleVectors(FParkourSimVector& OutEyes, FParkourSimVector& OutFeet) const;
+	float ForwardInput() const;
+	bool IsFalling() const { return Movement.GetMovementMode() == EParkourSimMovementMode::FALLING; }
+	bool IsWalking() const { return Movement.GetMovementMode() == EParkourSimMovementMode::WALKING; }
+	bool CanQuickMantle() const;
+
+	IParkourSimWorld& World;
+	IParkourSimMovement& Movement;
+	FParkourSimConfig Config;
+
+	FScheduler Scheduler;
+	FScheduler::FHandle WallRunGateTimer;
+	FScheduler::FHandle WallRunGravityTimer;
+	FScheduler::FHandle VerticalWallRunGateTimer;
+	FScheduler::FHandle CheckMantleGateTimer;
+	FScheduler::FHandle CheckQueuesTimer;
+	FScheduler::FHandle SprintGateTimer;
+	float DeltaSeconds;
+	uint64_t QueryCount;
+	uint8_t Gates;
+
+	EParkourSimMode CurrentMode;
+	EParkourSimMode PrevMode;
+	int32_t TimesJumped;
+	bool bCanDash;
+	bool bWallRunGravityOn;
+	bool bSprintQueued;
+	bool bSlideQueued;
+	bool bLedgeCloseToGround;
+
+	FParkourSimVector WallRunNormal;
+	FParkourSimVector WallRunLocation;
+	FParkourSimVector VerticalWallRunNormal;
+	FParkourSimVector VerticalWallRunLocation;
+	FParkourSimVector MantlePosition;
+	float MantleTraceDistance;
+	FParkourSimVector LedgeFloorPosition;
+	FParkourSimVector LedgeClimbWallNormal;
+	FParkourSimVector LedgeClimbWallPosition;
+};
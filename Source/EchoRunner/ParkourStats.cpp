@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourStats.h"
+
+DEFINE_STAT(STAT_ParkourTick);
+DEFINE_STAT(STAT_ParkourWallRunUpdate);
+DEFINE_STAT(STAT_ParkourVerticalWallRunUpdate);
+DEFINE_STAT(STAT_ParkourMantleCheck);
+DEFINE_STAT(STAT_ParkourMantleMovement);
+DEFINE_STAT(STAT_ParkourSlideUpdate);
+DEFINE_STAT(STAT_ParkourSprintUpdate);
+DEFINE_STAT(STAT_ParkourCameraTick);
+DEFINE_STAT(STAT_ParkourManagerUpdate);
+DEFINE_STAT(STAT_ParkourManagerPlan);
+DEFINE_STAT(STAT_ParkourManagerQueries);
+DEFINE_STAT(STAT_ParkourManagerApply);
+
+DEFINE_STAT(STAT_ParkourQueriesWallRunRight);
+DEFINE_STAT(STAT_ParkourQueriesWallRunLeft);
+DEFINE_STAT(STAT_ParkourQueriesLedge);
+DEFINE_STAT(STAT_ParkourQueriesForward);
+DEFINE_STAT(STAT_ParkourQueriesLedgeGround);
+DEFINE_STAT(STAT_ParkourQueriesSlide);
+DEFINE_STAT(STAT_ParkourQueriesFused);
+DEFINE_STAT(STAT_ParkourBakedLookups);
+DEFINE_STAT(STAT_ParkourPrefetchedProbes);
+DEFINE_STAT(STAT_ParkourModeTransitions);
+DEFINE_STAT(STAT_ParkourBufferedInputs);
+DEFINE_STAT(STAT_ParkourBufferedInputLatency);
+
+LLM_DEFINE_TAG(Parkour);
+
+#if PARKOUR_TRACE_ENABLED
+UE_TRACE_CHANNEL_DEFINE(ParkourChannel);
+
+UE_TRACE_EVENT_BEGIN(Parkour, ModeTransition)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint32, ComponentId)
+	UE_TRACE_EVENT_FIELD(uint8, PrevMode)
+	UE_TRACE_EVENT_FIELD(uint8, NewMode)
+UE_TRACE_EVENT_END()
+
+void TraceParkourModeTransition(const UObject* Component, uint8 PrevMode, uint8 NewMode)
+{
+	UE_TRACE_LOG(Parkour, ModeTransition, ParkourChannel)
+		<< ModeTransition.Cycle(FPlatformTime::Cycles64())
+		<< ModeTransition.ComponentId(Component ? Component->GetUniqueID() : 0)
+		<< ModeTransition.PrevMode(PrevMode)
+		<< ModeTransition.NewMode(NewMode);
+}
+#endif
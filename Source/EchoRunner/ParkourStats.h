@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+//Parkour instrumentation: stat Parkour, the Parkour Insights channel and the Parkour LLM tag.
+//Stats and LLM compile out with the engine's STATS and LLM switches, the trace channel in shipping.
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "HAL/LowLevelMemTracker.h"
+#include "Trace/Trace.h"
+
+#define PARKOUR_TRACE_ENABLED (UE_TRACE_ENABLED && !UE_BUILD_SHIPPING)
+
+DECLARE_STATS_GROUP(TEXT("Parkour"), STATGROUP_Parkour, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Tick"), STAT_ParkourTick, STATGROUP_Parkour, ECHORUNNER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("WallRunUpdate"), STAT_ParkourWallRunUpdate, STATGROUP_Parkour, ECHORUNNER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("VerticalWallRunUpdate"), STAT_ParkourVerticalWallRunUpdate, STATGROUP_Parkour, ECHORUNNER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("MantleCheck"), STAT_ParkourMantleCheck, STATGROUP_Parkour, ECHORUNNER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("MantleMovement"), STAT_ParkourMantleMovement, STATGROUP_Parkour, ECHORUNNER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SlideUpdate"), STAT_ParkourSlideUpdate, STATGROUP_Parkour, ECHORUNNER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SprintUpdate"), STAT_ParkourSprintUpdate, STATGROUP_Parkour, ECHORUNNER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CameraTick"), STAT_ParkourCameraTick, STATGROUP_Parkour, ECHORUNNER_API);
+//UParkourUpdateManager, the whole update and each of its phases
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Manager Update"), STAT_ParkourManagerUpdate, STATGROUP_Parkour, ECHORUNNER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Manager Plan"), STAT_ParkourManagerPlan, STATGROUP_Parkour, ECHORUNNER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Manager Queries"), STAT_ParkourManagerQueries, STATGROUP_Parkour, ECHORUNNER_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Manager Apply"), STAT_ParkourManagerApply, STATGROUP_Parkour, ECHORUNNER_API);
+
+//Scene queries per frame, one counter per EParkourProbe
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queries WallRunRight"), STAT_ParkourQueriesWallRunRight, STATGROUP_Parkour, ECHORUNNER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queries WallRunLeft"), STAT_ParkourQueriesWallRunLeft, STATGROUP_Parkour, ECHORUNNER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queries Ledge"), STAT_ParkourQueriesLedge, STATGROUP_Parkour, ECHORUNNER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queries Forward"), STAT_ParkourQueriesForward, STATGROUP_Parkour, ECHORUNNER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queries LedgeGround"), STAT_ParkourQueriesLedgeGround, STATGROUP_Parkour, ECHORUNNER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queries Slide"), STAT_ParkourQueriesSlide, STATGROUP_Parkour, ECHORUNNER_API);
+//Broadphase overlaps of the fused probe, each one stands in for up to four of the queries above
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Queries Fused"), STAT_ParkourQueriesFused, STATGROUP_Parkour, ECHORUNNER_API);
+//Probes answered from the baked wall index and ledge database instead of the scene
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Baked Lookups"), STAT_ParkourBakedLookups, STATGROUP_Parkour, ECHORUNNER_API);
+//Probes the update found already answered by the manager's parallel query phase
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Prefetched Probes"), STAT_ParkourPrefetchedProbes, STATGROUP_Parkour, ECHORUNNER_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Mode Transitions"), STAT_ParkourModeTransitions, STATGROUP_Parkour, ECHORUNNER_API);
+//Buffered jump, slide, sprint and dash presses used by a transition, and how long the last one waited
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Buffered Inputs"), STAT_ParkourBufferedInputs, STATGROUP_Parkour, ECHORUNNER_API);
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Buffered Input Latency (ms)"), STAT_ParkourBufferedInputLatency, STATGROUP_Parkour, ECHORUNNER_API);
+
+LLM_DECLARE_TAG_API(Parkour, ECHORUNNER_API);
+
+#if PARKOUR_TRACE_ENABLED
+UE_TRACE_CHANNEL_EXTERN(ParkourChannel, ECHORUNNER_API);
+
+//Emits Parkour.ModeTransition on the Parkour channel, enable with -trace=default,parkour
+ECHORUNNER_API void TraceParkourModeTransition(const UObject* Component, uint8 PrevMode, uint8 NewMode);
+
+#define TRACE_PARKOUR_MODE_TRANSITION(Component, PrevMode, NewMode) TraceParkourModeTransition(Component, (uint8)(PrevMode), (uint8)(NewMode))
+#else
+#define TRACE_PARKOUR_MODE_TRANSITION(Component, PrevMode, NewMode)
+#endif
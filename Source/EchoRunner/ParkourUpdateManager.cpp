@@ -0,0 +1,190 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourUpdateManager.h"
+#include "Async/ParallelFor.h"
+#include "Engine/World.h"
+#include "Engine/Level.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "HAL/IConsoleManager.h"
+#include "ParkourComponent.h"
+#include "ParkourStats.h"
+
+namespace ParkourUpdateManager
+{
+	static TAutoConsoleVariable<bool> CVarParallelUpdate(
+		TEXT("parkour.ParallelUpdate"),
+		true,
+		TEXT("Run the probe and scene query phases of the managed parkour update across worker threads, 0 runs them on the game thread."));
+
+	static EParallelForFlags GetParallelForFlags()
+	{
+		return CVarParallelUpdate.GetValueOnGameThread() ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread;
+	}
+}
+
+void FParkourUpdateTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Manager and TickType != LEVELTICK_ViewportsOnly)
+	{
+		Manager->Update(DeltaTime);
+	}
+}
+
+FString FParkourUpdateTickFunction::DiagnosticMessage()
+{
+	return TEXT("FParkourUpdateTickFunction");
+}
+
+FName FParkourUpdateTickFunction::DiagnosticContext(bool bDetailed)
+{
+	return FName(TEXT("ParkourUpdateManager"));
+}
+
+bool UParkourUpdateManager::DoesSupportWorldType(const EWorldType::Type WorldType) const
+{
+	return WorldType == EWorldType::Game or WorldType == EWorldType::PIE;
+}
+
+void UParkourUpdateManager::Deinitialize()
+{
+	if (UpdateTickFunction.IsTickFunctionRegistered())
+	{
+		UpdateTickFunction.UnRegisterTickFunction();
+	}
+	UpdateTickFunction.Manager = nullptr;
+	Entries.Empty();
+	Super::Deinitialize();
+}
+
+void UParkourUpdateManager::RegisterTickFunction()
+{
+	if (UpdateTickFunction.IsTickFunctionRegistered())
+	{
+		return;
+	}
+	UpdateTickFunction.Manager = this;
+	UpdateTickFunction.bCanEverTick = true;
+	UpdateTickFunction.bStartWithTickEnabled = true;
+	UpdateTickFunction.TickGroup = TG_PrePhysics;
+	UpdateTickFunction.RegisterTickFunction(GetWorld()->PersistentLevel);
+}
+
+void UParkourUpdateManager::Register(UParkourComponent* Component)
+{
+	if (!Component or Entries.ContainsByPredicate([Component](const FEntry& Entry) { return Entry.Component == Component; }))
+	{
+		return;
+	}
+	RegisterTickFunction();
+	FEntry& Entry = Entries.AddDefaulted_GetRef();
+	Entry.Component = Component;
+	//Same ordering the component's own tick had, parkour decisions land before the movement they drive
+	Component->CharacterMovement->PrimaryComponentTick.AddPrerequisite(this, UpdateTickFunction);
+}
+
+void UParkourUpdateManager::Unregister(UParkourComponent* Component)
+{
+	const int32 Index = Entries.IndexOfByPredicate([Component](const FEntry& Entry) { return Entry.Component == Component; });
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+	if (Component->CharacterMovement)
+	{
+		Component->CharacterMovement->PrimaryComponentTick.RemovePrerequisite(this, UpdateTickFunction);
+	}
+	//Indices are held by Updating until the update finishes
+	if (bUpdating)
+	{
+		Entries[Index].Component = nullptr;
+	}
+	else
+	{
+		Entries.RemoveAtSwap(Index);
+	}
+}
+
+void UParkourUpdateManager::Update(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ParkourManagerUpdate);
+	LLM_SCOPE_BYTAG(Parkour);
+	bUpdating = true;
+	Updating.Reset();
+	Probing.Reset();
+
+	//Phase 0, serial: timers, LOD, playback and corrections can fire events and move the actor
+	for (int32 Index = 0; Index < Entries.Num(); Index++)
+	{
+		FEntry& Entry = Entries[Index];
+		UParkourComponent* Component = Entry.Component;
+		if (!Component)
+		{
+			continue;
+		}
+		if (Component->IsUpdateAsleep())
+		{
+			Entry.PendingDeltaTime = 0.0f;
+			continue;
+		}
+		Entry.PendingDeltaTime += DeltaTime * Component->GetOwner()->CustomTimeDilation;
+		if (Entry.PendingDeltaTime < Component->GetUpdateInterval())
+		{
+			continue;
+		}
+		Updating.Add(Index);
+		Component->BeginUpdate(Entries[Index].PendingDeltaTime);
+	}
+	//Built after the loop, an earlier component's events may have removed a later one
+	for (int32 Index : Updating)
+	{
+		UParkourComponent* Component = Entries[Index].Component;
+		if (Component and Component->bUpdateDispatches)
+		{
+			Probing.Add(Component);
+		}
+	}
+
+	//Phase 1, parallel: probe frames and the probes the open gates will ask for, each worker only touches its own component
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ParkourManagerPlan);
+		ParallelFor(Probing.Num(), [this](int32 Index)
+		{
+			UParkourComponent* Component = Probing[Index];
+			const uint32 StartCycles = FPlatformTime::Cycles();
+			Component->BuildProbeFrame();
+			Component->PlanProbes();
+			Component->UpdateCycles += FPlatformTime::Cycles() - StartCycles;
+		}, ParkourUpdateManager::GetParallelForFlags());
+	}
+
+	//Phase 2, parallel: the planned scene queries, nothing moves until phase 3
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ParkourManagerQueries);
+		ParallelFor(Probing.Num(), [this](int32 Index)
+		{
+			UParkourComponent* Component = Probing[Index];
+			const uint32 StartCycles = FPlatformTime::Cycles();
+			Component->RunPlannedProbes();
+			Component->UpdateCycles += FPlatformTime::Cycles() - StartCycles;
+		}, ParkourUpdateManager::GetParallelForFlags());
+	}
+
+	//Phase 3, serial: dispatch, launches and movement component writes
+	{
+		SCOPE_CYCLE_COUNTER(STAT_ParkourManagerApply);
+		for (int32 Index : Updating)
+		{
+			//Copied out first, an event in FinishUpdate may register a component and grow Entries
+			UParkourComponent* Component = Entries[Index].Component;
+			const float EntryDeltaTime = Entries[Index].PendingDeltaTime;
+			Entries[Index].PendingDeltaTime = 0.0f;
+			if (Component)
+			{
+				Component->FinishUpdate(EntryDeltaTime);
+			}
+		}
+	}
+
+	bUpdating = false;
+	Entries.RemoveAllSwap([](const FEntry& Entry) { return Entry.Component == nullptr; });
+}
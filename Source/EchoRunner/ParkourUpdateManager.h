@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "ParkourUpdateManager.generated.h"
+
+class UParkourComponent;
+class UParkourUpdateManager;
+
+//One tick for every managed parkour component, ahead of their CharacterMovement in TG_PrePhysics
+USTRUCT()
+struct FParkourUpdateTickFunction : public FTickFunction
+{
+	GENERATED_BODY()
+
+	UParkourUpdateManager* Manager = nullptr;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+	virtual FName DiagnosticContext(bool bDetailed) override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FParkourUpdateTickFunction> : public TStructOpsTypeTraitsBase2<FParkourUpdateTickFunction>
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+//Runs the parkour update of every registered UParkourComponent in the world in three phases.
+//Scheduler timers, LOD, playback and corrections run serially first, since they can fire events and move the actor.
+//The probe frames and the scene queries they imply then run in ParallelFor against the read-only physics scene,
+//and DispatchUpdate, which launches and writes the movement components, applies serially from the prefetched hits.
+UCLASS()
+class ECHORUNNER_API UParkourUpdateManager : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	//Takes over Component's update, its own tick stays off until Unregister
+	void Register(UParkourComponent* Component);
+	void Unregister(UParkourComponent* Component);
+	int32 Num() const { return Entries.Num(); }
+
+	void Update(float DeltaTime);
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	struct FEntry
+	{
+		//Cleared instead of removed while an update is running
+		UParkourComponent* Component = nullptr;
+		//Frame time gathered since the component's last update, so each one keeps its own update rate
+		float PendingDeltaTime = 0.0f;
+	};
+	TArray<FEntry> Entries;
+	//Per-update scratch, entries due this frame and the components among them that probe and dispatch
+	TArray<int32> Updating;
+	TArray<UParkourComponent*> Probing;
+	bool bUpdating = false;
+
+	FParkourUpdateTickFunction UpdateTickFunction;
+	void RegisterTickFunction();
+};
@@ -0,0 +1,186 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourWallIndex.h"
+#include "Engine/World.h"
+#include "Misc/PackageName.h"
+
+bool UParkourWallIndex::LineTrace(const FVector& Start, const FVector& End, FHitResult& OutHit) const
+{
+	if (GridSize.X <= 0 or GridSize.Y <= 0)
+	{
+		return false;
+	}
+
+	const FVector Dir = End - Start;
+	int32 MinX = FMath::FloorToInt((FMath::Min(Start.X, End.X) - GridOrigin.X) / CellSize);
+	int32 MinY = FMath::FloorToInt((FMath::Min(Start.Y, End.Y) - GridOrigin.Y) / CellSize);
+	int32 MaxX = FMath::FloorToInt((FMath::Max(Start.X, End.X) - GridOrigin.X) / CellSize);
+	int32 MaxY = FMath::FloorToInt((FMath::Max(Start.Y, End.Y) - GridOrigin.Y) / CellSize);
+	if (MaxX < 0 or MaxY < 0 or MinX >= GridSize.X or MinY >= GridSize.Y)
+	{
+		return false;
+	}
+	MinX = FMath::Max(MinX, 0);
+	MinY = FMath::Max(MinY, 0);
+	MaxX = FMath::Min(MaxX, GridSize.X - 1);
+	MaxY = FMath::Min(MaxY, GridSize.Y - 1);
+
+	//Two-sided Moller-Trumbore against every triangle in the covered cells, a triangle in two cells just tests twice
+	double BestT = 2.0;
+	int32 BestTriangle = INDEX_NONE;
+	for (int32 CellY = MinY; CellY <= MaxY; CellY++)
+	{
+		for (int32 CellX = MinX; CellX <= MaxX; CellX++)
+		{
+			const int32 Cell = GetCellIndex(CellX, CellY);
+			for (int32 Item = CellStarts[Cell]; Item < CellStarts[Cell + 1]; Item++)
+			{
+				const FParkourWallTriangle& Tri = Triangles[CellTriangles[Item]];
+				const FVector P = FVector::CrossProduct(Dir, Tri.Edge2);
+				const double Det = FVector::DotProduct(Tri.Edge1, P);
+				if (FMath::Abs(Det) < UE_SMALL_NUMBER)
+				{
+					continue;
+				}
+				const double InvDet = 1.0 / Det;
+				const FVector S = Start - Tri.V0;
+				const double U = FVector::DotProduct(S, P) * InvDet;
+				if (U < 0.0 or U > 1.0)
+				{
+					continue;
+				}
+				const FVector Q = FVector::CrossProduct(S, Tri.Edge1);
+				const double V = FVector::DotProduct(Dir, Q) * InvDet;
+				if (V < 0.0 or U + V > 1.0)
+				{
+					continue;
+				}
+				const double T = FVector::DotProduct(Tri.Edge2, Q) * InvDet;
+				if (T >= 0.0 and T <= 1.0 and T < BestT)
+				{
+					BestT = T;
+					BestTriangle = CellTriangles[Item];
+				}
+			}
+		}
+	}
+
+	if (BestTriangle == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FVector HitLocation = Start + Dir * BestT;
+	//Baked winding is not trusted, the normal always faces back along the probe like a blocking hit
+	FVector HitNormal = Triangles[BestTriangle].Normal;
+	if (FVector::DotProduct(Dir, HitNormal) > 0.0)
+	{
+		HitNormal = -HitNormal;
+	}
+	OutHit = FHitResult(Start, End);
+	OutHit.bBlockingHit = true;
+	OutHit.Time = BestT;
+	OutHit.Distance = Dir.Size() * BestT;
+	OutHit.Location = HitLocation;
+	OutHit.ImpactPoint = HitLocation;
+	OutHit.Normal = HitNormal;
+	OutHit.ImpactNormal = HitNormal;
+	OutHit.FaceIndex = BestTriangle;
+	return true;
+}
+
+void UParkourWallIndex::Build(TArray<FParkourWallTriangle>&& InTriangles, float InCellSize, bool bInCoversStaticGeometry)
+{
+	Version = CurrentVersion;
+	bCoversStaticGeometry = bInCoversStaticGeometry;
+	Triangles = MoveTemp(InTriangles);
+	CellSize = FMath::Max(InCellSize, 1.0f);
+	CellStarts.Reset();
+	CellTriangles.Reset();
+	GridSize = FIntPoint::ZeroValue;
+	if (Triangles.Num() == 0)
+	{
+		return;
+	}
+
+	FBox2D Bounds(ForceInit);
+	for (const FParkourWallTriangle& Tri : Triangles)
+	{
+		Bounds += FVector2D(Tri.V0);
+		Bounds += FVector2D(Tri.V0 + Tri.Edge1);
+		Bounds += FVector2D(Tri.V0 + Tri.Edge2);
+	}
+
+	//Coarsen the grid rather than let a huge level allocate millions of empty cells
+	const int32 MaxCells = 1 << 20;
+	FVector2D Extent = Bounds.GetSize();
+	while ((FMath::FloorToInt(Extent.X / CellSize) + 1) * (FMath::FloorToInt(Extent.Y / CellSize) + 1) > MaxCells)
+	{
+		CellSize *= 2.0f;
+	}
+	GridOrigin = Bounds.Min;
+	GridSize = FIntPoint(FMath::FloorToInt(Extent.X / CellSize) + 1, FMath::FloorToInt(Extent.Y / CellSize) + 1);
+
+	auto ForEachCell = [this](const FParkourWallTriangle& Tri, TFunctionRef<void(int32)> Visit)
+	{
+		FBox2D TriBounds(ForceInit);
+		TriBounds += FVector2D(Tri.V0);
+		TriBounds += FVector2D(Tri.V0 + Tri.Edge1);
+		TriBounds += FVector2D(Tri.V0 + Tri.Edge2);
+		const int32 MinX = FMath::Clamp(FMath::FloorToInt((TriBounds.Min.X - GridOrigin.X) / CellSize), 0, GridSize.X - 1);
+		const int32 MinY = FMath::Clamp(FMath::FloorToInt((TriBounds.Min.Y - GridOrigin.Y) / CellSize), 0, GridSize.Y - 1);
+		const int32 MaxX = FMath::Clamp(FMath::FloorToInt((TriBounds.Max.X - GridOrigin.X) / CellSize), 0, GridSize.X - 1);
+		const int32 MaxY = FMath::Clamp(FMath::FloorToInt((TriBounds.Max.Y - GridOrigin.Y) / CellSize), 0, GridSize.Y - 1);
+		for (int32 CellY = MinY; CellY <= MaxY; CellY++)
+		{
+			for (int32 CellX = MinX; CellX <= MaxX; CellX++)
+			{
+				Visit(GetCellIndex(CellX, CellY));
+			}
+		}
+	};
+
+	//Count, prefix sum, then fill so the cell lists are one flat array
+	CellStarts.SetNumZeroed(GridSize.X * GridSize.Y + 1);
+	for (const FParkourWallTriangle& Tri : Triangles)
+	{
+		ForEachCell(Tri, [this](int32 Cell) { CellStarts[Cell + 1]++; });
+	}
+	for (int32 Cell = 0; Cell < GridSize.X * GridSize.Y; Cell++)
+	{
+		CellStarts[Cell + 1] += CellStarts[Cell];
+	}
+	TArray<int32> Fill(CellStarts);
+	CellTriangles.SetNumUninitialized(CellStarts.Last());
+	for (int32 Index = 0; Index < Triangles.Num(); Index++)
+	{
+		ForEachCell(Triangles[Index], [this, &Fill, Index](int32 Cell) { CellTriangles[Fill[Cell]++] = Index; });
+	}
+}
+
+UParkourWallIndex* UParkourWallIndex::LoadForWorld(const UWorld* World)
+{
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+	FString MapPackageName = UWorld::RemovePIEPrefix(World->GetOutermost()->GetName());
+	FString PackageName = GetIndexPackageName(MapPackageName);
+	if (!FPackageName::DoesPackageExist(PackageName))
+	{
+		return nullptr;
+	}
+	FString ObjectPath = PackageName + TEXT(".") + FPackageName::GetShortName(PackageName);
+	UParkourWallIndex* Index = LoadObject<UParkourWallIndex>(nullptr, *ObjectPath, nullptr, LOAD_NoWarn | LOAD_Quiet);
+	if (Index and !Index->IsCurrentVersion())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s is out of date, rerun the ParkourWallIndex commandlet"), *ObjectPath);
+		return nullptr;
+	}
+	return Index;
+}
+
+FString UParkourWallIndex::GetIndexPackageName(const FString& MapPackageName)
+{
+	return FString::Printf(TEXT("/Game/ParkourIndex/%s_Walls"), *FPackageName::GetShortName(MapPackageName));
+}
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "ParkourWallIndex.generated.h"
+
+//World-space triangle of static geometry whose normal passes FParkourSimRules::IsWallRunnableNormal
+USTRUCT()
+struct FParkourWallTriangle
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector V0 = FVector::ZeroVector;
+	UPROPERTY()
+	FVector Edge1 = FVector::ZeroVector;
+	UPROPERTY()
+	FVector Edge2 = FVector::ZeroVector;
+	UPROPERTY()
+	FVector Normal = FVector::ZeroVector;
+};
+
+//Wall-runnable static surfaces of one level, binned into a uniform XY grid.
+//Baked by UParkourWallIndexCommandlet and loaded by UParkourComponent::Initialise,
+//so wall-run probes against static geometry become a grid lookup instead of a scene query.
+UCLASS()
+class ECHORUNNER_API UParkourWallIndex : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	//Bumped whenever the baked layout or the wall-runnable rule changes, stale assets are ignored
+	static constexpr int32 CurrentVersion = 2;
+
+	//Closest front-facing wall triangle crossed by the segment, filled like a blocking line trace hit
+	bool LineTrace(const FVector& Start, const FVector& End, FHitResult& OutHit) const;
+
+	void Build(TArray<FParkourWallTriangle>&& InTriangles, float InCellSize, bool bInCoversStaticGeometry);
+	bool IsCurrentVersion() const { return Version == CurrentVersion; }
+	//False when the level had static geometry the bake could not read, so an index miss proves nothing about it
+	bool CoversStaticGeometry() const { return bCoversStaticGeometry; }
+	int32 NumTriangles() const { return Triangles.Num(); }
+
+	//Baked index for the world's persistent level, null if none was baked or it is stale
+	static UParkourWallIndex* LoadForWorld(const UWorld* World);
+	//Package the index of a map package is saved to, e.g. /Game/ParkourIndex/Sandbox_Walls
+	static FString GetIndexPackageName(const FString& MapPackageName);
+
+private:
+	int32 GetCellIndex(int32 CellX, int32 CellY) const { return CellY * GridSize.X + CellX; }
+
+	UPROPERTY()
+	int32 Version = 0;
+	UPROPERTY()
+	bool bCoversStaticGeometry = false;
+	UPROPERTY()
+	float CellSize = 200.0;
+	UPROPERTY()
+	FVector2D GridOrigin = FVector2D::ZeroVector;
+	UPROPERTY()
+	FIntPoint GridSize = FIntPoint::ZeroValue;
+
+	UPROPERTY()
+	TArray<FParkourWallTriangle> Triangles;
+	//Triangles of cell i are CellTriangles[CellStarts[i] .. CellStarts[i + 1])
+	UPROPERTY()
+	TArray<int32> CellStarts;
+	UPROPERTY()
+	TArray<int32> CellTriangles;
+};
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ParkourWallIndexCommandlet.h"
+#include "Engine/World.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+#include "UObject/SavePackage.h"
+#include "ParkourBakeUtils.h"
+#include "ParkourSim.h"
+#include "ParkourWallIndex.h"
+
+UParkourWallIndexCommandlet::UParkourWallIndexCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UParkourWallIndexCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FString MapName;
+	if (!FParse::Value(*Params, TEXT("Map="), MapName))
+	{
+		UE_LOG(LogTemp, Error, TEXT("ParkourWallIndex: missing -Map=/Game/Path/To/Map"));
+		return 1;
+	}
+	float CellSize = 200.0f;
+	FParse::Value(*Params, TEXT("CellSize="), CellSize);
+
+	UWorld* World = ParkourBake::LoadMap(MapName);
+	if (World == nullptr)
+	{
+		return 1;
+	}
+
+	TArray<ParkourBake::FTriangle> StaticTriangles;
+	int32 NumComponents = ParkourBake::CollectStaticTriangles(World, StaticTriangles);
+	const bool bCoversStaticGeometry = ParkourBake::CoversStaticGeometry(World);
+
+	TArray<FParkourWallTriangle> Triangles;
+	for (const ParkourBake::FTriangle& Static : StaticTriangles)
+	{
+		FParkourWallTriangle Tri;
+		Tri.V0 = Static.A;
+		Tri.Edge1 = Static.B - Static.A;
+		Tri.Edge2 = Static.C - Static.A;
+		//Sign is irrelevant, the wall-runnable range is symmetric and the lookup is two-sided
+		Tri.Normal = Static.GetUnorientedNormal();
+		if (FParkourSimRules::IsWallRunnableNormal(Tri.Normal.Z))
+		{
+			Triangles.Add(Tri);
+		}
+	}
+
+	const FString PackageName = UParkourWallIndex::GetIndexPackageName(World->GetOutermost()->GetName());
+	UPackage* Package = CreatePackage(*PackageName);
+	Package->FullyLoad();
+	UParkourWallIndex* Index = NewObject<UParkourWallIndex>(Package, *FPackageName::GetShortName(PackageName), RF_Public | RF_Standalone);
+	Index->Build(MoveTemp(Triangles), CellSize, bCoversStaticGeometry);
+	Package->MarkPackageDirty();
+
+	const FString FileName = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
+	FSavePackageArgs SaveArgs;
+	SaveArgs.TopLevelFlags = RF_Public | RF_Standalone;
+	if (!UPackage::SavePackage(Package, Index, *FileName, SaveArgs))
+	{
+		UE_LOG(LogTemp, Error, TEXT("ParkourWallIndex: failed to save %s"), *FileName);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("ParkourWallIndex: %d wall triangles from %d static mesh components, %s -> %s"),
+		Index->NumTriangles(), NumComponents, bCoversStaticGeometry ? TEXT("covers all static geometry") : TEXT("partial static coverage"), *PackageName);
+	return 0;
+#else
+	return 1;
+#endif
+}
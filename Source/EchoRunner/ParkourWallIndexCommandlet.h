@@ -0,0 +1,20 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "ParkourWallIndexCommandlet.generated.h"
+
+//Bakes the wall-runnable static geometry of a map into a UParkourWallIndex.
+//UnrealEditor-Cmd EchoRunner.uproject -run=ParkourWallIndex -Map=/Game/FirstPerson/Maps/Sandbox [-CellSize=200]
+UCLASS()
+class ECHORUNNER_API UParkourWallIndexCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UParkourWallIndexCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
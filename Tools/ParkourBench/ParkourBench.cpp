@@ -0,0 +1,545 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+//Headless benchmark for the engine-independent parkour core.
+//Runs FParkourSim for many runners against a synthetic corridor of walls and ledges.
+//
+//Build and run from the project root (no engine required):
+//  g++ -std=c++17 -O2 -ISource/EchoRunner Tools/ParkourBench/ParkourBench.cpp Source/EchoRunner/ParkourSim.cpp -o ParkourBench
+//  ./ParkourBench [Runners=100000] [Seconds=5] [UpdateRate=60]
+//
+//Budget mode times every update and reports average and p99 cost and queries per update for each mode.
+//Against a baseline it exits non-zero when a mode issues more queries per update than recorded:
+//  ./ParkourBench 2000 10 60 --baseline Tools/ParkourBench/Baseline.txt [--tolerance 25] [--strict-timing]
+//  ./ParkourBench 2000 10 60 --write-baseline Tools/ParkourBench/Baseline.txt
+//Queries are deterministic and checked tightly. Timings only hold on the machine the baseline came from, so a mode
+//slower than the tolerance is a warning unless --strict-timing makes it a failure too.
+
+#include "ParkourSim.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+	const float GravityZ = -980.0f;
+
+	const int32_t NumModes = 9;
+	const char* const ModeNames[NumModes] = { "None", "LeftWallRun", "RightWallRun", "VerticalWallRun", "LedgeGrab", "Mantle", "Slide", "Sprint", "Crouch" };
+
+	//Per-mode update samples for budget mode, keyed by the mode the update started in
+	struct FModeBudget
+	{
+		std::vector<float> Nanoseconds;
+		uint64_t Queries = 0;
+
+		double AverageNs() const
+		{
+			double Sum = 0.0;
+			for (float Sample : Nanoseconds)
+			{
+				Sum += Sample;
+			}
+			return Nanoseconds.empty() ? 0.0 : Sum / (double)Nanoseconds.size();
+		}
+
+		double P99Ns()
+		{
+			if (Nanoseconds.empty())
+			{
+				return 0.0;
+			}
+			size_t Index = (Nanoseconds.size() * 99) / 100;
+			std::nth_element(Nanoseconds.begin(), Nanoseconds.begin() + Index, Nanoseconds.end());
+			return Nanoseconds[Index];
+		}
+
+		double QueriesPerUpdate() const
+		{
+			return Nanoseconds.empty() ? 0.0 : (double)Queries / (double)Nanoseconds.size();
+		}
+	};
+
+	struct FBaselineEntry
+	{
+		bool bValid = false;
+		double AverageNs = 0.0;
+		double P99Ns = 0.0;
+		double QueriesPerUpdate = 0.0;
+	};
+
+	//One line per mode: Name AverageNs P99Ns QueriesPerUpdate
+	bool ReadBaseline(const char* Path, FBaselineEntry (&OutEntries)[NumModes])
+	{
+		FILE* File = std::fopen(Path, "r");
+		if (File == nullptr)
+		{
+			return false;
+		}
+		char Name[64];
+		FBaselineEntry Entry;
+		while (std::fscanf(File, "%63s %lf %lf %lf", Name, &Entry.AverageNs, &Entry.P99Ns, &Entry.QueriesPerUpdate) == 4)
+		{
+			for (int32_t Mode = 0; Mode < NumModes; Mode++)
+			{
+				if (std::strcmp(Name, ModeNames[Mode]) == 0)
+				{
+					OutEntries[Mode] = Entry;
+					OutEntries[Mode].bValid = true;
+				}
+			}
+		}
+		std::fclose(File);
+		return true;
+	}
+
+	//Corridor repeats every PatternLength units along X
+	const float PatternLength = 2000.0f;
+
+	struct FBox
+	{
+		FParkourSimVector Min;
+		FParkourSimVector Max;
+	};
+
+	//Side walls for wall running and a block to vertical wall run, grab and mantle
+	const FBox PatternBoxes[] =
+	{
+		{ FParkourSimVector(0.0f, 200.0f, 0.0f), FParkourSimVector(1200.0f, 240.0f, 600.0f) },
+		{ FParkourSimVector(0.0f, -240.0f, 0.0f), FParkourSimVector(1200.0f, -200.0f, 600.0f) },
+		{ FParkourSimVector(1600.0f, -240.0f, 0.0f), FParkourSimVector(1700.0f, 240.0f, 180.0f) }
+	};
+
+	bool RayBox(const FParkourSimVector& Start, const FParkourSimVector& Delta, const FBox& Box, float& InOutT, FParkourSimVector& OutNormal)
+	{
+		float Origin[3] = { Start.X, Start.Y, Start.Z };
+		float Dir[3] = { Delta.X, Delta.Y, Delta.Z };
+		float Min[3] = { Box.Min.X, Box.Min.Y, Box.Min.Z };
+		float Max[3] = { Box.Max.X, Box.Max.Y, Box.Max.Z };
+		float TEnter = 0.0f;
+		float TExit = InOutT;
+		int32_t EnterAxis = -1;
+		float EnterSign = 0.0f;
+		for (int32_t Axis = 0; Axis < 3; Axis++)
+		{
+			if (std::fabs(Dir[Axis]) < 1.e-6f)
+			{
+				if (Origin[Axis] < Min[Axis] or Origin[Axis] > Max[Axis])
+				{
+					return false;
+				}
+				continue;
+			}
+			float InvDir = 1.0f / Dir[Axis];
+			float T0 = (Min[Axis] - Origin[Axis]) * InvDir;
+			float T1 = (Max[Axis] - Origin[Axis]) * InvDir;
+			float Sign = -1.0f;
+			if (T0 > T1)
+			{
+				float Tmp = T0;
+				T0 = T1;
+				T1 = Tmp;
+				Sign = 1.0f;
+			}
+			if (T0 > TEnter)
+			{
+				TEnter = T0;
+				EnterAxis = Axis;
+				EnterSign = Sign;
+			}
+			TExit = (T1 < TExit) ? T1 : TExit;
+			if (TEnter > TExit)
+			{
+				return false;
+			}
+		}
+		if (EnterAxis < 0)
+		{
+			//Started inside the box, treat as no hit like an initially penetrating query
+			return false;
+		}
+		InOutT = TEnter;
+		OutNormal = FParkourSimVector(EnterAxis == 0 ? EnterSign : 0.0f, EnterAxis == 1 ? EnterSign : 0.0f, EnterAxis == 2 ? EnterSign : 0.0f);
+		return true;
+	}
+
+	class FSyntheticWorld : public IParkourSimWorld
+	{
+	public:
+		virtual bool LineTrace(const FParkourSimVector& Start, const FParkourSimVector& End, FParkourSimHit& OutHit) override
+		{
+			return Trace(Start, End, 0.0f, 0.0f, OutHit);
+		}
+
+		//Capsule approximated by its bounding box, inflating the geometry instead of the query
+		virtual bool SweepCapsule(const FParkourSimVector& Start, const FParkourSimVector& End, float Radius, float HalfHeight, FParkourSimHit& OutHit) override
+		{
+			return Trace(Start, End, Radius, HalfHeight, OutHit);
+		}
+
+	private:
+		bool Trace(const FParkourSimVector& Start, const FParkourSimVector& End, float Extent, float HalfHeight, FParkourSimHit& OutHit)
+		{
+			FParkourSimVector Delta = End - Start;
+			float BestT = 1.0f;
+			FParkourSimVector BestNormal;
+			bool bHit = false;
+
+			//Ground plane
+			if (Delta.Z < 0.0f and Start.Z - HalfHeight >= 0.0f and End.Z - HalfHeight < 0.0f)
+			{
+				BestT = (HalfHeight - Start.Z) / Delta.Z;
+				BestNormal = FParkourSimVector(0.0f, 0.0f, 1.0f);
+				bHit = true;
+			}
+
+			float MinX = (Start.X < End.X) ? Start.X : End.X;
+			float MaxX = (Start.X < End.X) ? End.X : Start.X;
+			int32_t FirstPattern = (int32_t)std::floor((MinX - Extent) / PatternLength);
+			int32_t LastPattern = (int32_t)std::floor((MaxX + Extent) / PatternLength);
+			for (int32_t Pattern = FirstPattern; Pattern <= LastPattern; Pattern++)
+			{
+				float OffsetX = Pattern * PatternLength;
+				for (const FBox& PatternBox : PatternBoxes)
+				{
+					FBox Box;
+					Box.Min = FParkourSimVector(PatternBox.Min.X + OffsetX - Extent, PatternBox.Min.Y - Extent, PatternBox.Min.Z - HalfHeight);
+					Box.Max = FParkourSimVector(PatternBox.Max.X + OffsetX + Extent, PatternBox.Max.Y + Extent, PatternBox.Max.Z + HalfHeight);
+					if (RayBox(Start, Delta, Box, BestT, BestNormal))
+					{
+						bHit = true;
+					}
+				}
+			}
+
+			OutHit = FParkourSimHit();
+			if (bHit)
+			{
+				OutHit.bBlockingHit = true;
+				OutHit.Location = Start + Delta * BestT;
+				OutHit.Normal = BestNormal;
+				OutHit.ImpactPoint = OutHit.Location - FParkourSimVector(BestNormal.X * Extent, BestNormal.Y * Extent, BestNormal.Z * HalfHeight);
+				OutHit.Distance = Delta.Size() * BestT;
+			}
+			return bHit;
+		}
+	};
+
+	//Minimal falling/walking integrator standing in for UCharacterMovementComponent
+	class FSyntheticRunner : public IParkourSimMovement
+	{
+	public:
+		FParkourSimVector Location;
+		FParkourSimVector Velocity;
+		FParkourSimVector PendingLaunch;
+		bool bPendingLaunch = false;
+		bool bPendingXYOverride = false;
+		bool bPendingZOverride = false;
+		EParkourSimMovementMode Mode = EParkourSimMovementMode::WALKING;
+		float GravityScale = 1.0f;
+		float GroundFriction = 8.0f;
+		float MaxWalkSpeed = 600.0f;
+		float HalfHeight = 96.0f;
+		bool bCrouched = false;
+		//Receives movement mode and landing notifications, like the character Blueprint forwarding them
+		FParkourSim* Sim = nullptr;
+
+		virtual FParkourSimVector GetLocation() const override { return Location; }
+		virtual void SetLocation(const FParkourSimVector& InLocation) override { Location = InLocation; }
+		virtual FParkourSimVector GetForward() const override { return FParkourSimVector(1.0f, 0.0f, 0.0f); }
+		virtual FParkourSimVector GetRight() const override { return FParkourSimVector(0.0f, 1.0f, 0.0f); }
+		virtual FParkourSimVector GetEyes() const override { return Location + FParkourSimVector(0.0f, 0.0f, HalfHeight - 32.0f); }
+		virtual FParkourSimVector GetVelocity() const override { return Velocity; }
+		virtual FParkourSimVector GetLastInput() const override { return FParkourSimVector(1.0f, 0.0f, 0.0f); }
+		virtual float GetCapsuleRadius() const override { return 34.0f; }
+		virtual float GetCapsuleHalfHeight() const override { return HalfHeight; }
+		virtual float GetJumpZVelocity() const override { return 700.0f; }
+
+		virtual EParkourSimMovementMode GetMovementMode() const override { return Mode; }
+		virtual void SetMovementMode(EParkourSimMovementMode NewMode) override
+		{
+			if (Mode != NewMode)
+			{
+				EParkourSimMovementMode PrevMode = Mode;
+				Mode = NewMode;
+				if (Sim)
+				{
+					Sim->MovementChanged(PrevMode, NewMode);
+				}
+			}
+		}
+		virtual bool IsWalkable(const FParkourSimHit& Hit) const override { return Hit.Normal.Z > 0.71f; }
+
+		virtual void Launch(const FParkourSimVector& InVelocity, bool bXYOverride, bool bZOverride) override
+		{
+			PendingLaunch = InVelocity;
+			bPendingLaunch = true;
+			bPendingXYOverride = bXYOverride;
+			bPendingZOverride = bZOverride;
+		}
+		virtual void StopMovement() override
+		{
+			SetMovementMode(EParkourSimMovementMode::NONE);
+			Velocity = FParkourSimVector();
+			bPendingLaunch = false;
+		}
+		virtual float GetGravityScale() const override { return GravityScale; }
+		virtual void SetGravityScale(float Scale) override { GravityScale = Scale; }
+		virtual void SetGroundFriction(float Friction) override { GroundFriction = Friction; }
+		virtual void SetMaxWalkSpeed(float Speed) override { MaxWalkSpeed = Speed; }
+		virtual void SetCrouched(bool bInCrouched) override
+		{
+			bCrouched = bInCrouched;
+			HalfHeight = bCrouched ? 44.0f : 96.0f;
+		}
+		virtual void BeginSlide(const FParkourSimVector& Impulse) override { Velocity = Velocity + Impulse; }
+		virtual void RestoreDefaults() override
+		{
+			GravityScale = 1.0f;
+			GroundFriction = 8.0f;
+			MaxWalkSpeed = 600.0f;
+		}
+
+		void Integrate(float DeltaTime)
+		{
+			if (bPendingLaunch)
+			{
+				Velocity.X = bPendingXYOverride ? PendingLaunch.X : Velocity.X + PendingLaunch.X;
+				Velocity.Y = bPendingXYOverride ? PendingLaunch.Y : Velocity.Y + PendingLaunch.Y;
+				Velocity.Z = bPendingZOverride ? PendingLaunch.Z : Velocity.Z + PendingLaunch.Z;
+				bPendingLaunch = false;
+				if (Velocity.Z > 0.0f)
+				{
+					SetMovementMode(EParkourSimMovementMode::FALLING);
+				}
+			}
+
+			if (Mode == EParkourSimMovementMode::WALKING)
+			{
+				Velocity = FParkourSimVector(MaxWalkSpeed, 0.0f, 0.0f);
+			}
+			else if (Mode == EParkourSimMovementMode::FALLING)
+			{
+				Velocity.Z += GravityZ * GravityScale * DeltaTime;
+			}
+			else
+			{
+				return;
+			}
+
+			Location = Location + Velocity * DeltaTime;
+			if (Mode == EParkourSimMovementMode::FALLING and Location.Z <= HalfHeight)
+			{
+				Location.Z = HalfHeight;
+				Velocity.Z = 0.0f;
+				SetMovementMode(EParkourSimMovementMode::WALKING);
+				if (Sim)
+				{
+					Sim->LandEvent();
+				}
+			}
+		}
+	};
+}
+
+int main(int argc, char** argv)
+{
+	const char* BaselinePath = nullptr;
+	const char* WriteBaselinePath = nullptr;
+	double Tolerance = 25.0;
+	bool bStrictTiming = false;
+	std::vector<const char*> Positional;
+	for (int32_t Arg = 1; Arg < argc; Arg++)
+	{
+		if (std::strcmp(argv[Arg], "--baseline") == 0 and Arg + 1 < argc)
+		{
+			BaselinePath = argv[++Arg];
+		}
+		else if (std::strcmp(argv[Arg], "--write-baseline") == 0 and Arg + 1 < argc)
+		{
+			WriteBaselinePath = argv[++Arg];
+		}
+		else if (std::strcmp(argv[Arg], "--tolerance") == 0 and Arg + 1 < argc)
+		{
+			Tolerance = std::atof(argv[++Arg]);
+		}
+		else if (std::strcmp(argv[Arg], "--strict-timing") == 0)
+		{
+			bStrictTiming = true;
+		}
+		else
+		{
+			Positional.push_back(argv[Arg]);
+		}
+	}
+	const bool bBudgetMode = (BaselinePath != nullptr or WriteBaselinePath != nullptr);
+
+	int32_t NumRunners = (Positional.size() > 0) ? std::atoi(Positional[0]) : 100000;
+	float SimSeconds = (Positional.size() > 1) ? (float)std::atof(Positional[1]) : 5.0f;
+	float UpdateRate = (Positional.size() > 2) ? (float)std::atof(Positional[2]) : 60.0f;
+	NumRunners = (NumRunners > 0) ? NumRunners : 1;
+	UpdateRate = (UpdateRate > 0.0f) ? UpdateRate : 60.0f;
+	const float DeltaTime = 1.0f / UpdateRate;
+	const int32_t NumFrames = (int32_t)(SimSeconds * UpdateRate);
+
+	FSyntheticWorld World;
+	FParkourSimConfig Config;
+	std::vector<FSyntheticRunner> Runners(NumRunners);
+	std::vector<std::unique_ptr<FParkourSim>> Sims;
+	Sims.reserve(NumRunners);
+
+	//Deterministic spread of lanes and start positions so runners hit walls and ledges at different times
+	uint32_t Seed = 12345;
+	auto NextRandom = [&Seed]()
+	{
+		Seed = Seed * 1664525u + 1013904223u;
+		return (float)(Seed >> 8) / 16777216.0f;
+	};
+	for (int32_t Index = 0; Index < NumRunners; Index++)
+	{
+		FSyntheticRunner& Runner = Runners[Index];
+		Runner.Location = FParkourSimVector(NextRandom() * PatternLength, (NextRandom() * 2.0f - 1.0f) * 160.0f, Runner.HalfHeight);
+		Sims.push_back(std::unique_ptr<FParkourSim>(new FParkourSim(World, Runner, Config)));
+		Runner.Sim = Sims.back().get();
+		Runner.Sim->SprintEvent();
+	}
+
+	uint64_t ModeFrames[NumModes] = {};
+	FModeBudget Budgets[NumModes];
+	auto StartTime = std::chrono::steady_clock::now();
+	for (int32_t Frame = 0; Frame < NumFrames; Frame++)
+	{
+		for (int32_t Index = 0; Index < NumRunners; Index++)
+		{
+			FSyntheticRunner& Runner = Runners[Index];
+			FParkourSim& Sim = *Sims[Index];
+
+			//Scripted input: jump roughly every second, double jump, dash and slide occasionally
+			int32_t Phase = (Frame + Index * 7) % 60;
+			if (Phase == 0 or Phase == 20)
+			{
+				Sim.JumpEvent();
+			}
+			else if (Phase == 40 and (Index % 5) == 0)
+			{
+				Sim.DashEvent();
+			}
+			else if (Phase == 50 and (Index % 3) == 0)
+			{
+				Sim.CrouchSlideEvent();
+			}
+			else if (Phase == 55)
+			{
+				Sim.SprintEvent();
+			}
+
+			if (bBudgetMode)
+			{
+				FModeBudget& Budget = Budgets[(uint8_t)Sim.GetMode()];
+				uint64_t QueriesBefore = Sim.GetQueryCount();
+				auto UpdateStart = std::chrono::steady_clock::now();
+				Sim.Update(DeltaTime);
+				auto UpdateEnd = std::chrono::steady_clock::now();
+				Budget.Nanoseconds.push_back((float)std::chrono::duration<double, std::nano>(UpdateEnd - UpdateStart).count());
+				Budget.Queries += Sim.GetQueryCount() - QueriesBefore;
+			}
+			else
+			{
+				Sim.Update(DeltaTime);
+			}
+			Runner.Integrate(DeltaTime);
+			ModeFrames[(uint8_t)Sim.GetMode()]++;
+		}
+	}
+	auto EndTime = std::chrono::steady_clock::now();
+
+	double Seconds = std::chrono::duration<double>(EndTime - StartTime).count();
+	uint64_t Updates = (uint64_t)NumRunners * (uint64_t)NumFrames;
+	uint64_t Queries = 0;
+	for (const std::unique_ptr<FParkourSim>& Sim : Sims)
+	{
+		Queries += Sim->GetQueryCount();
+	}
+
+	std::printf("Runners: %d  Frames: %d  DeltaTime: %.4fs\n", NumRunners, NumFrames, DeltaTime);
+	std::printf("Updates: %llu in %.3fs\n", (unsigned long long)Updates, Seconds);
+	std::printf("Updates per second: %.0f\n", (Seconds > 0.0) ? (double)Updates / Seconds : 0.0);
+	std::printf("Queries per update: %.3f\n", (Updates > 0) ? (double)Queries / (double)Updates : 0.0);
+	for (int32_t Mode = 0; Mode < NumModes; Mode++)
+	{
+		std::printf("  %-16s %6.2f%%\n", ModeNames[Mode], (Updates > 0) ? 100.0 * (double)ModeFrames[Mode] / (double)Updates : 0.0);
+	}
+	if (!bBudgetMode)
+	{
+		return 0;
+	}
+
+	FBaselineEntry Baseline[NumModes];
+	if (BaselinePath and !ReadBaseline(BaselinePath, Baseline))
+	{
+		std::printf("Could not read baseline %s\n", BaselinePath);
+		return 1;
+	}
+	FILE* BaselineOut = WriteBaselinePath ? std::fopen(WriteBaselinePath, "w") : nullptr;
+	if (WriteBaselinePath and BaselineOut == nullptr)
+	{
+		std::printf("Could not write baseline %s\n", WriteBaselinePath);
+		return 1;
+	}
+
+	//Query counts are deterministic, so they only get a small allowance for float drift across compilers
+	const double QueryTolerance = 2.0;
+	int32_t Regressions = 0;
+	int32_t SlowModes = 0;
+	std::printf("\n  %-16s %10s %10s %10s\n", "Mode", "Avg ns", "P99 ns", "Queries");
+	for (int32_t Mode = 0; Mode < NumModes; Mode++)
+	{
+		FModeBudget& Budget = Budgets[Mode];
+		if (Budget.Nanoseconds.empty())
+		{
+			continue;
+		}
+		double AverageNs = Budget.AverageNs();
+		double P99Ns = Budget.P99Ns();
+		double QueriesPerUpdate = Budget.QueriesPerUpdate();
+		std::printf("  %-16s %10.1f %10.1f %10.3f", ModeNames[Mode], AverageNs, P99Ns, QueriesPerUpdate);
+		if (BaselineOut)
+		{
+			std::fprintf(BaselineOut, "%s %.1f %.1f %.3f\n", ModeNames[Mode], AverageNs, P99Ns, QueriesPerUpdate);
+		}
+
+		const FBaselineEntry& Entry = Baseline[Mode];
+		if (Entry.bValid)
+		{
+			bool bTimeRegressed = AverageNs > Entry.AverageNs * (1.0 + Tolerance / 100.0) or P99Ns > Entry.P99Ns * (1.0 + Tolerance / 100.0);
+			bool bQueriesRegressed = QueriesPerUpdate > Entry.QueriesPerUpdate * (1.0 + QueryTolerance / 100.0) + 0.001;
+			if (bQueriesRegressed or (bTimeRegressed and bStrictTiming))
+			{
+				std::printf("  REGRESSED (baseline %.1f %.1f %.3f)", Entry.AverageNs, Entry.P99Ns, Entry.QueriesPerUpdate);
+				Regressions++;
+			}
+			else if (bTimeRegressed)
+			{
+				std::printf("  SLOWER (baseline %.1f %.1f)", Entry.AverageNs, Entry.P99Ns);
+				SlowModes++;
+			}
+		}
+		std::printf("\n");
+	}
+	if (BaselineOut)
+	{
+		std::fclose(BaselineOut);
+		std::printf("Wrote baseline %s\n", WriteBaselinePath);
+	}
+	if (BaselinePath)
+	{
+		std::printf("%s: %d mode(s) over budget, %d slower than the %.0f%% timing tolerance%s\n", Regressions ? "FAILED" : "PASSED",
+			Regressions, SlowModes, Tolerance, bStrictTiming ? "" : " (warning only)");
+	}
+	return Regressions ? 1 : 0;
+}